@@ -18,6 +18,10 @@ const storageInfo  = $('storageInfo');
 let currentPayload = '';
 let autorunPayload = '';
 
+// name → { etag, content } — last version seen from / sent to the device
+const payloadCache = new Map();
+const utf8 = new TextEncoder();
+
 // ================================================================
 //  API Helpers
 // ================================================================
@@ -80,23 +84,76 @@ async function loadPayloads() {
     }
 }
 
+// Conditional GET: the device answers 304 when our cached copy is current.
+async function fetchPayload(name) {
+    const cached = payloadCache.get(name);
+    const headers = cached ? { 'If-None-Match': cached.etag } : {};
+    const res = await fetch(`${API}/api/payloads/${encodeURIComponent(name)}`, { headers });
+    if (res.status === 304) return cached.content;
+    if (!res.ok) throw new Error(res.status);
+    const data = await res.json();
+    const content = data.content || '';
+    payloadCache.set(name, { etag: res.headers.get('ETag') || data.etag, content });
+    return content;
+}
+
 async function selectPayload(name) {
     try {
-        const data = await api('GET', `/api/payloads/${encodeURIComponent(name)}`);
+        const content = await fetchPayload(name);
         currentPayload = name;
         payloadName.value = name;
-        editor.value = data.content || '';
+        editor.value = content;
         loadPayloads();   // refresh active state
     } catch (e) {
         toast('Failed to load payload', 'error');
     }
 }
 
+// Single byte-range edit turning `before` into `after` (common prefix/suffix).
+function diffEdit(before, after) {
+    let start = 0;
+    const max = Math.min(before.length, after.length);
+    while (start < max && before[start] === after[start]) start++;
+    let endB = before.length, endA = after.length;
+    while (endB > start && endA > start && before[endB - 1] === after[endA - 1]) {
+        endB--; endA--;
+    }
+    // Never split a surrogate pair
+    if (start > 0 && /[\uD800-\uDBFF]/.test(before[start - 1])) start--;
+    return {
+        offset: utf8.encode(before.slice(0, start)).length,
+        remove: utf8.encode(before.slice(start, endB)).length,
+        text:   after.slice(start, endA)
+    };
+}
+
+// PATCH only the changed range against the cached base; null if not possible.
+async function patchPayload(name, content) {
+    const cached = payloadCache.get(name);
+    if (!cached) return null;
+    if (cached.content === content) return cached.etag;
+    const edit = diffEdit(cached.content, content);
+    const res = await fetch(`${API}/api/payloads/${encodeURIComponent(name)}`, {
+        method: 'PATCH',
+        headers: { 'Content-Type': 'application/json', 'If-Match': cached.etag },
+        body: JSON.stringify({ edits: [edit] })
+    });
+    if (!res.ok) return null;   // stale base etc. — fall back to full upload
+    const data = await res.json();
+    return res.headers.get('ETag') || data.etag;
+}
+
 async function savePayload() {
     const name = payloadName.value.trim();
     if (!name) { toast('Enter a payload name', 'error'); return; }
+    const content = editor.value;
     try {
-        await api('POST', '/api/payloads', { name, content: editor.value });
+        let etag = await patchPayload(name, content);
+        if (!etag) {
+            const data = await api('POST', '/api/payloads', { name, content });
+            etag = data.etag;
+        }
+        payloadCache.set(name, { etag, content });
         currentPayload = name;
         toast('Payload saved!', 'success');
         loadPayloads();
@@ -110,6 +167,7 @@ async function deletePayload() {
     if (!confirm(`Delete "${currentPayload}"?`)) return;
     try {
         await api('DELETE', `/api/payloads/${encodeURIComponent(currentPayload)}`);
+        payloadCache.delete(currentPayload);
         toast('Deleted', 'success');
         currentPayload = '';
         payloadName.value = '';
@@ -147,6 +205,38 @@ async function runLive() {
     }
 }
 
+// Dry run on the device: duration, reports and per-command breakdown
+async function analyzeScript() {
+    const script = editor.value;
+    if (!script.trim()) { toast('Nothing to analyze', 'error'); return; }
+    const out = $('analysis');
+    try {
+        const data = await api('POST', '/api/analyze', { script });
+        out.hidden = false;
+        if (!data.ok) {
+            out.className = 'analysis error';
+            out.textContent = `Line ${data.line}: ${data.error}`;
+            return;
+        }
+        out.className = 'analysis';
+        const secs = (ms) => (ms / 1000).toFixed(ms < 10000 ? 2 : 1) + ' s';
+        const rows = data.byCommand
+            .sort((a, b) => b.ms - a.ms)
+            .map(c => `<tr><td>${c.command}</td><td>${c.count}</td>` +
+                      `<td>${secs(c.ms)}</td><td>${c.reports}</td></tr>`)
+            .join('');
+        out.innerHTML = `
+            <div class="analysis-total">≈ ${secs(data.durationMs)} ·
+                ${data.reports} reports · ${data.commands} commands</div>
+            ${data.unknown ? `<div class="analysis-warn">${data.unknown} unrecognised
+                line(s) ignored (first: line ${data.unknownLine})</div>` : ''}
+            <table><tr><th>Command</th><th>Runs</th><th>Time</th><th>Reports</th></tr>${rows}</table>
+        `;
+    } catch (e) {
+        toast('Analyze failed', 'error');
+    }
+}
+
 async function stopExecution() {
     try {
         await api('POST', '/api/stop');
@@ -156,6 +246,111 @@ async function stopExecution() {
     }
 }
 
+// ================================================================
+//  Live Keyboard (WebSocket — binary events, see live_channel.h)
+// ================================================================
+
+const LIVE_KEY = 1, LIVE_TEXT = 2, LIVE_MOUSE = 3, LIVE_ACK = 0x80;
+
+// KeyboardEvent.key / .code → HID usage ID
+const HID_KEYS = {
+    Enter: 0x28, Escape: 0x29, Backspace: 0x2A, Tab: 0x2B, CapsLock: 0x39,
+    PrintScreen: 0x46, ScrollLock: 0x47, Pause: 0x48, Insert: 0x49,
+    Home: 0x4A, PageUp: 0x4B, Delete: 0x4C, End: 0x4D, PageDown: 0x4E,
+    ArrowRight: 0x4F, ArrowLeft: 0x50, ArrowDown: 0x51, ArrowUp: 0x52,
+    NumLock: 0x53, ContextMenu: 0x65, ' ': 0x2C
+};
+
+let liveWs = null;
+let liveSeq = 0;
+const liveSent = new Map();   // seq → performance.now() at send
+let liveRtt = 0;
+
+function liveConnect() {
+    if (liveWs && liveWs.readyState <= WebSocket.OPEN) return;
+    liveWs = new WebSocket(`ws://${location.host}/ws/live`);
+    liveWs.binaryType = 'arraybuffer';
+    liveWs.onopen  = () => { $('liveStats').textContent = 'connected'; };
+    liveWs.onclose = () => { $('liveStats').textContent = 'disconnected'; liveSent.clear(); };
+    liveWs.onmessage = (e) => {
+        const v = new DataView(e.data);
+        if (v.getUint8(0) !== LIVE_ACK) return;
+        const seq = v.getUint32(1, true);
+        const result = v.getUint8(5);
+        const sent = liveSent.get(seq);
+        liveSent.delete(seq);
+        if (result === 1) { $('liveStats').textContent = 'busy — script running'; return; }
+        if (sent === undefined || result !== 0) return;
+        const rtt = performance.now() - sent;
+        liveRtt = liveRtt ? liveRtt * 0.8 + rtt * 0.2 : rtt;
+        $('liveStats').textContent =
+            `rtt ${liveRtt.toFixed(1)} ms · device ${(v.getUint32(6, true) / 1000).toFixed(1)} ms`;
+    };
+}
+
+function liveSend(type, bytes) {
+    if (!liveWs || liveWs.readyState !== WebSocket.OPEN) return;
+    const seq = (++liveSeq) >>> 0;
+    const msg = new Uint8Array(5 + bytes.length);
+    msg[0] = type;
+    new DataView(msg.buffer).setUint32(1, seq, true);
+    msg.set(bytes, 5);
+    liveSent.set(seq, performance.now());
+    liveWs.send(msg);
+}
+
+function liveKeyDown(e) {
+    if (['Shift', 'Control', 'Alt', 'Meta'].includes(e.key)) return;
+    e.preventDefault();
+    const mods = (e.ctrlKey ? 0x01 : 0) | (e.shiftKey ? 0x02 : 0) |
+                 (e.altKey ? 0x04 : 0) | (e.metaKey ? 0x08 : 0);
+
+    // Plain printable ASCII → text event (layout handled on the device)
+    if (e.key.length === 1 && !(mods & 0x0D) && e.key.charCodeAt(0) < 0x7F) {
+        liveSend(LIVE_TEXT, utf8.encode(e.key));
+        return;
+    }
+
+    let code = HID_KEYS[e.key];
+    if (/^F([1-9]|1[0-2])$/.test(e.key)) code = 0x3A + parseInt(e.key.slice(1)) - 1;
+    else if (/^Key[A-Z]$/.test(e.code)) code = 0x04 + e.code.charCodeAt(3) - 65;
+    else if (/^Digit[0-9]$/.test(e.code)) code = e.code[5] === '0' ? 0x27 : 0x1E + parseInt(e.code[5]) - 1;
+    if (code !== undefined) liveSend(LIVE_KEY, [code, mods]);
+}
+
+// Pointer-locked mouse: movement is batched per animation frame
+let mouseDx = 0, mouseDy = 0, mouseFrame = 0;
+
+function clamp8(v) { return Math.max(-127, Math.min(127, Math.round(v))); }
+
+function liveMouseFlush() {
+    mouseFrame = 0;
+    while (mouseDx || mouseDy) {
+        const dx = clamp8(mouseDx), dy = clamp8(mouseDy);
+        mouseDx -= dx; mouseDy -= dy;
+        liveSend(LIVE_MOUSE, [dx & 0xFF, dy & 0xFF, 0, 0]);
+    }
+}
+
+function liveMouseMove(e) {
+    if (document.pointerLockElement !== $('livePad')) return;
+    mouseDx += e.movementX;
+    mouseDy += e.movementY;
+    if (!mouseFrame) mouseFrame = requestAnimationFrame(liveMouseFlush);
+}
+
+function liveMouseDown(e) {
+    if (document.pointerLockElement !== $('livePad')) return;
+    e.preventDefault();
+    liveSend(LIVE_MOUSE, [0, 0, 0, [1, 4, 2][e.button] || 1]);
+}
+
+function liveWheel(e) {
+    if (document.pointerLockElement !== $('livePad')) return;
+    e.preventDefault();
+    liveSend(LIVE_MOUSE, [0, 0, (e.deltaY > 0 ? -1 : 1) & 0xFF, 0]);
+}
+
 // ================================================================
 //  Status Polling
 // ================================================================
@@ -198,6 +393,9 @@ function updateStatusUI(data) {
     if (data.ip)   $('infoIP').textContent   = data.ip;
     if (data.storage) {
         $('infoStorage').textContent = `${(data.storage.used/1024).toFixed(0)}/${(data.storage.total/1024).toFixed(0)} KB`;
+        if (data.storage.ratio) {
+            $('infoRatio').textContent = `${data.storage.ratio.toFixed(1)}× (${(data.storage.payloadStored/1024).toFixed(0)} KB on flash)`;
+        }
     }
 
     if (data.autorun !== undefined) {
@@ -221,6 +419,25 @@ async function setAutorun() {
     }
 }
 
+// Upload a .dka archive; the device skips entries it already has.
+async function importArchive(file) {
+    try {
+        const res = await fetch(API + '/api/archive', {
+            method: 'POST',
+            headers: { 'Content-Type': 'application/octet-stream' },
+            body: file
+        });
+        const data = await res.json();
+        if (!res.ok) throw new Error(data.error);
+        toast(`Imported ${data.written}, unchanged ${data.skipped}` +
+              (data.failed ? `, failed ${data.failed}` : ''),
+              data.failed ? 'error' : 'success');
+        loadPayloads();
+    } catch (e) {
+        toast('Import failed', 'error');
+    }
+}
+
 // ================================================================
 //  Templates
 // ================================================================
@@ -267,10 +484,16 @@ document.addEventListener('DOMContentLoaded', () => {
     // Button handlers
     $('btnSave').onclick   = savePayload;
     $('btnRun').onclick    = runPayload;
+    $('btnAnalyze').onclick = analyzeScript;
     $('btnStop').onclick   = stopExecution;
     $('btnDelete').onclick = deletePayload;
     $('btnLive').onclick   = runLive;
     $('btnAutorun').onclick = setAutorun;
+    $('btnImport').onclick  = () => $('archiveFile').click();
+    $('archiveFile').onchange = (e) => {
+        if (e.target.files[0]) importArchive(e.target.files[0]);
+        e.target.value = '';
+    };
     $('btnNew').onclick    = () => {
         currentPayload = '';
         payloadName.value = '';
@@ -278,6 +501,15 @@ document.addEventListener('DOMContentLoaded', () => {
         loadPayloads();
     };
 
+    // Live keyboard
+    const pad = $('livePad');
+    pad.addEventListener('focus', liveConnect);
+    pad.addEventListener('keydown', liveKeyDown);
+    pad.addEventListener('mousedown', liveMouseDown);
+    pad.addEventListener('wheel', liveWheel, { passive: false });
+    document.addEventListener('mousemove', liveMouseMove);
+    $('btnMouse').onclick = () => { liveConnect(); pad.focus(); pad.requestPointerLock(); };
+
     // Templates
     $('btnTemplate1').onclick = () => loadTemplate('notepad');
     $('btnTemplate2').onclick = () => loadTemplate('browser');
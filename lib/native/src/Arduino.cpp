@@ -0,0 +1,170 @@
+// ============================================================
+//  Native Shim — Arduino Core Subset for Host Builds
+// ============================================================
+
+#include "Arduino.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// ================================================================
+//  Print / Stream
+// ================================================================
+
+size_t Print::write(const uint8_t *buf, size_t len) {
+  size_t n = 0;
+  while (n < len && write(buf[n]))
+    n++;
+  return n;
+}
+
+size_t Print::printf(const char *fmt, ...) {
+  char small[128];
+  va_list args;
+  va_start(args, fmt);
+  int len = vsnprintf(small, sizeof(small), fmt, args);
+  va_end(args);
+  if (len < 0)
+    return 0;
+  if ((size_t)len < sizeof(small))
+    return write((const uint8_t *)small, len);
+
+  std::string big(len + 1, '\0');
+  va_start(args, fmt);
+  vsnprintf(&big[0], big.size(), fmt, args);
+  va_end(args);
+  return write((const uint8_t *)big.data(), len);
+}
+
+// Host streams never time out: read() < 0 means end of data.
+size_t Stream::readBytes(uint8_t *buf, size_t len) {
+  size_t n = 0;
+  int c;
+  while (n < len && (c = read()) >= 0)
+    buf[n++] = (uint8_t)c;
+  return n;
+}
+
+String Stream::readString() {
+  String s;
+  int c;
+  while ((c = read()) >= 0)
+    s += (char)c;
+  return s;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String s;
+  int c;
+  while ((c = read()) >= 0 && c != terminator)
+    s += (char)c;
+  return s;
+}
+
+// ================================================================
+//  GPIO — levels default HIGH (pull-ups: BOOT button not held)
+// ================================================================
+
+static std::atomic<int> sPins[64];
+static bool sPinsInit = [] {
+  for (auto &p : sPins)
+    p = HIGH;
+  return true;
+}();
+
+static std::atomic<void (*)()> sIsr[64];
+static std::atomic<int> sIsrMode[64];
+
+void pinMode(uint8_t, uint8_t) {}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin >= 64)
+    return;
+  int old = sPins[pin].exchange(val);
+  void (*isr)() = sIsr[pin];
+  int edge = val ? RISING : FALLING;
+  if (isr && old != val && (sIsrMode[pin] & edge))
+    isr();
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode) {
+  if (pin < 64) {
+    sIsrMode[pin] = mode;
+    sIsr[pin] = isr;
+  }
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin < 64)
+    sIsr[pin] = nullptr;
+}
+
+int digitalRead(uint8_t pin) { return pin < 64 ? sPins[pin].load() : LOW; }
+
+void hostGpioSet(uint8_t pin, int level) { digitalWrite(pin, level); }
+
+// ================================================================
+//  Host Clock
+// ================================================================
+
+static const auto sEpoch = std::chrono::steady_clock::now();
+static std::atomic<bool> sVirtual{false};
+static std::atomic<uint64_t> sVirtualUs{0};
+
+void hostClockUseVirtual(bool enable) { sVirtual = enable; }
+
+bool hostClockIsVirtual() { return sVirtual; }
+
+uint64_t hostClockMicros() {
+  if (sVirtual)
+    return sVirtualUs;
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - sEpoch)
+      .count();
+}
+
+// hostClockAt() events, by due time; sNextTimerUs spares every sleep
+// the lock while none is due
+static std::mutex sTimersLock;
+static std::multimap<uint64_t, std::function<void()>> sTimers;
+static std::atomic<uint64_t> sNextTimerUs{UINT64_MAX};
+
+void hostClockAt(uint64_t us, std::function<void()> fn) {
+  std::lock_guard<std::mutex> lock(sTimersLock);
+  sTimers.emplace(us, std::move(fn));
+  sNextTimerUs = sTimers.begin()->first;
+}
+
+static void fireTimers() {
+  uint64_t now = hostClockMicros();
+  while (sNextTimerUs.load(std::memory_order_relaxed) <= now) {
+    std::function<void()> fn;
+    {
+      std::lock_guard<std::mutex> lock(sTimersLock);
+      if (sTimers.empty() || sTimers.begin()->first > now)
+        return;
+      fn = std::move(sTimers.begin()->second);
+      sTimers.erase(sTimers.begin());
+      sNextTimerUs = sTimers.empty() ? UINT64_MAX : sTimers.begin()->first;
+    }
+    fn();
+  }
+}
+
+void hostClockSleepMicros(uint64_t us) {
+  if (sVirtual) {
+    sVirtualUs += us;
+    std::this_thread::yield();
+  } else {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+  }
+  fireTimers();
+}
+
+void hostClockReset() { sVirtualUs = 0; }
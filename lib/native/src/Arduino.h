@@ -0,0 +1,133 @@
+#pragma once
+
+// ============================================================
+//  Native Shim — Arduino Core Subset for Host Builds
+// ============================================================
+//
+//  Just enough of the ESP32 Arduino core (String, Print/Stream,
+//  Serial, timing, GPIO, ESP heap queries) to build the
+//  interpreter and storage code on Linux. FreeRTOS comes from
+//  freertos_shim.h, timing from host_clock.h.
+//
+// ============================================================
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "WString.h"
+#include "freertos_shim.h"
+#include "host_clock.h"
+#include "host_heap.h"
+
+using std::max;
+using std::min;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define IRAM_ATTR
+
+// --- Print / Stream ---
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t len);
+  size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+
+  size_t print(const String &s) { return write((const uint8_t *)s.c_str(), s.length()); }
+  size_t print(const char *s) { return write(s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(long v) { return print(String(v)); }
+  size_t print(unsigned long v) { return print(String(v)); }
+  size_t print(int v) { return print(String(v)); }
+  size_t print(unsigned v) { return print(String(v)); }
+  size_t print(double v, int digits = 2) { return print(String(v, digits)); }
+  template <class T> size_t println(const T &v) { return print(v) + println(); }
+  size_t println() { return write("\r\n"); }
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  void setTimeout(unsigned long) {}
+  size_t readBytes(uint8_t *buf, size_t len);
+  size_t readBytes(char *buf, size_t len) { return readBytes((uint8_t *)buf, len); }
+  String readString();
+  String readStringUntil(char terminator);
+};
+
+// --- Serial (stdout) ---
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  void end() {}
+  void flush() { fflush(stdout); }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  int availableForWrite() { return 4096; }
+  size_t write(uint8_t c) override { return fwrite(&c, 1, 1, stdout); }
+  size_t write(const uint8_t *buf, size_t len) override { return fwrite(buf, 1, len, stdout); }
+  using Print::write;
+  explicit operator bool() const { return true; }
+};
+extern HardwareSerial Serial;
+
+// --- Timing (host_clock.h: real or virtual time) ---
+inline unsigned long millis() { return hostClockMicros() / 1000; }
+inline unsigned long micros() { return (unsigned long)hostClockMicros(); }
+inline void delay(uint32_t ms) { hostClockSleepMicros((uint64_t)ms * 1000); }
+inline void delayMicroseconds(uint32_t us) { hostClockSleepMicros(us); }
+inline void yield() {}
+inline int64_t esp_timer_get_time() { return (int64_t)hostClockMicros(); }
+
+// --- GPIO (simulated pin levels, see hostGpioSet) ---
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+void hostGpioSet(uint8_t pin, int level);
+// Called on the thread that changes the level, like an ISR
+#define digitalPinToInterrupt(pin) (pin)
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+void detachInterrupt(uint8_t pin);
+
+// --- Heap queries (host values are nominal) ---
+class EspClass {
+public:
+  uint32_t getHeapSize() { return 320 * 1024; }
+  uint32_t getFreeHeap() { return freeOf(hostHeapLive()); }
+  uint32_t getMinFreeHeap() { return freeOf(hostHeapPeak()); }
+  uint32_t getMaxAllocHeap() { return 128 * 1024; }
+  uint32_t getPsramSize() { return 2 * 1024 * 1024; }
+  uint32_t getFreePsram() { return 2 * 1024 * 1024; }
+  uint32_t getMinFreePsram() { return 2 * 1024 * 1024; }
+  uint32_t getMaxAllocPsram() { return 2 * 1024 * 1024; }
+
+private:
+  uint32_t freeOf(size_t used) {
+    return used < getHeapSize() ? getHeapSize() - used : 0;
+  }
+};
+extern EspClass ESP;
+
+inline bool psramFound() { return true; }
+inline void *ps_malloc(size_t n) { return malloc(n); }
+inline void *ps_calloc(size_t n, size_t size) { return calloc(n, size); }
+
+template <class T> T constrain(T v, T lo, T hi) { return v < lo ? lo : (v > hi ? hi : v); }
@@ -0,0 +1,228 @@
+// ============================================================
+//  Native Shim — fs::FS / fs::File on a Host Directory
+// ============================================================
+
+#include "FS.h"
+#include "LittleFS.h"
+
+#include <algorithm>
+#include <filesystem>
+
+namespace stdfs = std::filesystem;
+
+static std::string defaultRoot() {
+  const char *env = getenv("LITTLEFS_ROOT");
+  return env && *env ? env : "./.littlefs";
+}
+
+fs::FS LittleFS(defaultRoot());
+
+namespace fs {
+
+struct File::Impl {
+  FILE *fp = nullptr;
+  std::string path; // device path, e.g. "/payloads/a.txt"
+  std::string name; // base name
+  bool dir = false;
+  std::vector<std::string> entries; // directory listing (device paths)
+  size_t next = 0;
+  std::string hostRoot;
+
+  ~Impl() {
+    if (fp)
+      fclose(fp);
+  }
+};
+
+static std::string baseName(const std::string &path) {
+  size_t slash = path.find_last_of('/');
+  return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+// ================================================================
+//  File
+// ================================================================
+
+size_t File::write(const uint8_t *buf, size_t len) {
+  if (!_p || !_p->fp)
+    return 0;
+  return fwrite(buf, 1, len, _p->fp);
+}
+
+int File::available() {
+  if (!_p || !_p->fp)
+    return 0;
+  return (int)(size() - position());
+}
+
+int File::read() {
+  if (!_p || !_p->fp)
+    return -1;
+  int c = fgetc(_p->fp);
+  return c == EOF ? -1 : c;
+}
+
+int File::peek() {
+  if (!_p || !_p->fp)
+    return -1;
+  int c = fgetc(_p->fp);
+  if (c == EOF)
+    return -1;
+  ungetc(c, _p->fp);
+  return c;
+}
+
+size_t File::read(uint8_t *buf, size_t len) {
+  if (!_p || !_p->fp)
+    return 0;
+  return fread(buf, 1, len, _p->fp);
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+  if (!_p || !_p->fp)
+    return false;
+  int whence = mode == SeekCur ? SEEK_CUR : mode == SeekEnd ? SEEK_END : SEEK_SET;
+  return fseek(_p->fp, pos, whence) == 0;
+}
+
+size_t File::position() const {
+  if (!_p || !_p->fp)
+    return 0;
+  long pos = ftell(_p->fp);
+  return pos < 0 ? 0 : (size_t)pos;
+}
+
+size_t File::size() const {
+  if (!_p || !_p->fp)
+    return 0;
+  fflush(_p->fp);
+  long cur = ftell(_p->fp);
+  fseek(_p->fp, 0, SEEK_END);
+  long end = ftell(_p->fp);
+  fseek(_p->fp, cur, SEEK_SET);
+  return end < 0 ? 0 : (size_t)end;
+}
+
+void File::flush() {
+  if (_p && _p->fp)
+    fflush(_p->fp);
+}
+
+void File::close() {
+  if (_p && _p->fp) {
+    fclose(_p->fp);
+    _p->fp = nullptr;
+  }
+  _p.reset();
+}
+
+File::operator bool() const { return _p && (_p->fp || _p->dir); }
+
+const char *File::name() const { return _p ? _p->name.c_str() : ""; }
+
+const char *File::path() const { return _p ? _p->path.c_str() : ""; }
+
+bool File::isDirectory() const { return _p && _p->dir; }
+
+File File::openNextFile(const char *mode) {
+  if (!_p || !_p->dir || _p->next >= _p->entries.size())
+    return File();
+  FS fs(_p->hostRoot);
+  return fs.open(String(_p->entries[_p->next++].c_str()), mode);
+}
+
+// ================================================================
+//  FS
+// ================================================================
+
+std::string FS::hostPath(const String &path) const {
+  std::string p = path.c_str();
+  if (p.empty() || p[0] != '/')
+    p = "/" + p;
+  return _root + p;
+}
+
+bool FS::begin(bool formatOnFail, const char *, uint8_t, const char *) {
+  std::error_code ec;
+  stdfs::create_directories(_root, ec);
+  return stdfs::is_directory(_root, ec);
+}
+
+bool FS::format() {
+  std::error_code ec;
+  stdfs::remove_all(_root, ec);
+  return begin();
+}
+
+File FS::open(const String &path, const char *mode, bool create) {
+  File f;
+  std::string host = hostPath(path);
+  std::error_code ec;
+  auto impl = std::make_shared<File::Impl>();
+  impl->path = path.c_str();
+  impl->name = baseName(impl->path);
+  impl->hostRoot = _root;
+
+  if (stdfs::is_directory(host, ec)) {
+    impl->dir = true;
+    std::string base = impl->path == "/" ? "" : impl->path;
+    for (auto &e : stdfs::directory_iterator(host, ec))
+      impl->entries.push_back(base + "/" + e.path().filename().string());
+    std::sort(impl->entries.begin(), impl->entries.end());
+    f._p = impl;
+    return f;
+  }
+
+  std::string m = mode;
+  if (m[0] == 'w' || m[0] == 'a' || create)
+    stdfs::create_directories(stdfs::path(host).parent_path(), ec);
+  std::string hostMode = m.find('+') != std::string::npos
+                             ? std::string(1, m[0]) + "+b"
+                             : std::string(1, m[0]) + "b";
+  impl->fp = fopen(host.c_str(), hostMode.c_str());
+  if (impl->fp)
+    f._p = impl;
+  return f;
+}
+
+bool FS::exists(const String &path) {
+  std::error_code ec;
+  return stdfs::exists(hostPath(path), ec);
+}
+
+bool FS::remove(const String &path) {
+  std::error_code ec;
+  std::string host = hostPath(path);
+  return stdfs::is_regular_file(host, ec) && stdfs::remove(host, ec);
+}
+
+bool FS::rename(const String &from, const String &to) {
+  std::error_code ec;
+  stdfs::rename(hostPath(from), hostPath(to), ec);
+  return !ec;
+}
+
+bool FS::mkdir(const String &path) {
+  std::error_code ec;
+  stdfs::create_directories(hostPath(path), ec);
+  return !ec;
+}
+
+bool FS::rmdir(const String &path) {
+  std::error_code ec;
+  return stdfs::remove(hostPath(path), ec);
+}
+
+size_t FS::totalBytes() { return capacity; }
+
+size_t FS::usedBytes() {
+  std::error_code ec;
+  size_t used = 0;
+  for (auto &e : stdfs::recursive_directory_iterator(_root, ec)) {
+    if (e.is_regular_file(ec))
+      used += e.file_size(ec);
+  }
+  return used;
+}
+
+} // namespace fs
@@ -0,0 +1,95 @@
+#pragma once
+
+// ============================================================
+//  Native Shim — fs::FS / fs::File on a Host Directory
+// ============================================================
+//
+//  Paths map below a root directory (see LittleFS.h). File mirrors
+//  the ESP32 core API the firmware uses: read/write/seek, Stream
+//  access, directory iteration and base-name name().
+//
+// ============================================================
+
+#include "Arduino.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File : public Stream {
+public:
+  File() {}
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *buf, size_t len) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t read(uint8_t *buf, size_t len);
+  size_t readBytes(char *buf, size_t len) { return read((uint8_t *)buf, len); }
+
+  bool seek(uint32_t pos, SeekMode mode = SeekSet);
+  size_t position() const;
+  size_t size() const;
+  void flush();
+  void close();
+  explicit operator bool() const;
+
+  const char *name() const;
+  const char *path() const;
+  bool isDirectory() const;
+  File openNextFile(const char *mode = "r");
+
+private:
+  friend class FS;
+  struct Impl;
+  std::shared_ptr<Impl> _p;
+};
+
+class FS {
+public:
+  explicit FS(const std::string &root) : _root(root) {}
+
+  /// Host directory backing "/" (created by begin()).
+  void setRoot(const std::string &root) { _root = root; }
+  const std::string &root() const { return _root; }
+
+  bool begin(bool formatOnFail = false, const char *basePath = "/littlefs",
+             uint8_t maxOpenFiles = 10, const char *partitionLabel = "spiffs");
+  void end() {}
+  bool format();
+
+  File open(const String &path, const char *mode = "r", bool create = false);
+  File open(const char *path, const char *mode = "r", bool create = false) {
+    return open(String(path), mode, create);
+  }
+  bool exists(const String &path);
+  bool remove(const String &path);
+  bool rename(const String &from, const String &to);
+  bool mkdir(const String &path);
+  bool rmdir(const String &path);
+
+  size_t totalBytes();
+  size_t usedBytes();
+
+  /// Nominal capacity reported by totalBytes() (the spiffs partition).
+  size_t capacity = 0x1F0000;
+
+private:
+  std::string hostPath(const String &path) const;
+  std::string _root;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::SeekMode;
+using fs::SeekSet;
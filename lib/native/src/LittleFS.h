@@ -0,0 +1,14 @@
+#pragma once
+
+// ============================================================
+//  Native Shim — LittleFS as a Host Directory
+// ============================================================
+//
+//  Root defaults to $LITTLEFS_ROOT, else ./.littlefs; change it
+//  with LittleFS.setRoot() before begin().
+//
+// ============================================================
+
+#include "FS.h"
+
+extern fs::FS LittleFS;
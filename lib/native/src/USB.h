@@ -0,0 +1,24 @@
+#pragma once
+
+// ============================================================
+//  Native Shim — ESP32 USB Device (no-op on the host)
+// ============================================================
+
+#include "Arduino.h"
+
+class ESPUSB {
+public:
+  bool VID(uint16_t v) { _vid = v; return true; }
+  bool PID(uint16_t p) { _pid = p; return true; }
+  bool manufacturerName(const char *) { return true; }
+  bool productName(const char *) { return true; }
+  bool begin() { _started = true; return true; }
+  explicit operator bool() const { return _started; }
+
+private:
+  uint16_t _vid = 0;
+  uint16_t _pid = 0;
+  bool _started = false;
+};
+
+extern ESPUSB USB;
@@ -0,0 +1,261 @@
+// ============================================================
+//  Native Shim — USB Device, Keyboard & Mouse (recorder backend)
+// ============================================================
+
+#include "USB.h"
+#include "USBHID.h"
+#include "USBHIDKeyboard.h"
+#include "USBHIDMouse.h"
+#include "hid_recorder.h"
+
+ESPUSB USB;
+
+#define SHIFT 0x80
+
+// US ASCII → usage (| SHIFT), as in the ESP32 core's _asciimap
+static uint8_t asciiToUsage(uint8_t c) {
+  static const char *shifted = "!@#$%^&*()";
+  if (c >= 'a' && c <= 'z')
+    return 0x04 + c - 'a';
+  if (c >= 'A' && c <= 'Z')
+    return (0x04 + c - 'A') | SHIFT;
+  if (c >= '1' && c <= '9')
+    return 0x1E + c - '1';
+  if (c == '0')
+    return 0x27;
+  for (int i = 0; shifted[i]; i++) {
+    if (c == (uint8_t)shifted[i])
+      return (i == 9 ? 0x27 : 0x1E + i) | SHIFT;
+  }
+  switch (c) {
+  case '\b': return 0x2A;
+  case '\t': return 0x2B;
+  case '\n': return 0x28;
+  case 0x1B: return 0x29;
+  case ' ':  return 0x2C;
+  case '-':  return 0x2D;
+  case '_':  return 0x2D | SHIFT;
+  case '=':  return 0x2E;
+  case '+':  return 0x2E | SHIFT;
+  case '[':  return 0x2F;
+  case '{':  return 0x2F | SHIFT;
+  case ']':  return 0x30;
+  case '}':  return 0x30 | SHIFT;
+  case '\\': return 0x31;
+  case '|':  return 0x31 | SHIFT;
+  case ';':  return 0x33;
+  case ':':  return 0x33 | SHIFT;
+  case '\'': return 0x34;
+  case '"':  return 0x34 | SHIFT;
+  case '`':  return 0x35;
+  case '~':  return 0x35 | SHIFT;
+  case ',':  return 0x36;
+  case '<':  return 0x36 | SHIFT;
+  case '.':  return 0x37;
+  case '>':  return 0x37 | SHIFT;
+  case '/':  return 0x38;
+  case '?':  return 0x38 | SHIFT;
+  }
+  return 0;
+}
+
+// ================================================================
+//  Keyboard
+// ================================================================
+
+void USBHIDKeyboard::sendReport(KeyReport *keys) {
+  hostHidRecord(HID_KEYBOARD, (const uint8_t *)keys, sizeof(KeyReport));
+}
+
+size_t USBHIDKeyboard::pressRaw(uint8_t k) {
+  if (k >= 0xE0 && k < 0xE8) {
+    _report.modifiers |= 1 << (k - 0xE0);
+  } else if (k && k < 0xA5) {
+    int free = -1;
+    for (int i = 0; i < 6; i++) {
+      if (_report.keys[i] == k)
+        return 1; // already down
+      if (_report.keys[i] == 0 && free < 0)
+        free = i;
+    }
+    if (free < 0)
+      return 0; // rollover
+    _report.keys[free] = k;
+  } else if (_report.modifiers == 0) {
+    return 0;
+  }
+  sendReport(&_report);
+  return 1;
+}
+
+size_t USBHIDKeyboard::releaseRaw(uint8_t k) {
+  if (k >= 0xE0 && k < 0xE8) {
+    _report.modifiers &= ~(1 << (k - 0xE0));
+  } else if (k && k < 0xA5) {
+    for (int i = 0; i < 6; i++) {
+      if (_report.keys[i] == k)
+        _report.keys[i] = 0;
+    }
+  }
+  sendReport(&_report);
+  return 1;
+}
+
+size_t USBHIDKeyboard::press(uint8_t k) {
+  if (k >= 0x88) {
+    k -= 0x88;
+  } else if (k >= 0x80) {
+    _report.modifiers |= 1 << (k - 0x80);
+    k = 0;
+  } else {
+    k = asciiToUsage(k);
+    if (!k)
+      return 0;
+    if (k & SHIFT) {
+      _report.modifiers |= 0x02;
+      k &= ~SHIFT;
+    }
+  }
+  if (k) {
+    int free = -1;
+    for (int i = 0; i < 6; i++) {
+      if (_report.keys[i] == k) {
+        free = -2;
+        break;
+      }
+      if (_report.keys[i] == 0 && free < 0)
+        free = i;
+    }
+    if (free == -1)
+      return 0;
+    if (free >= 0)
+      _report.keys[free] = k;
+  }
+  sendReport(&_report);
+  return 1;
+}
+
+size_t USBHIDKeyboard::release(uint8_t k) {
+  if (k >= 0x88) {
+    k -= 0x88;
+  } else if (k >= 0x80) {
+    _report.modifiers &= ~(1 << (k - 0x80));
+    k = 0;
+  } else {
+    k = asciiToUsage(k);
+    if (!k)
+      return 0;
+    if (k & SHIFT) {
+      _report.modifiers &= ~0x02;
+      k &= ~SHIFT;
+    }
+  }
+  for (int i = 0; i < 6; i++) {
+    if (k && _report.keys[i] == k)
+      _report.keys[i] = 0;
+  }
+  sendReport(&_report);
+  return 1;
+}
+
+static esp_event_handler_t sLedHandler = nullptr;
+static int32_t sLedHandlerEvent = ARDUINO_USB_HID_KEYBOARD_ANY_EVENT;
+
+void USBHIDKeyboard::onEvent(arduino_usb_hid_keyboard_event_t event,
+                             esp_event_handler_t callback) {
+  sLedHandler = callback;
+  sLedHandlerEvent = event;
+}
+
+void hostHidSetLeds(uint8_t leds) {
+  arduino_usb_hid_keyboard_event_data_t ev = {};
+  ev.leds = leds;
+  if (sLedHandler && (sLedHandlerEvent == ARDUINO_USB_HID_KEYBOARD_ANY_EVENT ||
+                      sLedHandlerEvent == ARDUINO_USB_HID_KEYBOARD_LED_EVENT))
+    sLedHandler(nullptr, ARDUINO_USB_HID_KEYBOARD_EVENTS,
+                ARDUINO_USB_HID_KEYBOARD_LED_EVENT, &ev);
+}
+
+void USBHIDKeyboard::releaseAll() {
+  _report = {};
+  sendReport(&_report);
+}
+
+size_t USBHIDKeyboard::write(uint8_t c) {
+  size_t p = press(c);
+  release(c);
+  return p;
+}
+
+size_t USBHIDKeyboard::write(const uint8_t *buf, size_t len) {
+  size_t n = 0;
+  while (n < len && write(buf[n]))
+    n++;
+  return n;
+}
+
+// ================================================================
+//  Mouse
+// ================================================================
+
+static void mouseReport(uint8_t buttons, int8_t x, int8_t y, int8_t wheel,
+                        int8_t pan) {
+  uint8_t r[5] = {buttons, (uint8_t)x, (uint8_t)y, (uint8_t)wheel,
+                  (uint8_t)pan};
+  hostHidRecord(HID_MOUSE, r, sizeof(r));
+}
+
+void USBHIDMouse::click(uint8_t b) {
+  _buttons = b;
+  mouseReport(_buttons, 0, 0, 0, 0);
+  _buttons = 0;
+  mouseReport(_buttons, 0, 0, 0, 0);
+}
+
+void USBHIDMouse::move(int8_t x, int8_t y, int8_t wheel, int8_t pan) {
+  mouseReport(_buttons, x, y, wheel, pan);
+}
+
+void USBHIDMouse::press(uint8_t b) {
+  if ((_buttons | b) != _buttons) {
+    _buttons |= b;
+    mouseReport(_buttons, 0, 0, 0, 0);
+  }
+}
+
+void USBHIDMouse::release(uint8_t b) {
+  if ((_buttons & ~b) != _buttons) {
+    _buttons &= ~b;
+    mouseReport(_buttons, 0, 0, 0, 0);
+  }
+}
+
+// ================================================================
+//  Custom report devices
+// ================================================================
+
+bool USBHID::SendReport(uint8_t reportId, const void *data, size_t len,
+                        uint32_t timeoutMs) {
+  uint8_t r[sizeof(HidReport::data)] = {reportId};
+  memcpy(r + 1, data, len < sizeof(r) - 1 ? len : sizeof(r) - 1);
+  hostHidRecord(HID_REPORT, r, len + 1 < sizeof(r) ? len + 1 : sizeof(r));
+  return true;
+}
+
+static esp_event_handler_t sHandler = nullptr;
+static int32_t sHandlerEvent = ARDUINO_USB_HID_ANY_EVENT;
+
+void USBHID::onEvent(arduino_usb_hid_event_t event,
+                     esp_event_handler_t callback) {
+  sHandler = callback;
+  sHandlerEvent = event;
+}
+
+void hostHidSetProtocol(uint8_t protocol) {
+  arduino_usb_hid_event_data_t ev = {};
+  ev.set_protocol.protocol = protocol;
+  if (sHandler && (sHandlerEvent == ARDUINO_USB_HID_ANY_EVENT ||
+                   sHandlerEvent == ARDUINO_USB_HID_SET_PROTOCOL_EVENT))
+    sHandler(nullptr, ARDUINO_USB_HID_EVENTS,
+             ARDUINO_USB_HID_SET_PROTOCOL_EVENT, &ev);
+}
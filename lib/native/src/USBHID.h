@@ -0,0 +1,60 @@
+#pragma once
+
+// ============================================================
+//  Native Shim — USBHID / USBHIDDevice (custom report devices)
+// ============================================================
+//
+//  As in the ESP32 core: a USBHIDDevice supplies its report
+//  descriptor and sends reports through USBHID::SendReport(). Here
+//  every report goes to the recorder as HID_REPORT, prefixed with
+//  its report ID. hostHidSetProtocol() plays the host's
+//  SET_PROTOCOL request (one handler, as registered last).
+//
+// ============================================================
+
+#include "Arduino.h"
+
+typedef const char *esp_event_base_t;
+typedef void (*esp_event_handler_t)(void *arg, esp_event_base_t base,
+                                    int32_t id, void *data);
+#define ARDUINO_USB_HID_EVENTS "ARDUINO_USB_HID_EVENTS"
+
+typedef enum {
+  ARDUINO_USB_HID_ANY_EVENT = -1,
+  ARDUINO_USB_HID_SET_PROTOCOL_EVENT = 0,
+  ARDUINO_USB_HID_SET_IDLE_EVENT,
+} arduino_usb_hid_event_t;
+
+typedef struct {
+  uint8_t instance;
+  union {
+    struct {
+      uint8_t protocol; // 0 = boot, 1 = report
+    } set_protocol;
+    struct {
+      uint8_t idle_rate;
+    } set_idle;
+  };
+} arduino_usb_hid_event_data_t;
+
+class USBHIDDevice {
+public:
+  virtual ~USBHIDDevice() {}
+  virtual uint16_t _onGetDescriptor(uint8_t *buffer) { return 0; }
+};
+
+class USBHID {
+public:
+  void begin() {}
+  void end() {}
+  bool addDevice(USBHIDDevice *device, uint16_t descriptorLen) {
+    return true;
+  }
+  bool SendReport(uint8_t reportId, const void *data, size_t len,
+                  uint32_t timeoutMs = 100);
+  void onEvent(arduino_usb_hid_event_t event, esp_event_handler_t callback);
+};
+
+/// Deliver a SET_PROTOCOL request (0 = boot, 1 = report) as the host
+/// would.
+void hostHidSetProtocol(uint8_t protocol);
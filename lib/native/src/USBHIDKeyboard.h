@@ -0,0 +1,109 @@
+#pragma once
+
+// ============================================================
+//  Native Shim — USBHIDKeyboard (recorder backend)
+// ============================================================
+//
+//  Same key codes and press()/write() semantics as the ESP32
+//  core: < 0x80 is ASCII (US map), 0x80–0x87 modifiers, ≥ 0x88
+//  raw usage + 0x88. pressRaw() takes HID usages (0xE0–0xE7 are
+//  modifiers). Each state change is recorded as a boot report.
+//  hostHidSetLeds() plays the host's LED output report (one
+//  handler, as registered last).
+//
+// ============================================================
+
+#include "Arduino.h"
+#include "USBHID.h"
+
+#define ARDUINO_USB_HID_KEYBOARD_EVENTS "ARDUINO_USB_HID_KEYBOARD_EVENTS"
+
+typedef enum {
+  ARDUINO_USB_HID_KEYBOARD_ANY_EVENT = -1,
+  ARDUINO_USB_HID_KEYBOARD_LED_EVENT = 0,
+} arduino_usb_hid_keyboard_event_t;
+
+typedef union {
+  struct {
+    uint8_t numlock : 1;
+    uint8_t capslock : 1;
+    uint8_t scrolllock : 1;
+    uint8_t compose : 1;
+    uint8_t kana : 1;
+    uint8_t reserved : 3;
+  };
+  uint8_t leds;
+} arduino_usb_hid_keyboard_event_data_t;
+
+#define KEY_LEFT_CTRL 0x80
+#define KEY_LEFT_SHIFT 0x81
+#define KEY_LEFT_ALT 0x82
+#define KEY_LEFT_GUI 0x83
+#define KEY_RIGHT_CTRL 0x84
+#define KEY_RIGHT_SHIFT 0x85
+#define KEY_RIGHT_ALT 0x86
+#define KEY_RIGHT_GUI 0x87
+
+#define KEY_UP_ARROW 0xDA
+#define KEY_DOWN_ARROW 0xD9
+#define KEY_LEFT_ARROW 0xD8
+#define KEY_RIGHT_ARROW 0xD7
+#define KEY_MENU 0xFE
+#define KEY_SPACE 0x20
+#define KEY_BACKSPACE 0xB2
+#define KEY_TAB 0xB3
+#define KEY_RETURN 0xB0
+#define KEY_ESC 0xB1
+#define KEY_INSERT 0xD1
+#define KEY_DELETE 0xD4
+#define KEY_PAGE_UP 0xD3
+#define KEY_PAGE_DOWN 0xD6
+#define KEY_HOME 0xD2
+#define KEY_END 0xD5
+#define KEY_NUM_LOCK 0xDB
+#define KEY_CAPS_LOCK 0xC1
+#define KEY_F1 0xC2
+#define KEY_F2 0xC3
+#define KEY_F3 0xC4
+#define KEY_F4 0xC5
+#define KEY_F5 0xC6
+#define KEY_F6 0xC7
+#define KEY_F7 0xC8
+#define KEY_F8 0xC9
+#define KEY_F9 0xCA
+#define KEY_F10 0xCB
+#define KEY_F11 0xCC
+#define KEY_F12 0xCD
+#define KEY_PRINT_SCREEN 0xCE
+#define KEY_SCROLL_LOCK 0xCF
+#define KEY_PAUSE 0xD0
+
+typedef struct {
+  uint8_t modifiers;
+  uint8_t reserved;
+  uint8_t keys[6];
+} KeyReport;
+
+class USBHIDKeyboard : public Print {
+public:
+  void begin() {}
+  void end() {}
+  size_t write(uint8_t k) override;
+  size_t write(const uint8_t *buf, size_t len) override;
+  using Print::write;
+  size_t press(uint8_t k);
+  size_t release(uint8_t k);
+  void releaseAll();
+  size_t pressRaw(uint8_t k);
+  size_t releaseRaw(uint8_t k);
+  void sendReport(KeyReport *keys);
+  void onEvent(arduino_usb_hid_keyboard_event_t event,
+               esp_event_handler_t callback);
+
+private:
+  KeyReport _report = {};
+};
+
+/// Deliver a keyboard LED output report (bit 0 Num, 1 Caps, 2 Scroll
+/// Lock) as the host would.
+void hostHidSetLeds(uint8_t leds);
@@ -0,0 +1,28 @@
+#pragma once
+
+// ============================================================
+//  Native Shim — USBHIDMouse (recorder backend)
+// ============================================================
+
+#include "Arduino.h"
+
+#define MOUSE_LEFT 0x01
+#define MOUSE_RIGHT 0x02
+#define MOUSE_MIDDLE 0x04
+#define MOUSE_BACKWARD 0x08
+#define MOUSE_FORWARD 0x10
+#define MOUSE_ALL 0x1F
+
+class USBHIDMouse {
+public:
+  void begin() {}
+  void end() {}
+  void click(uint8_t b = MOUSE_LEFT);
+  void move(int8_t x, int8_t y, int8_t wheel = 0, int8_t pan = 0);
+  void press(uint8_t b = MOUSE_LEFT);
+  void release(uint8_t b = MOUSE_LEFT);
+  bool isPressed(uint8_t b = MOUSE_LEFT) { return (_buttons & b) != 0; }
+
+private:
+  uint8_t _buttons = 0;
+};
@@ -0,0 +1,89 @@
+// ============================================================
+//  Native Shim — Arduino String
+// ============================================================
+
+#include "WString.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <strings.h>
+
+String::String(double v, unsigned int decimals) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+  _s = buf;
+}
+
+void String::fromInt(long long v, unsigned char base) {
+  if (v < 0 && base == 10) {
+    fromUInt((unsigned long long)(-v), base);
+    _s.insert(_s.begin(), '-');
+  } else {
+    fromUInt((unsigned long long)v, base);
+  }
+}
+
+void String::fromUInt(unsigned long long v, unsigned char base) {
+  static const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+  if (base < 2 || base > 36)
+    base = 10;
+  _s.clear();
+  do {
+    _s.insert(_s.begin(), digits[v % base]);
+    v /= base;
+  } while (v);
+}
+
+bool String::equalsIgnoreCase(const String &s) const {
+  return _s.size() == s._s.size() && strcasecmp(_s.c_str(), s._s.c_str()) == 0;
+}
+
+bool String::startsWith(const String &p, unsigned int off) const {
+  return off <= _s.size() && _s.compare(off, p._s.size(), p._s) == 0;
+}
+
+bool String::endsWith(const String &p) const {
+  return _s.size() >= p._s.size() &&
+         _s.compare(_s.size() - p._s.size(), p._s.size(), p._s) == 0;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to)
+    std::swap(from, to);
+  if (from >= _s.size())
+    return String();
+  return String(_s.substr(from, std::min<size_t>(to, _s.size()) - from));
+}
+
+void String::replace(char a, char b) { std::replace(_s.begin(), _s.end(), a, b); }
+
+void String::replace(const String &a, const String &b) {
+  if (a._s.empty())
+    return;
+  size_t p = 0;
+  while ((p = _s.find(a._s, p)) != std::string::npos) {
+    _s.replace(p, a._s.size(), b._s);
+    p += b._s.size();
+  }
+}
+
+void String::toLowerCase() {
+  for (auto &c : _s)
+    c = tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+  for (auto &c : _s)
+    c = toupper((unsigned char)c);
+}
+
+void String::trim() {
+  size_t a = _s.find_first_not_of(" \t\r\n\v\f");
+  if (a == std::string::npos) {
+    _s.clear();
+    return;
+  }
+  size_t b = _s.find_last_not_of(" \t\r\n\v\f");
+  _s = _s.substr(a, b - a + 1);
+}
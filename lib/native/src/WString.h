@@ -0,0 +1,94 @@
+#pragma once
+
+// ============================================================
+//  Native Shim — Arduino String
+// ============================================================
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+class String {
+public:
+  String() {}
+  String(const char *s) : _s(s ? s : "") {}
+  String(const std::string &s) : _s(s) {}
+  explicit String(char c) : _s(1, c) {}
+  String(int v, unsigned char base = 10) { fromInt(v, base); }
+  String(unsigned v, unsigned char base = 10) { fromUInt(v, base); }
+  String(long v, unsigned char base = 10) { fromInt(v, base); }
+  String(unsigned long v, unsigned char base = 10) { fromUInt(v, base); }
+  String(long long v, unsigned char base = 10) { fromInt(v, base); }
+  String(unsigned long long v, unsigned char base = 10) { fromUInt(v, base); }
+  String(double v, unsigned int decimals = 2);
+
+  unsigned int length() const { return _s.size(); }
+  bool isEmpty() const { return _s.empty(); }
+  const char *c_str() const { return _s.c_str(); }
+  bool reserve(unsigned int n) { _s.reserve(n); return true; }
+
+  char charAt(unsigned int i) const { return i < _s.size() ? _s[i] : 0; }
+  void setCharAt(unsigned int i, char c) { if (i < _s.size()) _s[i] = c; }
+  char operator[](unsigned int i) const { return charAt(i); }
+  char &operator[](unsigned int i) { return _s[i]; }
+
+  bool concat(const String &s) { _s += s._s; return true; }
+  bool concat(const char *s) { if (s) _s += s; return true; }
+  bool concat(const char *s, unsigned int n) { _s.append(s, n); return true; }
+  bool concat(char c) { _s += c; return true; }
+  String &operator+=(const String &s) { _s += s._s; return *this; }
+  String &operator+=(const char *s) { if (s) _s += s; return *this; }
+  String &operator+=(char c) { _s += c; return *this; }
+  String &operator+=(int v) { _s += std::to_string(v); return *this; }
+  String &operator+=(unsigned v) { _s += std::to_string(v); return *this; }
+  String &operator+=(long v) { _s += std::to_string(v); return *this; }
+  String &operator+=(unsigned long v) { _s += std::to_string(v); return *this; }
+
+  bool equals(const String &s) const { return _s == s._s; }
+  bool equalsIgnoreCase(const String &s) const;
+  bool operator==(const String &s) const { return _s == s._s; }
+  bool operator==(const char *s) const { return _s == (s ? s : ""); }
+  bool operator!=(const String &s) const { return _s != s._s; }
+  bool operator!=(const char *s) const { return !(*this == s); }
+  bool operator<(const String &s) const { return _s < s._s; }
+  bool startsWith(const String &p) const { return _s.compare(0, p._s.size(), p._s) == 0; }
+  bool startsWith(const String &p, unsigned int off) const;
+  bool endsWith(const String &p) const;
+
+  int indexOf(char c, unsigned int from = 0) const { return pos(_s.find(c, from)); }
+  int indexOf(const String &s, unsigned int from = 0) const { return pos(_s.find(s._s, from)); }
+  int lastIndexOf(char c) const { return pos(_s.rfind(c)); }
+  int lastIndexOf(const String &s) const { return pos(_s.rfind(s._s)); }
+  String substring(unsigned int from) const { return substring(from, _s.size()); }
+  String substring(unsigned int from, unsigned int to) const;
+
+  void replace(char a, char b);
+  void replace(const String &a, const String &b);
+  void remove(unsigned int index) { if (index < _s.size()) _s.erase(index); }
+  void remove(unsigned int index, unsigned int count) { if (index < _s.size()) _s.erase(index, count); }
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+
+  long toInt() const { return strtol(_s.c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(_s.c_str(), nullptr); }
+  double toDouble() const { return strtod(_s.c_str(), nullptr); }
+
+  const std::string &str() const { return _s; }
+
+private:
+  static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+  void fromInt(long long v, unsigned char base);
+  void fromUInt(unsigned long long v, unsigned char base);
+
+  std::string _s;
+};
+
+inline String operator+(const String &a, const String &b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, const char *b) { String r(a); r += b; return r; }
+inline String operator+(const char *a, const String &b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, char b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, int b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, unsigned b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, long b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, unsigned long b) { String r(a); r += b; return r; }
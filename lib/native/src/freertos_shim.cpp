@@ -0,0 +1,340 @@
+// ============================================================
+//  Native Shim — FreeRTOS Primitives on std::thread
+// ============================================================
+
+#include "freertos_shim.h"
+#include "host_clock.h"
+#include "host_heap.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct HostTask {
+  const char *name;
+  uint32_t stackDepth;
+  UBaseType_t priority;
+  BaseType_t core;
+  bool deleted;
+};
+
+struct HostSemaphore {
+  std::mutex m;
+  std::condition_variable cv;
+  UBaseType_t count;
+  UBaseType_t max;
+  std::thread::id owner; // recursive mutex: holder and depth
+  UBaseType_t depth = 0;
+  bool mutex = false; // held briefly, vs. a signal that a task waits on
+};
+
+struct HostQueue {
+  std::mutex m;
+  std::condition_variable cv;
+  std::deque<std::vector<uint8_t>> items;
+  UBaseType_t length;
+  UBaseType_t itemSize;
+};
+
+static thread_local HostTask *tCurrent = nullptr;
+static std::atomic<UBaseType_t> sTaskCount{0};
+static std::recursive_mutex gCritical;
+
+// Wait on `cv` until `ready()` or the FreeRTOS timeout expires.
+template <class Pred>
+static bool waitFor(std::unique_lock<std::mutex> &lock,
+                    std::condition_variable &cv, TickType_t ticks,
+                    Pred ready) {
+  if (ticks == portMAX_DELAY) {
+    cv.wait(lock, ready);
+    return true;
+  }
+  return cv.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+}
+
+// ================================================================
+//  Tasks
+// ================================================================
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name,
+                                   uint32_t stackDepth, void *param,
+                                   UBaseType_t priority, TaskHandle_t *handle,
+                                   BaseType_t core) {
+  HostTask *task = new HostTask{name, stackDepth, priority, core, false};
+  if (handle)
+    *handle = task;
+  sTaskCount++;
+  // The task's allocations count in its creator's heap scope
+  HostHeapScope *scope = hostHeapCurrentScope();
+  std::thread([fn, param, task, scope]() {
+    hostHeapEnter(scope);
+    tCurrent = task;
+    fn(param);
+    // As on FreeRTOS, the handle is invalid once the task is gone
+    tCurrent = nullptr;
+    delete task;
+    // Leave before the count drops: a waiter may then end the scope
+    hostHeapEnter(nullptr);
+    sTaskCount--;
+  }).detach();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name,
+                       uint32_t stackDepth, void *param, UBaseType_t priority,
+                       TaskHandle_t *handle) {
+  return xTaskCreatePinnedToCore(fn, name, stackDepth, param, priority,
+                                 handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  // Threads can't be killed; the task function returns right after this.
+  if (!task)
+    task = tCurrent;
+  if (task)
+    task->deleted = true;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  hostClockSleepMicros((uint64_t)ticks * portTICK_PERIOD_MS * 1000);
+}
+
+TickType_t xTaskGetTickCount() {
+  return hostClockMicros() / (1000 * portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() { return tCurrent; }
+
+UBaseType_t uxTaskGetNumberOfTasks() { return sTaskCount; }
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+  if (!task)
+    task = tCurrent;
+  return task ? task->stackDepth : 0;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task) {
+  if (!task)
+    task = tCurrent;
+  return task ? task->priority : 1;
+}
+
+void vTaskPrioritySet(TaskHandle_t task, UBaseType_t priority) {
+  if (!task)
+    task = tCurrent;
+  if (task)
+    task->priority = priority;
+}
+
+BaseType_t xPortGetCoreID() {
+  return tCurrent && tCurrent->core != tskNO_AFFINITY ? tCurrent->core : 1;
+}
+
+void taskYIELD() { std::this_thread::yield(); }
+
+// ================================================================
+//  Semaphores
+// ================================================================
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  SemaphoreHandle_t s = xSemaphoreCreateCounting(1, 1);
+  s->mutex = true;
+  return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+  return xSemaphoreCreateCounting(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t init) {
+  HostSemaphore *s = new HostSemaphore();
+  s->count = init;
+  s->max = max;
+  return s;
+}
+
+// A timed take of a signal is a sleep that a give ends early. Wait a
+// tick at a time through hostClockSleepMicros(), so virtual time moves
+// on and hostClockAt() events due meanwhile (the host's LED reports,
+// button presses) fire and can give it.
+static BaseType_t takeSignal(SemaphoreHandle_t sem, TickType_t ticks) {
+  const uint64_t tickUs = portTICK_PERIOD_MS * 1000;
+  uint64_t deadline = hostClockMicros() + (uint64_t)ticks * tickUs;
+  for (;;) {
+    bool virt = hostClockIsVirtual();
+    {
+      std::unique_lock<std::mutex> lock(sem->m);
+      if (!virt)
+        sem->cv.wait_for(lock, std::chrono::microseconds(tickUs),
+                         [sem] { return sem->count > 0; });
+      if (sem->count > 0) {
+        sem->count--;
+        return pdTRUE;
+      }
+    }
+    uint64_t now = hostClockMicros();
+    if (now >= deadline)
+      return pdFALSE;
+    // Real time: the tick was spent above, this only fires the events
+    hostClockSleepMicros(virt ? std::min(deadline - now, tickUs) : 0);
+  }
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+  if (!sem->mutex && ticks != 0 && ticks != portMAX_DELAY)
+    return takeSignal(sem, ticks);
+  std::unique_lock<std::mutex> lock(sem->m);
+  if (!waitFor(lock, sem->cv, ticks, [sem] { return sem->count > 0; }))
+    return pdFALSE;
+  sem->count--;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+  std::lock_guard<std::mutex> lock(sem->m);
+  if (sem->count >= sem->max)
+    return pdFALSE;
+  sem->count++;
+  sem->cv.notify_one();
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *woken) {
+  if (woken)
+    *woken = pdFALSE;
+  return xSemaphoreGive(sem);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+  return xSemaphoreCreateMutex();
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks) {
+  {
+    std::lock_guard<std::mutex> lock(sem->m);
+    if (sem->depth && sem->owner == std::this_thread::get_id()) {
+      sem->depth++;
+      return pdTRUE;
+    }
+  }
+  if (xSemaphoreTake(sem, ticks) != pdTRUE)
+    return pdFALSE;
+  std::lock_guard<std::mutex> lock(sem->m);
+  sem->owner = std::this_thread::get_id();
+  sem->depth = 1;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem) {
+  {
+    std::lock_guard<std::mutex> lock(sem->m);
+    if (!sem->depth || sem->owner != std::this_thread::get_id())
+      return pdFALSE;
+    if (--sem->depth)
+      return pdTRUE;
+    sem->owner = std::thread::id();
+  }
+  return xSemaphoreGive(sem);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) { delete sem; }
+
+// ================================================================
+//  Queues
+// ================================================================
+
+// FreeRTOS allocates queue storage up front; here items come and go
+// on the heap, so keep them out of the caller's heap scope
+struct OutsideHeapScope {
+  HostHeapScope *saved = hostHeapCurrentScope();
+  OutsideHeapScope() { hostHeapEnter(nullptr); }
+  ~OutsideHeapScope() { hostHeapEnter(saved); }
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  HostQueue *q = new HostQueue();
+  q->length = length;
+  q->itemSize = itemSize;
+  return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks) {
+  OutsideHeapScope outside;
+  std::unique_lock<std::mutex> lock(q->m);
+  if (!waitFor(lock, q->cv, ticks, [q] { return q->items.size() < q->length; }))
+    return pdFALSE;
+  const uint8_t *p = (const uint8_t *)item;
+  q->items.emplace_back(p, p + q->itemSize);
+  q->cv.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t q, const void *item,
+                            TickType_t ticks) {
+  return xQueueSend(q, item, ticks);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t q, const void *item) {
+  OutsideHeapScope outside;
+  std::lock_guard<std::mutex> lock(q->m);
+  const uint8_t *p = (const uint8_t *)item;
+  if (!q->items.empty())
+    q->items.back().assign(p, p + q->itemSize);
+  else
+    q->items.emplace_back(p, p + q->itemSize);
+  q->cv.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks) {
+  OutsideHeapScope outside;
+  std::unique_lock<std::mutex> lock(q->m);
+  if (!waitFor(lock, q->cv, ticks, [q] { return !q->items.empty(); }))
+    return pdFALSE;
+  memcpy(item, q->items.front().data(), q->itemSize);
+  q->items.pop_front();
+  q->cv.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t q, void *item, TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(q->m);
+  if (!waitFor(lock, q->cv, ticks, [q] { return !q->items.empty(); }))
+    return pdFALSE;
+  memcpy(item, q->items.front().data(), q->itemSize);
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+  std::lock_guard<std::mutex> lock(q->m);
+  return q->items.size();
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q) {
+  std::lock_guard<std::mutex> lock(q->m);
+  return q->length - q->items.size();
+}
+
+BaseType_t xQueueReset(QueueHandle_t q) {
+  OutsideHeapScope outside;
+  std::lock_guard<std::mutex> lock(q->m);
+  q->items.clear();
+  q->cv.notify_all();
+  return pdPASS;
+}
+
+void vQueueDelete(QueueHandle_t q) { delete q; }
+
+// ================================================================
+//  Critical Sections
+// ================================================================
+
+void vPortEnterCritical(portMUX_TYPE *) { gCritical.lock(); }
+
+void vPortExitCritical(portMUX_TYPE *) { gCritical.unlock(); }
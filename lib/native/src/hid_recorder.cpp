@@ -0,0 +1,46 @@
+// ============================================================
+//  Native Shim — HID Report Recorder
+// ============================================================
+
+#include "hid_recorder.h"
+#include "host_clock.h"
+
+#include <cstring>
+#include <mutex>
+
+static std::mutex sLock;
+static std::vector<HidReport> sReports;
+static size_t sCount = 0;
+static bool sStore = true;
+
+void hostHidRecord(HidReportKind kind, const uint8_t *data, size_t len) {
+  std::lock_guard<std::mutex> lock(sLock);
+  sCount++;
+  if (!sStore)
+    return;
+  HidReport r = {hostClockMicros(), kind, 0, {0}};
+  r.len = len < sizeof(r.data) ? len : sizeof(r.data);
+  memcpy(r.data, data, r.len);
+  sReports.push_back(r);
+}
+
+std::vector<HidReport> hostHidReports() {
+  std::lock_guard<std::mutex> lock(sLock);
+  return sReports;
+}
+
+size_t hostHidReportCount() {
+  std::lock_guard<std::mutex> lock(sLock);
+  return sCount;
+}
+
+void hostHidClear() {
+  std::lock_guard<std::mutex> lock(sLock);
+  sReports.clear();
+  sCount = 0;
+}
+
+void hostHidStore(bool enable) {
+  std::lock_guard<std::mutex> lock(sLock);
+  sStore = enable;
+}
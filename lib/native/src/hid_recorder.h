@@ -0,0 +1,45 @@
+#pragma once
+
+// ============================================================
+//  Native Shim — HID Report Recorder
+// ============================================================
+//
+//  The host USBHIDKeyboard / USBHIDMouse / USBHID stand-ins hand every
+//  report they would have sent to the recorder, timestamped with
+//  hostClockMicros().
+//
+// ============================================================
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum HidReportKind : uint8_t {
+  HID_KEYBOARD = 1,
+  HID_MOUSE = 2,
+  HID_REPORT = 3
+};
+
+struct HidReport {
+  uint64_t us;
+  uint8_t kind;
+  uint8_t len;      // bytes used in `data`
+  uint8_t data[18]; // keyboard: mods, 0, keys[6] | mouse: buttons, x, y, wheel, pan
+                    // | report: report ID, report bytes
+};
+
+/// Record a report (called by the HID stand-ins).
+void hostHidRecord(HidReportKind kind, const uint8_t *data, size_t len);
+
+/// Reports recorded since the last hostHidClear().
+std::vector<HidReport> hostHidReports();
+
+/// Number of reports since the last hostHidClear() (counted even when
+/// storing is off).
+size_t hostHidReportCount();
+
+/// Drop recorded reports and reset the count.
+void hostHidClear();
+
+/// Keep report contents (default) or only count them.
+void hostHidStore(bool enable);
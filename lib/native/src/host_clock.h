@@ -0,0 +1,32 @@
+#pragma once
+
+// ============================================================
+//  Native Shim — Host Clock (real or virtual time)
+// ============================================================
+//
+//  In virtual mode delay()/vTaskDelay() return immediately and
+//  advance a shared clock instead, so a script with minutes of
+//  DELAYs runs in milliseconds while timestamps stay realistic.
+//
+// ============================================================
+
+#include <cstdint>
+#include <functional>
+
+/// Switch between wall-clock time (default) and virtual time.
+void hostClockUseVirtual(bool enable);
+bool hostClockIsVirtual();
+
+/// Microseconds since start (virtual or real).
+uint64_t hostClockMicros();
+
+/// Sleep (real mode) or advance the clock (virtual mode).
+void hostClockSleepMicros(uint64_t us);
+
+/// Reset the virtual clock to zero.
+void hostClockReset();
+
+/// Run `fn` once the clock reaches `us`, on the first thread whose
+/// sleep gets it there — a host event (LED report, button) that a
+/// polling task sees at the same point in virtual or real time.
+void hostClockAt(uint64_t us, std::function<void()> fn);
@@ -0,0 +1,103 @@
+// ============================================================
+//  Native Shim — Heap Accounting
+// ============================================================
+
+#include "host_heap.h"
+
+#include <atomic>
+#include <cstdint>
+#include <malloc.h>
+
+// Under AddressSanitizer (env:native_fuzz) ASan owns malloc: leave it
+// alone, and the heap figures stay at zero
+#if defined(__SANITIZE_ADDRESS__)
+#define HOST_HEAP_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define HOST_HEAP_ASAN 1
+#endif
+#endif
+
+static std::atomic<int64_t> sLive{0};
+static std::atomic<int64_t> sPeak{0};
+static thread_local HostHeapScope *tScope = nullptr;
+
+#ifndef HOST_HEAP_ASAN
+
+extern "C" {
+void *__libc_malloc(size_t);
+void *__libc_calloc(size_t, size_t);
+void *__libc_realloc(void *, size_t);
+void __libc_free(void *);
+}
+
+static void account(std::atomic<int64_t> &live, std::atomic<int64_t> &peak,
+                    int64_t delta) {
+  int64_t now = live.fetch_add(delta, std::memory_order_relaxed) + delta;
+  int64_t high = peak.load(std::memory_order_relaxed);
+  while (now > high &&
+         !peak.compare_exchange_weak(high, now, std::memory_order_relaxed)) {
+  }
+}
+
+static void account(int64_t delta) {
+  account(sLive, sPeak, delta);
+  if (tScope)
+    account(tScope->live, tScope->peak, delta);
+}
+
+extern "C" {
+
+void *malloc(size_t n) {
+  void *p = __libc_malloc(n);
+  if (p)
+    account(malloc_usable_size(p));
+  return p;
+}
+
+void *calloc(size_t n, size_t size) {
+  void *p = __libc_calloc(n, size);
+  if (p)
+    account(malloc_usable_size(p));
+  return p;
+}
+
+void *realloc(void *old, size_t n) {
+  int64_t before = old ? malloc_usable_size(old) : 0;
+  void *p = __libc_realloc(old, n);
+  if (p)
+    account((int64_t)malloc_usable_size(p) - before);
+  else if (n == 0)
+    account(-before);
+  return p;
+}
+
+void free(void *p) {
+  if (!p)
+    return;
+  account(-(int64_t)malloc_usable_size(p));
+  __libc_free(p);
+}
+
+} // extern "C"
+
+#endif // HOST_HEAP_ASAN
+
+size_t hostHeapLive() {
+  int64_t v = sLive.load(std::memory_order_relaxed);
+  return v > 0 ? v : 0;
+}
+
+size_t hostHeapPeak() {
+  int64_t v = sPeak.load(std::memory_order_relaxed);
+  return v > 0 ? v : 0;
+}
+
+void hostHeapResetPeak() {
+  sPeak.store(sLive.load(std::memory_order_relaxed),
+              std::memory_order_relaxed);
+}
+
+void hostHeapEnter(HostHeapScope *scope) { tScope = scope; }
+
+HostHeapScope *hostHeapCurrentScope() { return tScope; }
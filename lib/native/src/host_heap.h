@@ -0,0 +1,44 @@
+#pragma once
+
+// ============================================================
+//  Native Shim — Heap Accounting
+// ============================================================
+//
+//  malloc/calloc/realloc/free are wrapped (glibc __libc_*) so the
+//  host build can report live and peak heap like the device does.
+//  ESP.getFreeHeap() / getMinFreeHeap() are derived from these.
+//
+//  The process-wide figures include every thread (status task,
+//  timers, ...). A HostHeapScope counts only the threads inside it:
+//  a thread enters with hostHeapEnter(), and tasks it creates start
+//  in the same scope (freertos_shim), so one run can be measured
+//  while the rest of the process keeps allocating.
+//
+// ============================================================
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/// Net allocations of the threads in one scope. Frees of memory the
+/// scope didn't allocate count too, so `live` can go negative.
+struct HostHeapScope {
+  std::atomic<int64_t> live{0};
+  std::atomic<int64_t> peak{0};
+};
+
+/// Bytes currently allocated.
+size_t hostHeapLive();
+
+/// Highest hostHeapLive() since start or the last reset.
+size_t hostHeapPeak();
+
+/// Restart peak tracking from the current live size.
+void hostHeapResetPeak();
+
+/// Account the calling thread's allocations to `scope` from now on
+/// (nullptr: to none). The scope must outlive every thread in it.
+void hostHeapEnter(HostHeapScope *scope);
+
+/// Scope of the calling thread, nullptr if none.
+HostHeapScope *hostHeapCurrentScope();
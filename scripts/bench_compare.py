@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+# ============================================================
+#  Benchmark comparison — baseline JSON vs. a new run
+# ============================================================
+#
+#  python3 scripts/bench_compare.py bench/baseline-native.json new.json
+#
+#  Deterministic fields (lines, reports, chars, simUs) must match
+#  exactly — a change there means the HID output or its timing
+#  changed. Cost fields may drift within --tolerance percent:
+#    nsPerLine, peakHeap      higher is worse
+#    reportsPerSec            lower is worse
+#  Exits 1 on any regression or mismatch.
+#
+# ============================================================
+
+import argparse
+import json
+import sys
+
+EXACT = ("lines", "reports", "chars", "simUs")
+HIGHER_WORSE = ("nsPerLine", "peakHeap")
+LOWER_WORSE = ("reportsPerSec",)
+
+
+# ----------------------------------------------------------------
+def load(path):
+    with open(path) as f:
+        doc = json.load(f)
+    return doc.get("target", "?"), {c["name"]: c for c in doc["cases"]}
+
+
+def pct(old, new):
+    return 0.0 if old == 0 else (new - old) * 100.0 / old
+
+
+# ----------------------------------------------------------------
+def main():
+    ap = argparse.ArgumentParser(description=__doc__)
+    ap.add_argument("baseline")
+    ap.add_argument("current")
+    ap.add_argument("--tolerance", type=float, default=25.0,
+                    help="allowed cost regression in percent (default 25)")
+    args = ap.parse_args()
+
+    base_target, base = load(args.baseline)
+    cur_target, cur = load(args.current)
+    if base_target != cur_target:
+        print(f"warning: comparing {base_target} baseline with "
+              f"{cur_target} run")
+
+    failed = False
+    for name, b in base.items():
+        c = cur.get(name)
+        if c is None:
+            print(f"{name:14s} MISSING from current run")
+            failed = True
+            continue
+        notes = []
+        if not c.get("ok", True):
+            notes.append("did not finish")
+        for key in EXACT:
+            if b[key] != c[key]:
+                notes.append(f"{key} {b[key]} -> {c[key]}")
+        for key in HIGHER_WORSE + LOWER_WORSE:
+            d = pct(b[key], c[key])
+            worse = d > args.tolerance if key in HIGHER_WORSE \
+                else d < -args.tolerance
+            if worse:
+                notes.append(f"{key} {b[key]} -> {c[key]} ({d:+.1f}%)")
+        failed = failed or bool(notes)
+        summary = f"ns/line {pct(b['nsPerLine'], c['nsPerLine']):+6.1f}%  " \
+                  f"heap {pct(b['peakHeap'], c['peakHeap']):+6.1f}%"
+        print(f"{name:14s} {summary}  {'; '.join(notes) or 'ok'}")
+
+    for name in cur.keys() - base.keys():
+        print(f"{name:14s} new case (not in baseline)")
+
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,128 @@
+# ============================================================
+#  Web UI asset pipeline — PlatformIO extra_script (pre:)
+# ============================================================
+#
+#  Before `buildfs` / `uploadfs`, turns data/ into a filesystem
+#  image tree under .pio/webfs/:
+#    1. minifies index.html, app.js and style.css
+#    2. content-hashes app.js / style.css into www/assets/
+#       (app.<hash>.js) and rewrites the references in index.html
+#    3. stores every web asset gzip-compressed only (*.gz)
+#
+#  The web server serves the .gz files with Content-Encoding: gzip
+#  and marks www/assets/ as immutable.
+#
+# ============================================================
+
+import gzip
+import hashlib
+import os
+import re
+import shutil
+
+Import("env")  # noqa: F821  (provided by PlatformIO/SCons)
+
+SRC_DIR = env.subst("$PROJECT_DATA_DIR")                       # noqa: F821
+OUT_DIR = os.path.join(env.subst("$PROJECT_DIR"), ".pio", "webfs")  # noqa: F821
+WEB_SUBDIR = "www"
+FINGERPRINTED = (".js", ".css")
+FS_TARGETS = {"buildfs", "uploadfs", "uploadfsota"}
+
+
+# ----------------------------------------------------------------
+def minify_css(text):
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    text = re.sub(r"\s+", " ", text)
+    text = re.sub(r"\s*([{}:;,>])\s*", r"\1", text)
+    return text.replace(";}", "}").strip()
+
+
+def minify_js(text):
+    # Line-based and conservative: strips indentation, blank lines and
+    # whole-line // comments, but leaves template literals untouched.
+    out = []
+    in_template = False
+    for line in text.splitlines():
+        if in_template:
+            out.append(line)
+        else:
+            stripped = line.strip()
+            if stripped and not stripped.startswith("//"):
+                out.append(stripped)
+        if line.count("`") % 2:
+            in_template = not in_template
+    return "\n".join(out) + "\n"
+
+
+def minify_html(text):
+    text = re.sub(r"<!--.*?-->", "", text, flags=re.S)
+    text = re.sub(r">\s+<", "><", text)
+    return re.sub(r"\n\s*", "\n", text).strip()
+
+
+MINIFIERS = {".css": minify_css, ".js": minify_js, ".html": minify_html}
+
+
+def write_gz(path, data):
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    # mtime=0 keeps the image byte-identical between builds
+    with open(path + ".gz", "wb") as raw:
+        with gzip.GzipFile(fileobj=raw, mode="wb", compresslevel=9, mtime=0) as gz:
+            gz.write(data)
+
+
+# ----------------------------------------------------------------
+def build_web():
+    shutil.rmtree(OUT_DIR, ignore_errors=True)
+    web_src = os.path.join(SRC_DIR, WEB_SUBDIR)
+    web_out = os.path.join(OUT_DIR, WEB_SUBDIR)
+
+    # Anything outside www/ is copied verbatim
+    for name in os.listdir(SRC_DIR):
+        if name == WEB_SUBDIR:
+            continue
+        src = os.path.join(SRC_DIR, name)
+        dst = os.path.join(OUT_DIR, name)
+        if os.path.isdir(src):
+            shutil.copytree(src, dst)
+        else:
+            os.makedirs(OUT_DIR, exist_ok=True)
+            shutil.copy2(src, dst)
+
+    renames = {}
+    pages = {}
+    for name in sorted(os.listdir(web_src)):
+        src = os.path.join(web_src, name)
+        if os.path.isdir(src):
+            continue
+        stem, ext = os.path.splitext(name)
+        with open(src, "rb") as f:
+            data = f.read()
+        if ext in MINIFIERS:
+            data = MINIFIERS[ext](data.decode("utf-8")).encode("utf-8")
+
+        if ext == ".html":
+            pages[name] = data.decode("utf-8")
+        elif ext in FINGERPRINTED:
+            digest = hashlib.sha256(data).hexdigest()[:8]
+            hashed = "assets/%s.%s%s" % (stem, digest, ext)
+            renames[name] = hashed
+            write_gz(os.path.join(web_out, hashed), data)
+        else:
+            write_gz(os.path.join(web_out, name), data)
+
+    for name, html in pages.items():
+        for plain, hashed in renames.items():
+            html = re.sub(r'(src|href)="%s"' % re.escape(plain),
+                          r'\1="%s"' % hashed, html)
+        write_gz(os.path.join(web_out, name), html.encode("utf-8"))
+
+    for plain, hashed in sorted(renames.items()):
+        print("[web] %s -> %s.gz" % (plain, hashed))
+
+
+# Point the filesystem image at the generated tree
+env.Replace(PROJECT_DATA_DIR=OUT_DIR)  # noqa: F821
+
+if FS_TARGETS & set(COMMAND_LINE_TARGETS):  # noqa: F821
+    build_web()
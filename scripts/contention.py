@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+# ============================================================
+#  Contention sweep — keystroke jitter per task placement
+# ============================================================
+#
+#  python3 scripts/contention.py --host 192.168.4.1
+#  python3 scripts/contention.py --placement "parser=1/1 live=1/2" ...
+#
+#  For each placement ("role=core/prio" ..., roles as in GET
+#  /api/tasks; core -1 = either) the device is reconfigured with
+#  POST /api/tasks, a contention test is started with POST
+#  /api/contention, and --clients threads hammer /api/status and
+#  /api/metrics until it finishes. Prints one row per placement and
+#  restores the original placement at the end.
+#
+# ============================================================
+
+import argparse
+import json
+import sys
+import threading
+import time
+import urllib.error
+import urllib.request
+
+DEFAULT_PLACEMENTS = (
+    "parser=0/1 live=0/2",  # firmware defaults: beside Wi-Fi/lwIP
+    "parser=1/1 live=1/2",  # beside loop()
+    "parser=1/5 live=1/6",  # above AsyncTCP
+    "parser=-1/1 live=-1/2",
+)
+LOAD_PATHS = ("/api/status", "/api/metrics")
+
+
+# ----------------------------------------------------------------
+def request(base, path, body=None, timeout=5):
+    data = None if body is None else json.dumps(body).encode()
+    req = urllib.request.Request(base + path, data=data,
+                                 headers={"Content-Type": "application/json"})
+    with urllib.request.urlopen(req, timeout=timeout) as r:
+        return json.loads(r.read() or b"{}")
+
+
+def parse_placement(text):
+    out = {}
+    for item in text.split():
+        role, _, spec = item.partition("=")
+        core, _, prio = spec.partition("/")
+        entry = {"core": int(core)}
+        if prio:
+            entry["prio"] = int(prio)
+        out[role] = entry
+    return out
+
+
+def hammer(base, stop, counts):
+    i = 0
+    while not stop.is_set():
+        try:
+            urllib.request.urlopen(base + LOAD_PATHS[i % len(LOAD_PATHS)],
+                                   timeout=5).read()
+            counts["ok"] += 1
+        except (urllib.error.URLError, OSError):
+            counts["failed"] += 1
+        i += 1
+
+
+# ----------------------------------------------------------------
+def run_one(base, args):
+    request(base, "/api/contention",
+            {"reports": args.reports, "intervalMs": args.interval})
+    stop = threading.Event()
+    counts = {"ok": 0, "failed": 0}
+    threads = [threading.Thread(target=hammer, args=(base, stop, counts))
+               for _ in range(args.clients)]
+    for t in threads:
+        t.start()
+    try:
+        deadline = time.time() + args.reports * args.interval / 1000 * 3 + 10
+        while True:
+            time.sleep(0.5)
+            res = request(base, "/api/contention")
+            if not res["running"]:
+                return res, counts
+            if time.time() > deadline:
+                raise RuntimeError("contention test did not finish")
+    finally:
+        stop.set()
+        for t in threads:
+            t.join()
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__)
+    ap.add_argument("--host", default="192.168.4.1")
+    ap.add_argument("--placement", action="append",
+                    help='"role=core/prio ..." (repeatable)')
+    ap.add_argument("--reports", type=int, default=2000)
+    ap.add_argument("--interval", type=int, default=5, help="ms per report")
+    ap.add_argument("--clients", type=int, default=4,
+                    help="concurrent HTTP load threads")
+    args = ap.parse_args()
+    base = "http://" + args.host
+
+    original = request(base, "/api/tasks")
+    saved = {role: {"core": v["core"], "prio": v["prio"]}
+             for role, v in original.items() if isinstance(v, dict)}
+    saved.pop("web", None)  # its core is fixed; leave it alone
+
+    print("%-26s %7s %7s %7s %7s %7s %6s" %
+          ("placement", "avg us", "p50", "p99", "max", "http", "lost"))
+    try:
+        for text in args.placement or DEFAULT_PLACEMENTS:
+            try:
+                request(base, "/api/tasks", parse_placement(text))
+            except urllib.error.HTTPError as e:
+                print("%-26s refused: %s" % (text, e.read().decode()))
+                continue
+            res, counts = run_one(base, args)
+            j = res["jitterUs"]
+            note = " (interrupted)" if res.get("interrupted") else ""
+            print("%-26s %7d %7d %7d %7d %7d %6d%s" %
+                  (text, j["avg"], j["p50"], j["p99"], j["max"],
+                   res["httpRequests"], counts["failed"], note))
+    finally:
+        request(base, "/api/tasks", saved)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
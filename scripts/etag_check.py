@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+# ============================================================
+#  ETag check — conditional GET / PATCH against a device
+# ============================================================
+#
+#  python3 scripts/etag_check.py --host 192.168.4.1
+#  python3 scripts/etag_check.py --host 127.0.0.1:8081   # ducky_mockdev
+#
+#  Saves a scratch payload and checks the conditional requests end
+#  to end, headers included:
+#    GET   If-None-Match: <current>   -> 304
+#    GET   If-None-Match: <other>     -> 200 with the content
+#    PATCH If-Match: <stale>          -> 412, content unchanged
+#    PATCH edits with one out of range -> 422, content unchanged
+#    PATCH If-Match: <current>        -> 200, all edits applied
+#  The payload is deleted at the end. Exit status 1 on any failure.
+#
+# ============================================================
+
+import argparse
+import json
+import sys
+import urllib.error
+import urllib.parse
+import urllib.request
+
+NAME = "etag-check"
+CONTENT = "STRING one\nSTRING two\n"
+
+
+# ----------------------------------------------------------------
+def call(base, method, path, body=None, headers=None):
+    data = None if body is None else json.dumps(body).encode()
+    req = urllib.request.Request(base + path, data=data, method=method,
+                                 headers=dict(headers or {}))
+    if data is not None:
+        req.add_header("Content-Type", "application/json")
+    try:
+        with urllib.request.urlopen(req, timeout=5) as r:
+            return r.status, r.headers, r.read()
+    except urllib.error.HTTPError as e:
+        return e.code, e.headers, e.read()
+
+
+class Checker:
+    def __init__(self, base):
+        self.base = base
+        self.path = "/api/payloads/" + urllib.parse.quote(NAME)
+        self.failed = 0
+
+    def expect(self, what, got, want):
+        ok = got == want
+        shown = repr(got) if ok else "%r, want %r" % (got, want)
+        print("%-4s %-32s %s" % ("ok" if ok else "FAIL", what, shown))
+        if not ok:
+            self.failed += 1
+
+    def get(self, headers=None):
+        return call(self.base, "GET", self.path, headers=headers)
+
+    def content(self):
+        status, _, body = self.get()
+        return json.loads(body).get("content") if status == 200 else None
+
+    def patch(self, edits, etag=None):
+        headers = {"If-Match": etag} if etag else {}
+        status, _, _ = call(self.base, "PATCH", self.path, {"edits": edits},
+                            headers)
+        return status
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__)
+    ap.add_argument("--host", default="192.168.4.1")
+    args = ap.parse_args()
+    c = Checker("http://" + args.host)
+
+    status, _, body = call(c.base, "POST", "/api/payloads",
+                           {"name": NAME, "content": CONTENT,
+                            "compress": False})
+    if status != 200:
+        print("cannot save %s: %d %s" % (NAME, status, body.decode()))
+        return 1
+    etag = json.loads(body)["etag"]
+    stale = '"00000000"' if etag != '"00000000"' else '"00000001"'
+
+    try:
+        status, headers, _ = c.get({"If-None-Match": etag})
+        c.expect("GET If-None-Match current", status, 304)
+        c.expect("  304 carries the ETag", headers.get("ETag"), etag)
+        status, _, _ = c.get({"If-None-Match": stale})
+        c.expect("GET If-None-Match other", status, 200)
+
+        c.expect("PATCH If-Match stale",
+                 c.patch([{"offset": 0, "remove": 6, "text": "STRINGLN"}],
+                         stale), 412)
+        c.expect("  content unchanged", c.content(), CONTENT)
+
+        c.expect("PATCH one edit out of range",
+                 c.patch([{"offset": 0, "remove": 6, "text": "STRINGLN"},
+                          {"offset": 1000, "remove": 0, "text": "x"}],
+                         etag), 422)
+        c.expect("  content unchanged", c.content(), CONTENT)
+
+        c.expect("PATCH If-Match current",
+                 c.patch([{"offset": 0, "remove": 6, "text": "STRINGLN"},
+                          {"offset": 13, "remove": 6, "text": "STRINGLN"}],
+                         etag), 200)
+        c.expect("  all edits applied", c.content(),
+                 "STRINGLN one\nSTRINGLN two\n")
+    finally:
+        call(c.base, "DELETE", c.path)
+
+    print("%d failed" % c.failed)
+    return 1 if c.failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
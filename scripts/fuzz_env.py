@@ -0,0 +1,16 @@
+# ============================================================
+#  libFuzzer toolchain — PlatformIO extra_script (pre:)
+# ============================================================
+#
+#  env:native_fuzz needs clang: libFuzzer ships with it, and the
+#  sanitizer flags must reach both the compiler and the linker
+#  (build_flags only reach the compiler).
+#
+# ============================================================
+
+Import("env")  # noqa: F821  (provided by PlatformIO/SCons)
+
+SANITIZE = ["-fsanitize=fuzzer,address,undefined"]
+
+env.Replace(CC="clang", CXX="clang++", LINK="clang++")  # noqa: F821
+env.Append(CCFLAGS=SANITIZE, LINKFLAGS=SANITIZE)  # noqa: F821
@@ -0,0 +1,272 @@
+#!/usr/bin/env python3
+# ============================================================
+#  HID trace tool — decode, semantic diff, golden-trace check
+# ============================================================
+#
+#  Traces are written by hid_trace.cpp (device: GET /api/trace,
+#  host: ducky_run --trace FILE).
+#
+#    hid_trace.py decode TRACE
+#    hid_trace.py diff GOLDEN CURRENT [--tol-ms 2] [--tol-pct 2]
+#    hid_trace.py check DIR --runner PROGRAM [--update]
+#
+#  diff compares what the host would see, not raw bytes: the text
+#  typed, the key combos, mouse actions, and when each happened.
+#  Two traces that type the same text with the same combos and
+#  timing within tolerance are equal even if, say, modifier reports
+#  are ordered differently. `check` runs every DIR/*.ducky through
+#  the host runner and diffs against the DIR/*.dht next to it.
+#
+# ============================================================
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+MAGIC = b"DHT1"
+KIND_KEYBOARD = 1
+KIND_MOUSE = 2
+KIND_MOUSE_ABS = 3
+KIND_NKRO = 4
+DATA_LEN = {KIND_KEYBOARD: 8, KIND_MOUSE: 4, KIND_MOUSE_ABS: 5,
+            KIND_NKRO: 17}
+
+MODS = ["CTRL", "SHIFT", "ALT", "GUI", "RCTRL", "RSHIFT", "RALT", "RGUI"]
+SHIFT_BITS = 0x22
+
+# US layout: usage -> (plain, shifted)
+US_KEYS = {0x2C: (" ", " "), 0x2D: ("-", "_"), 0x2E: ("=", "+"),
+           0x2F: ("[", "{"), 0x30: ("]", "}"), 0x31: ("\\", "|"),
+           0x33: (";", ":"), 0x34: ("'", '"'), 0x35: ("`", "~"),
+           0x36: (",", "<"), 0x37: (".", ">"), 0x38: ("/", "?"),
+           0x28: ("\n", None), 0x2B: ("\t", None)}
+for _i in range(26):
+    US_KEYS[0x04 + _i] = (chr(ord("a") + _i), chr(ord("A") + _i))
+for _i, (_p, _s) in enumerate(zip("1234567890", "!@#$%^&*()")):
+    US_KEYS[0x1E + _i] = (_p, _s)
+
+KEY_NAMES = {0x28: "ENTER", 0x29: "ESCAPE", 0x2A: "BACKSPACE", 0x2B: "TAB",
+             0x2C: "SPACE", 0x39: "CAPSLOCK", 0x46: "PRINTSCREEN",
+             0x47: "SCROLLLOCK", 0x48: "PAUSE", 0x49: "INSERT", 0x4A: "HOME",
+             0x4B: "PAGEUP", 0x4C: "DELETE", 0x4D: "END", 0x4E: "PAGEDOWN",
+             0x4F: "RIGHT", 0x50: "LEFT", 0x51: "DOWN", 0x52: "UP",
+             0x53: "NUMLOCK", 0x65: "MENU"}
+for _i in range(12):
+    KEY_NAMES[0x3A + _i] = f"F{_i + 1}"
+BUTTONS = {1: "LEFT", 2: "RIGHT", 4: "MIDDLE"}
+
+
+# ----------------------------------------------------------------
+def read_trace(path):
+    """Return [(t_us, kind, bytes)] with absolute timestamps."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != MAGIC:
+        raise SystemExit(f"{path}: not a DHT1 trace")
+    out, pos, t = [], 4, 0
+    while pos < len(data):
+        kind = data[pos]
+        pos += 1
+        dt, shift = 0, 0
+        while True:
+            b = data[pos]
+            pos += 1
+            dt |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                break
+        t += dt
+        n = DATA_LEN.get(kind)
+        if n is None or pos + n > len(data):
+            raise SystemExit(f"{path}: corrupt record at byte {pos}")
+        out.append((t, kind, data[pos:pos + n]))
+        pos += n
+    return out
+
+
+def key_name(usage):
+    if usage in KEY_NAMES:
+        return KEY_NAMES[usage]
+    if usage in US_KEYS:
+        return US_KEYS[usage][0]
+    return f"0x{usage:02x}"
+
+
+def mod_names(mods):
+    return [MODS[i] for i in range(8) if mods & (1 << i)]
+
+
+def signed(b):
+    return b - 256 if b > 127 else b
+
+
+# ----------------------------------------------------------------
+def events(records):
+    """Reduce reports to host-visible events: (t_us, kind, value, t_end)."""
+    out = []
+    prev_keys, prev_buttons = set(), 0
+    held_mods, key_seen = 0, False
+
+    def emit(t, kind, value):
+        # Merge consecutive typed characters into one text event
+        if kind == "text" and out and out[-1][1] == "text":
+            t0, _, v, _ = out[-1]
+            out[-1] = (t0, "text", v + value, t)
+        else:
+            out.append((t, kind, value, t))
+
+    for t, kind, d in records:
+        if kind == KIND_MOUSE_ABS:
+            emit(t, "moveto", f"{d[1] | d[2] << 8} {d[3] | d[4] << 8}")
+            continue
+        if kind == KIND_MOUSE:
+            buttons, x, y, wheel = d[0], signed(d[1]), signed(d[2]), \
+                signed(d[3])
+            for bit, name in BUTTONS.items():
+                if buttons & bit and not prev_buttons & bit:
+                    emit(t, "click", name)
+            prev_buttons = buttons
+            if x or y:
+                emit(t, "move", f"{x} {y}")
+            if wheel:
+                emit(t, "scroll", str(wheel))
+            continue
+
+        if kind == KIND_NKRO:
+            mods = d[0]
+            keys = {k for k in range(128) if d[1 + k // 8] >> (k % 8) & 1}
+        else:
+            mods, keys = d[0], {k for k in d[2:8] if k}
+        held_mods |= mods
+        for k in sorted(keys - prev_keys):
+            key_seen = True
+            plain = US_KEYS.get(k)
+            if plain and not mods & ~SHIFT_BITS and \
+                    (plain[1] is not None or not mods):
+                emit(t, "text", plain[1] if mods else plain[0])
+            else:
+                emit(t, "combo", "+".join(mod_names(mods) + [key_name(k)]))
+        if not mods and not keys:
+            # Modifiers pressed and released with no key (GUI, ALT+SHIFT)
+            if held_mods and not key_seen:
+                emit(t, "combo", "+".join(mod_names(held_mods)))
+            held_mods, key_seen = 0, False
+        prev_keys = keys
+    return out
+
+
+def describe(ev):
+    t, kind, value, _ = ev
+    return f"{t / 1000:10.3f} ms  {kind:6s} {value!r}"
+
+
+# ----------------------------------------------------------------
+def diff(golden, current, tol_ms, tol_pct, quiet=False):
+    """Print differences; return True when the traces match."""
+    g, c = events(read_trace(golden)), events(read_trace(current))
+    ok, worst = True, 0.0
+    for i in range(max(len(g), len(c))):
+        if i >= len(g) or i >= len(c):
+            extra = c[i] if i >= len(g) else g[i]
+            side = "current" if i >= len(g) else "golden"
+            print(f"  event {i}: only in {side}: {describe(extra)}")
+            ok = False
+            break
+        (tg, kg, vg, eg), (tc, kc, vc, ec) = g[i], c[i]
+        if (kg, vg) != (kc, vc):
+            print(f"  event {i} differs:\n    golden  {describe(g[i])}\n"
+                  f"    current {describe(c[i])}")
+            ok = False
+            break
+        # Start and end: a text run that types slower drifts at the end
+        for label, a, b in (("start", tg, tc), ("end", eg, ec)):
+            drift = abs(b - a) / 1000.0
+            worst = max(worst, drift)
+            if drift > max(tol_ms, a / 1000.0 * tol_pct / 100.0):
+                print(f"  event {i} {label} timing: {a / 1000:.3f} ms -> "
+                      f"{b / 1000:.3f} ms ({kg} {vg!r})")
+                ok = False
+        if not ok:
+            break
+    if not quiet:
+        text = sum(len(v) for _, k, v, _ in g if k == "text")
+        combos = sum(1 for _, k, _, _ in g if k == "combo")
+        print(f"  {len(g)} events ({text} chars typed, {combos} combos), "
+              f"max drift {worst:.3f} ms")
+    return ok
+
+
+# ----------------------------------------------------------------
+def cmd_decode(args):
+    for t, kind, d in read_trace(args.trace):
+        name = {KIND_KEYBOARD: "kbd", KIND_MOUSE: "mse",
+                KIND_MOUSE_ABS: "abs"}.get(kind, "nkro")
+        print(f"{t / 1000:10.3f} ms  {name}  {d.hex(' ')}")
+    print("# events")
+    for ev in events(read_trace(args.trace)):
+        print(describe(ev))
+
+
+def cmd_diff(args):
+    ok = diff(args.golden, args.current, args.tol_ms, args.tol_pct)
+    print("match" if ok else "MISMATCH")
+    sys.exit(0 if ok else 1)
+
+
+def cmd_check(args):
+    scripts = sorted(f for f in os.listdir(args.dir) if f.endswith(".ducky"))
+    failed = 0
+    with tempfile.TemporaryDirectory() as tmp:
+        for name in scripts:
+            script = os.path.join(args.dir, name)
+            golden = script[:-len(".ducky")] + ".dht"
+            out = golden if args.update else os.path.join(tmp, "t.dht")
+            subprocess.run([args.runner, "--quiet", "--trace", out, script],
+                           check=True, stdout=subprocess.DEVNULL)
+            if args.update:
+                print(f"{name}: golden written")
+                continue
+            print(f"{name}:")
+            if not os.path.exists(golden):
+                print("  no golden trace (run with --update)")
+                failed += 1
+            elif not diff(golden, out, args.tol_ms, args.tol_pct):
+                failed += 1
+    if not args.update:
+        print(f"{len(scripts) - failed}/{len(scripts)} traces match")
+    sys.exit(1 if failed else 0)
+
+
+def main():
+    ap = argparse.ArgumentParser(description="HID trace tool")
+    sub = ap.add_subparsers(dest="cmd", required=True)
+
+    p = sub.add_parser("decode", help="print reports and events")
+    p.add_argument("trace")
+    p.set_defaults(fn=cmd_decode)
+
+    for name, fn in (("diff", cmd_diff), ("check", cmd_check)):
+        p = sub.add_parser(name)
+        if name == "diff":
+            p.add_argument("golden")
+            p.add_argument("current")
+        else:
+            p.add_argument("dir")
+            p.add_argument("--runner", required=True,
+                           help="host runner, e.g. .pio/build/native/program")
+            p.add_argument("--update", action="store_true",
+                           help="rewrite the golden traces")
+        p.add_argument("--tol-ms", type=float, default=2.0,
+                       help="absolute timing tolerance (default 2 ms)")
+        p.add_argument("--tol-pct", type=float, default=2.0,
+                       help="relative timing tolerance (default 2%%)")
+        p.set_defaults(fn=fn)
+
+    args = ap.parse_args()
+    args.fn(args)
+
+
+if __name__ == "__main__":
+    main()
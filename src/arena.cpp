@@ -0,0 +1,167 @@
+// ============================================================
+//  Arena — Per-Job Scratch Memory, Reset in O(1)
+// ============================================================
+
+#include "arena.h"
+#include "config.h"
+
+#include <atomic>
+
+#define ARENA_ALIGN 8
+#define ARENA_HEADER 8 // u32 block size, padded to ARENA_ALIGN
+
+struct Arena {
+  uint8_t *base;     // ARENA_ALIGN-aligned start
+  size_t capacity;
+  size_t used;       // bump offset
+  size_t high;       // most used during the current job
+  uint8_t *last;     // newest block, nullptr after a rewind
+  std::atomic<uint32_t> peak;
+  std::atomic<uint32_t> lastUsed;
+  std::atomic<uint32_t> jobs;
+  std::atomic<uint32_t> overflows;
+};
+
+static const size_t kArenaBytes[ARENA_COUNT] = {ARENA_JOB_BYTES,
+                                                ARENA_HTTP_BYTES};
+static const char *const kArenaNames[ARENA_COUNT] = {"job", "http"};
+
+static Arena sArenas[ARENA_COUNT];
+static bool sInit = false;
+
+// The calling task's arena (arenaBegin), nullptr outside one
+static thread_local Arena *tCurrent = nullptr;
+
+static size_t alignUp(size_t n) {
+  return (n + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+static Arena *ownerOf(const void *p) {
+  for (Arena &a : sArenas) {
+    if (a.base && (const uint8_t *)p >= a.base &&
+        (const uint8_t *)p < a.base + a.capacity)
+      return &a;
+  }
+  return nullptr;
+}
+
+static uint32_t &blockSize(uint8_t *p) {
+  return *(uint32_t *)(p - ARENA_HEADER);
+}
+
+static void *bump(Arena &a, size_t size) {
+  size_t need = ARENA_HEADER + alignUp(size);
+  if (need > a.capacity - a.used)
+    return nullptr;
+  uint8_t *p = a.base + a.used + ARENA_HEADER;
+  blockSize(p) = size;
+  a.used += need;
+  a.last = p;
+  if (a.used > a.high)
+    a.high = a.used;
+  return p;
+}
+
+// ================================================================
+//  Public API
+// ================================================================
+
+void arenaInit() {
+  if (sInit)
+    return;
+  sInit = true;
+  for (int i = 0; i < ARENA_COUNT; i++) {
+    size_t bytes = kArenaBytes[i] + ARENA_ALIGN;
+    uint8_t *raw =
+        (uint8_t *)(psramFound() ? ps_malloc(bytes) : malloc(bytes));
+    if (!raw)
+      continue;
+    sArenas[i].base = (uint8_t *)alignUp((size_t)raw);
+    sArenas[i].capacity = kArenaBytes[i];
+  }
+}
+
+void arenaBegin(ArenaId id) {
+  Arena &a = sArenas[id];
+  a.used = 0;
+  a.high = 0;
+  a.last = nullptr;
+  tCurrent = &a;
+}
+
+void arenaEnd() {
+  Arena *a = tCurrent;
+  if (!a)
+    return;
+  tCurrent = nullptr;
+  a->lastUsed.store(a->high, std::memory_order_relaxed);
+  if (a->high > a->peak.load(std::memory_order_relaxed))
+    a->peak.store(a->high, std::memory_order_relaxed);
+  a->jobs.fetch_add(1, std::memory_order_relaxed);
+  a->used = 0;
+  a->last = nullptr;
+}
+
+void *arenaAlloc(size_t size) {
+  Arena *a = tCurrent;
+  if (a && a->base) {
+    if (void *p = bump(*a, size))
+      return p;
+    a->overflows.fetch_add(1, std::memory_order_relaxed);
+  }
+  return malloc(size);
+}
+
+void *arenaRealloc(void *ptr, size_t size) {
+  if (!ptr)
+    return arenaAlloc(size);
+  Arena *a = ownerOf(ptr);
+  if (!a)
+    return realloc(ptr, size);
+
+  uint8_t *p = (uint8_t *)ptr;
+  size_t old = blockSize(p);
+  size_t offset = p - a->base;
+  if (p == a->last && alignUp(size) <= a->capacity - offset) {
+    // Newest block: grow or shrink where it is
+    blockSize(p) = size;
+    a->used = offset + alignUp(size);
+    if (a->used > a->high)
+      a->high = a->used;
+    return p;
+  }
+  void *q = arenaAlloc(size);
+  if (q)
+    memcpy(q, p, old < size ? old : size);
+  arenaFree(p);
+  return q;
+}
+
+void arenaFree(void *ptr) {
+  if (!ptr)
+    return;
+  Arena *a = ownerOf(ptr);
+  if (!a) {
+    free(ptr);
+    return;
+  }
+  // Only the newest block can be given back before the rewind
+  uint8_t *p = (uint8_t *)ptr;
+  if (p == a->last) {
+    a->used = p - ARENA_HEADER - a->base;
+    a->last = nullptr;
+  }
+}
+
+ArenaStats arenaGetStats(ArenaId id) {
+  const Arena &a = sArenas[id];
+  ArenaStats s;
+  s.capacity = a.capacity;
+  s.peak = a.peak.load(std::memory_order_relaxed);
+  s.lastUsed = a.lastUsed.load(std::memory_order_relaxed);
+  s.jobs = a.jobs.load(std::memory_order_relaxed);
+  s.overflows = a.overflows.load(std::memory_order_relaxed);
+  return s;
+}
+
+const char *arenaName(ArenaId id) { return kArenaNames[id]; }
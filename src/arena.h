@@ -0,0 +1,96 @@
+#pragma once
+
+// ============================================================
+//  Arena — Per-Job Scratch Memory, Reset in O(1)
+// ============================================================
+//
+//  Long uptimes run thousands of scripts and HTTP requests, each
+//  leaving transient allocations of every size on the heap, and
+//  the largest free block shrinks as they interleave with the
+//  long-lived ones. Instead, each job takes its scratch memory
+//  from a block allocated once at boot:
+//
+//    ARENA_JOB   the parser task, from compile to the end of a run
+//    ARENA_HTTP  one web request handler call (web_server.cpp)
+//
+//  Allocation bumps a pointer; freeing does nothing (except that
+//  the newest block can be given back or grown in place); the
+//  arena is rewound in one step when the job ends. Whatever does
+//  not fit goes to the heap as before and is counted.
+//
+//  A task enters an arena with arenaBegin() / ArenaScope; while it
+//  is inside, arenaAlloc() and ArenaAllocator<T> (the compiler's
+//  instruction list, JsonDocument via an ArduinoJson allocator)
+//  use it. Other tasks, and code outside any scope, use the heap.
+//  Nothing allocated inside may outlive the scope.
+//
+// ============================================================
+
+#include <Arduino.h>
+
+enum ArenaId : uint8_t { ARENA_JOB = 0, ARENA_HTTP, ARENA_COUNT };
+
+/// Allocate the arenas (PSRAM when present; idempotent). Without
+/// it every allocation goes to the heap.
+void arenaInit();
+
+/// Make `id` the calling task's arena, rewound to empty.
+void arenaBegin(ArenaId id);
+
+/// Leave the current arena and rewind it (O(1)).
+void arenaEnd();
+
+/// Enters an arena for the lifetime of the object.
+class ArenaScope {
+public:
+  explicit ArenaScope(ArenaId id) { arenaBegin(id); }
+  ~ArenaScope() { arenaEnd(); }
+  ArenaScope(const ArenaScope &) = delete;
+  ArenaScope &operator=(const ArenaScope &) = delete;
+};
+
+/// malloc() from the current arena, or the heap outside one or
+/// when it is full.
+void *arenaAlloc(size_t size);
+
+/// realloc() counterpart: grows the newest arena block in place.
+void *arenaRealloc(void *ptr, size_t size);
+
+/// free() counterpart; arena blocks are reclaimed by arenaEnd().
+void arenaFree(void *ptr);
+
+/// std allocator over arenaAlloc(), for containers that live
+/// within one job.
+template <class T> struct ArenaAllocator {
+  typedef T value_type;
+  ArenaAllocator() = default;
+  template <class U> ArenaAllocator(const ArenaAllocator<U> &) {}
+  T *allocate(size_t n) {
+    T *p = (T *)arenaAlloc(n * sizeof(T));
+    if (!p)
+      abort();
+    return p;
+  }
+  void deallocate(T *p, size_t) { arenaFree(p); }
+  template <class U> bool operator==(const ArenaAllocator<U> &) const {
+    return true;
+  }
+  template <class U> bool operator!=(const ArenaAllocator<U> &) const {
+    return false;
+  }
+};
+
+/// One arena's use since boot.
+struct ArenaStats {
+  uint32_t capacity;  // bytes (0 = not allocated)
+  uint32_t peak;      // most bytes in use by one job
+  uint32_t lastUsed;  // bytes the last finished job used
+  uint32_t jobs;      // scopes ended (one rewind each)
+  uint32_t overflows; // allocations that went to the heap: full
+};
+
+/// Snapshot of arena `id`'s counters.
+ArenaStats arenaGetStats(ArenaId id);
+
+/// Name of arena `id` ("job", "http").
+const char *arenaName(ArenaId id);
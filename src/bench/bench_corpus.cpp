@@ -0,0 +1,160 @@
+// ============================================================
+//  Benchmark Corpus — Realistic & Synthetic DuckyScripts
+// ============================================================
+//
+//  Everything here is harmless when the device bench types it
+//  into a scratch editor: no GUI/run dialogs, no function keys,
+//  no CTRL ALT DELETE.
+//
+// ============================================================
+
+#include "bench_corpus.h"
+
+// --- Realistic scripts (the shape of typical payloads) ---
+
+static const char *const NOTE_TAKING = R"(REM Draft a note
+DELAY 500
+STRINGLN Meeting notes - weekly sync
+STRINGLN ============================
+ENTER
+STRING Attendees: Alice, Bob, Carol
+ENTER
+STRINGLN Action items:
+STRINGLN  - Review the release checklist (owner: Bob)
+STRINGLN  - Update the wiki page for the new pinout
+DELAY 200
+CTRL HOME
+SHIFT END
+CTRL c
+CTRL END
+ENTER
+CTRL v
+)";
+
+static const char *const FORM_FILL = R"(REM Fill a form, tabbing between fields
+DEFAULT_DELAY 20
+STRING Jane
+TAB
+STRING Doe
+TAB
+STRING jane.doe@example.com
+TAB
+STRING +1 (555) 010-9999
+TAB
+STRING 42 Example Street, Apt. #7
+SHIFT TAB
+SHIFT TAB
+END
+STRING  - updated
+DOWN
+DOWN
+ENTER
+)";
+
+static const char *const CONFIG_DUMP = R"(REM Type a config file
+STRINGLN [server]
+STRINGLN host = 0.0.0.0
+STRINGLN port = 8080
+STRINGLN workers = 4
+ENTER
+STRINGLN [logging]
+STRINGLN level = "info"
+STRINGLN format = "%(asctime)s %(levelname)s %(message)s"
+ENTER
+STRINGLN [paths]
+STRINGLN data = ~/data/{project}/raw
+STRINGLN cache = /tmp/cache_$USER
+REPEAT 3
+BACKSPACE
+)";
+
+// ----------------------------------------------------------------
+static String hugeString(int lines) {
+  // 96 printable chars per line: letters, shifted digits, punctuation
+  static const char *const row =
+      "The quick brown fox JUMPS over 13 lazy dogs! {x: [1, 2]} "
+      "a+b=c; \"quoted\" 'single' <tag> ~`|\\?_";
+  String s;
+  s.reserve(lines * 110);
+  for (int i = 0; i < lines; i++) {
+    s += "STRINGLN ";
+    s += row;
+    s += "\n";
+  }
+  return s;
+}
+
+static String deepRepeat(int count) {
+  String s = "STRING x\nREPEAT ";
+  s += count;
+  s += "\nSHIFT LEFT\nREPEAT ";
+  s += count;
+  s += "\nBACKSPACE\n";
+  return s;
+}
+
+static String comboHeavy(int lines) {
+  static const char *const combos[] = {
+      "CTRL a",          "CTRL z",     "SHIFT LEFT",    "CTRL SHIFT RIGHT",
+      "CTRL HOME",       "CTRL END",   "SHIFT END",     "SHIFT HOME",
+      "CTRL SHIFT LEFT", "SHIFT TAB",  "CTRL BACKSPACE", "ALT SHIFT z"};
+  const int n = sizeof(combos) / sizeof(combos[0]);
+  String s;
+  for (int i = 0; i < lines; i++) {
+    s += combos[i % n];
+    s += "\n";
+  }
+  return s;
+}
+
+static String mouseHeavy(int lines) {
+  String s;
+  for (int i = 0; i < lines; i++) {
+    switch (i % 4) {
+    case 0:
+      s += "MOUSE_MOVE 10 -5\n";
+      break;
+    case 1:
+      s += "MOUSE_MOVE -10 5\n";
+      break;
+    case 2:
+      s += "MOUSE_SCROLL -1\n";
+      break;
+    default:
+      s += "MOUSE_CLICK LEFT\n";
+      break;
+    }
+  }
+  return s;
+}
+
+static String keyDispatch(int lines) {
+  // Names near the end of the parser's match chain, plus comments
+  // and blanks that are parsed but never dispatched
+  static const char *const keys[] = {"RIGHT", "LEFT",   "DOWN", "UP",
+                                     "END",   "HOME",   "REM skip me",
+                                     "",      "PAGEUP", "PAGEDOWN"};
+  const int n = sizeof(keys) / sizeof(keys[0]);
+  String s;
+  for (int i = 0; i < lines; i++) {
+    s += keys[i % n];
+    s += "\n";
+  }
+  return s;
+}
+
+// ----------------------------------------------------------------
+std::vector<BenchCase> benchCorpus(int scale) {
+  if (scale < 1)
+    scale = 1;
+  return {
+      {"note_taking", NOTE_TAKING},
+      {"form_fill", FORM_FILL},
+      {"config_dump", CONFIG_DUMP},
+      {"string_huge", hugeString(20 * scale)},
+      {"repeat_deep", deepRepeat(100 * scale)},
+      {"combo_heavy", comboHeavy(100 * scale)},
+      {"mouse_heavy", mouseHeavy(100 * scale)},
+      {"key_dispatch", keyDispatch(200 * scale)},
+  };
+}
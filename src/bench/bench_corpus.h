@@ -0,0 +1,17 @@
+#pragma once
+
+// ============================================================
+//  Benchmark Corpus — Realistic & Synthetic DuckyScripts
+// ============================================================
+
+#include <Arduino.h>
+#include <vector>
+
+struct BenchCase {
+  const char *name;
+  String script;
+};
+
+/// Build the corpus. `scale` multiplies the synthetic cases' size
+/// (1 = device-friendly, larger for host runs).
+std::vector<BenchCase> benchCorpus(int scale = 1);
@@ -0,0 +1,47 @@
+// ============================================================
+//  Device Benchmark — firmware entry for env:bench_esp32s3
+// ============================================================
+//
+//  Replaces main.cpp. Types the corpus for real, so focus an empty
+//  text editor on the host, then press BOOT to start. Results go
+//  to Serial as one JSON document between BENCH-BEGIN / BENCH-END
+//  (save it and compare with scripts/bench_compare.py).
+//
+// ============================================================
+
+#include "bench_runner.h"
+#include "config.h"
+#include "ducky_parser.h"
+#include "usb_hid.h"
+#include <Arduino.h>
+
+void setup() {
+  Serial.begin(115200);
+  pinMode(LED_PIN, OUTPUT);
+  pinMode(BOOT_BUTTON_PIN, INPUT_PULLUP);
+
+  initUSB();
+  duckyInit();
+
+  Serial.println("\n[Bench] Focus a scratch editor on the host, then press "
+                 "BOOT");
+  while (digitalRead(BOOT_BUTTON_PIN) == HIGH) {
+    digitalWrite(LED_PIN, (millis() / 250) % 2);
+    delay(10);
+  }
+  digitalWrite(LED_PIN, HIGH);
+  delay(1000); // let the button go
+
+  std::vector<BenchResult> results;
+  for (auto &c : benchCorpus(1)) {
+    Serial.printf("[Bench] %s...\n", c.name);
+    results.push_back(benchRun(c));
+  }
+
+  Serial.println("BENCH-BEGIN");
+  Serial.print(benchToJson(results, "esp32s3"));
+  Serial.println("BENCH-END");
+  digitalWrite(LED_PIN, LOW);
+}
+
+void loop() { delay(1000); }
@@ -0,0 +1,131 @@
+// ============================================================
+//  Benchmark Runner — Parse → Dispatch → HID Reports
+// ============================================================
+
+#include "bench_runner.h"
+#include "ducky_parser.h"
+#include "usb_hid.h"
+
+#ifdef NATIVE_BUILD
+#include <chrono>
+#include <thread>
+#endif
+
+static volatile bool sDone = false;
+static volatile uint32_t sLines = 0;
+static volatile uint64_t sEndWall = 0;
+static volatile uint32_t sMinFree = 0;
+#ifdef NATIVE_BUILD
+// Outlives the parser task of every case (it may exit after benchRun)
+static HostHeapScope sHeap;
+#endif
+
+// Wall-clock µs even when the host build runs on virtual time
+static uint64_t wallMicros() {
+#ifdef NATIVE_BUILD
+  using namespace std::chrono;
+  return duration_cast<microseconds>(steady_clock::now().time_since_epoch())
+      .count();
+#else
+  return micros();
+#endif
+}
+
+static void benchCallback(int line, int total, DuckyStatus st) {
+  sLines = line;
+#ifndef NATIVE_BUILD
+  uint32_t freeHeap = ESP.getFreeHeap();
+  if (freeHeap < sMinFree)
+    sMinFree = freeHeap;
+#endif
+  if (st != DuckyStatus::RUNNING) {
+    sEndWall = wallMicros();
+    sDone = true;
+  }
+}
+
+// ----------------------------------------------------------------
+BenchResult benchRun(const BenchCase &c) {
+  BenchResult r;
+  r.name = c.name;
+
+  sDone = false;
+  sLines = 0;
+  HidStats before = hidGetStats();
+#ifdef NATIVE_BUILD
+  // Count only this thread and the parser task it starts: callbacks
+  // and other tasks allocate on their own schedule
+  sHeap.live = 0;
+  sHeap.peak = 0;
+#else
+  uint32_t heapBase = ESP.getFreeHeap();
+  sMinFree = heapBase;
+#endif
+
+#ifdef NATIVE_BUILD
+  UBaseType_t tasks = uxTaskGetNumberOfTasks();
+#endif
+  uint64_t sim0 = micros();
+  uint64_t wall0 = wallMicros();
+#ifdef NATIVE_BUILD
+  hostHeapEnter(&sHeap);
+  bool started = duckyExecute(c.script, benchCallback);
+  hostHeapEnter(nullptr);
+#else
+  bool started = duckyExecute(c.script, benchCallback);
+#endif
+  if (!started)
+    return r;
+
+#ifdef NATIVE_BUILD
+  // Wait for the task thread itself to exit, so it has left sHeap
+  // before the next case resets it. Real sleep: delay() would
+  // advance the virtual clock.
+  while (!sDone || uxTaskGetNumberOfTasks() > tasks)
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+#else
+  while (!sDone)
+    delay(1);
+#endif
+
+  HidStats after = hidGetStats();
+  r.wallUs = sEndWall - wall0;
+  r.simUs = micros() - sim0;
+  r.lines = sLines;
+  r.reports = after.reports - before.reports;
+  r.chars = after.chars - before.chars;
+#ifdef NATIVE_BUILD
+  int64_t peak = sHeap.peak.load();
+  r.peakHeap = peak > 0 ? peak : 0;
+#else
+  r.peakHeap = heapBase - sMinFree;
+#endif
+  r.ok = duckyGetStatus() == DuckyStatus::FINISHED;
+  return r;
+}
+
+// ----------------------------------------------------------------
+String benchToJson(const std::vector<BenchResult> &results,
+                   const char *target) {
+  String json = "{\"target\":\"";
+  json += target;
+  json += "\",\"cases\":[";
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchResult &r = results[i];
+    if (i)
+      json += ",";
+    json += "\n {\"name\":\"" + r.name + "\"";
+    json += ",\"ok\":" + String(r.ok ? "true" : "false");
+    json += ",\"lines\":" + String(r.lines);
+    json += ",\"reports\":" + String(r.reports);
+    json += ",\"chars\":" + String(r.chars);
+    json += ",\"wallUs\":" + String((unsigned long)r.wallUs);
+    json += ",\"simUs\":" + String((unsigned long)r.simUs);
+    json += ",\"nsPerLine\":" + String(r.nsPerLine(), 1);
+    json += ",\"reportsPerSec\":" + String(r.reportsPerSec(), 0);
+    json += ",\"simCharsPerSec\":" + String(r.simCharsPerSec(), 1);
+    json += ",\"peakHeap\":" + String(r.peakHeap) + "}";
+  }
+  json += "\n]}\n";
+  return json;
+}
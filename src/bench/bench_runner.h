@@ -0,0 +1,41 @@
+#pragma once
+
+// ============================================================
+//  Benchmark Runner — Parse → Dispatch → HID Reports
+// ============================================================
+//
+//  Runs one corpus script through duckyExecute() exactly as a
+//  stored payload would run and measures:
+//    wallUs  — real time until FINISHED (host: pure CPU cost when
+//              the virtual clock is on)
+//    simUs   — script time on micros() (virtual on host, real on
+//              the device), i.e. how long typing takes the target
+//    peakHeap — heap high-water above the pre-run level (host: of
+//              the run's own threads only, see host_heap.h)
+//
+// ============================================================
+
+#include "bench_corpus.h"
+#include <Arduino.h>
+
+struct BenchResult {
+  String name;
+  uint32_t lines = 0;
+  uint32_t reports = 0;
+  uint32_t chars = 0;
+  uint64_t wallUs = 0;
+  uint64_t simUs = 0;
+  uint32_t peakHeap = 0;
+  bool ok = false;
+
+  double nsPerLine() const { return lines ? wallUs * 1000.0 / lines : 0; }
+  double reportsPerSec() const { return wallUs ? reports * 1e6 / wallUs : 0; }
+  double simCharsPerSec() const { return simUs ? chars * 1e6 / simUs : 0; }
+};
+
+/// Run one case to completion. duckyInit()/initUSB() must have run.
+BenchResult benchRun(const BenchCase &c);
+
+/// Render results as the baseline JSON document.
+String benchToJson(const std::vector<BenchResult> &results,
+                   const char *target);
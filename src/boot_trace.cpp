@@ -0,0 +1,53 @@
+// ============================================================
+//  Boot Trace — Timestamped Boot Timeline
+// ============================================================
+
+#include "boot_trace.h"
+#include "config.h"
+#include "logger.h"
+
+static portMUX_TYPE sMux = portMUX_INITIALIZER_UNLOCKED;
+static BootEvent sEvents[BOOT_TRACE_MAX];
+static uint32_t sTotal = 0; // events ever marked; ring head = sTotal % MAX
+
+// ----------------------------------------------------------------
+void bootTraceMark(const char *label) {
+  BootEvent ev = {(uint32_t)micros(), ESP.getFreeHeap(), label};
+  portENTER_CRITICAL(&sMux);
+  sEvents[sTotal % BOOT_TRACE_MAX] = ev;
+  sTotal++;
+  portEXIT_CRITICAL(&sMux);
+}
+
+size_t bootTraceCount() {
+  return sTotal < BOOT_TRACE_MAX ? sTotal : BOOT_TRACE_MAX;
+}
+
+uint32_t bootTraceDropped() {
+  return sTotal > BOOT_TRACE_MAX ? sTotal - BOOT_TRACE_MAX : 0;
+}
+
+bool bootTraceGet(size_t i, BootEvent &ev) {
+  portENTER_CRITICAL(&sMux);
+  size_t n = bootTraceCount();
+  bool ok = i < n;
+  if (ok)
+    ev = sEvents[(sTotal - n + i) % BOOT_TRACE_MAX];
+  portEXIT_CRITICAL(&sMux);
+  return ok;
+}
+
+// ----------------------------------------------------------------
+void bootTraceDump() {
+  logPrintf("[Boot] Timeline:");
+  BootEvent ev;
+  uint32_t prev = 0; // first delta is time since reset
+  for (size_t i = 0; bootTraceGet(i, ev); i++) {
+    logPrintf("  %9.3f ms  +%8.3f ms  heap %6u  %s", ev.us / 1000.0,
+              (ev.us - prev) / 1000.0, (unsigned)ev.freeHeap, ev.label);
+    prev = ev.us;
+  }
+  if (bootTraceDropped())
+    logPrintf("  (%u earlier events overwritten)",
+              (unsigned)bootTraceDropped());
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+// ============================================================
+//  Boot Trace — Timestamped Boot Timeline
+// ============================================================
+//
+//  setup() and the init functions call bootTraceMark() at each
+//  milestone (storage mounted, safety window over, USB up, ...).
+//  Events go into a fixed ring of BOOT_TRACE_MAX entries — no
+//  allocation, safe before Serial or the heap are of any use —
+//  and the oldest are overwritten if boot marks more than that.
+//
+//  The timeline is logged (logger.h) at the end of setup() and
+//  served as JSON at GET /api/boot-trace.
+//
+// ============================================================
+
+#include <Arduino.h>
+
+struct BootEvent {
+  uint32_t us;       // micros() since reset
+  uint32_t freeHeap; // ESP.getFreeHeap() at the mark
+  const char *label; // static string passed to bootTraceMark()
+};
+
+/// Record a boot milestone. `label` must outlive the trace (a literal).
+void bootTraceMark(const char *label);
+
+/// Events held (at most BOOT_TRACE_MAX), and how many were overwritten.
+size_t bootTraceCount();
+uint32_t bootTraceDropped();
+
+/// Event `i`, oldest first. False if `i` is out of range.
+bool bootTraceGet(size_t i, BootEvent &ev);
+
+/// Log the timeline with per-step deltas.
+void bootTraceDump();
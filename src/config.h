@@ -16,6 +16,13 @@
 #define WIFI_CHANNEL      1
 #define WIFI_MAX_CLIENTS  2
 
+// --- Captive-Portal DNS (dns_responder.h) ---
+#define DNS_TTL_S         60      // TTL of the A answers
+#define DNS_PACKET_MAX    512     // UDP DNS limit without EDNS
+#define DNS_POLL_MS       1000    // recv timeout: how often dnsStop() is seen
+#define DNS_TASK_STACK    3072
+#define DNS_TASK_PRIO     1       // low: a late DNS reply only delays the portal
+
 // --- Web Server ---
 #define WEB_SERVER_PORT   80
 
@@ -23,6 +30,22 @@
 #define PAYLOAD_DIR       "/payloads"
 #define AUTORUN_FILE      "/config/autorun.txt"   // stores name of auto-run payload
 #define MAX_PAYLOAD_SIZE  (64 * 1024)             // 64 KB max per script
+#define MAX_PAYLOAD_NAME  64                      // max payload name length
+#define STAGING_DIR       "/staging"              // in-progress writes
+#define PAYLOAD_COMPRESS_MIN 128                  // smaller payloads stay plain
+
+// --- Script Modules (INCLUDE, module_cache.h) ---
+#define MODULE_CACHE_BYTES (32 * 1024) // compiled images kept in RAM
+#define MODULE_MAX_DEPTH  4       // INCLUDE nesting
+
+// --- Payload Cache (PSRAM, payload_cache.h) ---
+#define PAYLOAD_CACHE_BYTES (1024 * 1024) // sources + images; 0 = off
+
+// --- Memory (arena.h, heap_monitor.h, /api/heap) ---
+#define ARENA_JOB_BYTES   (64 * 1024) // parser scratch, one run (PSRAM)
+#define ARENA_HTTP_BYTES  (32 * 1024) // scratch of one web request (PSRAM)
+#define HEAP_SAMPLE_MS    (5 * 60 * 1000) // heap history interval
+#define HEAP_HISTORY_LEN  288     // samples kept (24 h)
 
 // --- Boot Safety ---
 #define BOOT_BUTTON_PIN   0       // GPIO0 = BOOT button on most dev boards
@@ -35,8 +58,89 @@
 // --- DuckyScript Parser ---
 #define DEFAULT_CMD_DELAY 0       // ms between commands (overridden by DEFAULT_DELAY)
 #define PARSER_TASK_STACK 8192    // FreeRTOS task stack size (bytes)
-#define PARSER_TASK_PRIO  1       // FreeRTOS task priority
-#define PARSER_TASK_CORE  0       // pin to core 0 (core 1 for Wi-Fi)
+#define PARSER_TASK_PRIO  1       // FreeRTOS task priority (default; /api/tasks)
+#define PARSER_TASK_CORE  0       // default core; Wi-Fi/lwIP also run on core 0
+                                  // — measure with /api/contention
+
+// --- Keyboard Reports ---
+#define HID_NKRO          1       // NKRO bitmap interface (boot protocol falls back)
+#define HID_NKRO_BATCH_MAX 24     // distinct keys pressed in one NKRO report
+
+// --- Mouse (MOUSE_MOVE / MOUSE_GLIDE / MOUSE_MOVE_TO) ---
+#define MOUSE_PATH_INTERVAL_MS 1  // report spacing of a path (HID poll, bInterval 1)
+#define MOUSE_PATH_MAX_STEPS 1000 // reports in one precomputed path
+#define MOUSE_MOVE_MAX    32767   // |dx|, |dy| of one MOUSE_MOVE / MOUSE_GLIDE
+#define MOUSE_GLIDE_MAX_MS 10000  // MOUSE_GLIDE duration
+#define MOUSE_ABS_MAX     32767   // absolute pointer logical range 0..MAX
+#define MOUSE_SCREEN_W    1920    // MOUSE_MOVE_TO pixels until MOUSE_SCREEN
+#define MOUSE_SCREEN_H    1080
+
+// --- Status Events (status_events.h) ---
+#define STATUS_QUEUE_LEN  8       // start/end events waiting for the status task
+#define STATUS_COALESCE_MS 50     // at most one progress event per interval
+#define STATUS_MAX_SUBSCRIBERS 4
+#define STATUS_TASK_STACK 4096    // callbacks and subscribers run here
+#define STATUS_TASK_PRIO  1       // lowest: observers never preempt HID output
+
+// --- Parser Limits (duckySetLimits) ---
+#define DUCKY_MAX_LINE_LEN 4096   // bytes per line
+#define DUCKY_MAX_LINES   20000   // lines per script
+#define DUCKY_MAX_REPEAT  10000   // REPEAT count
+#define DUCKY_MAX_COMMANDS 200000 // commands per script, REPEATs expanded
+#define DUCKY_MAX_DELAY_MS 3600000 // DELAY / DEFAULT_DELAY (1 hour)
+#define DUCKY_ABORT_POLL_MS 50    // long DELAYs check for duckyStop() this often
+
+// --- Host Sync (WAIT_FOR_*) ---
+#define DUCKY_WAIT_TIMEOUT_MS 60000 // when the line gives no timeout
+#define DUCKY_WAIT_BUTTON_PIN BOOT_BUTTON_PIN // WAIT_FOR_BUTTON, active LOW
+
+// --- Live Keyboard (WebSocket) ---
+#define LIVE_WS_PATH      "/ws/live"
+#define LIVE_QUEUE_LEN    32      // events buffered ahead of the HID task
+#define LIVE_TEXT_MAX     32      // max bytes in one text event
+#define LIVE_TASK_STACK   4096
+#define LIVE_TASK_PRIO    2       // above the parser: interactive input
+#define LIVE_TASK_CORE    0
+#define LIVE_DOORBELL_PORT 8099   // loopback only: HID task → AsyncTCP acks
+
+// --- Metrics (/api/metrics) ---
+#define HID_BURST_GAP_US  100000  // report gaps above this end a burst (jitter)
+#define METRICS_MAX_ROUTES 32     // HTTP routes with latency histograms
+
+// --- Execution Profiler (/api/profile) ---
+#define PROFILE_MAX_EVENTS 4096   // lines recorded per run (28 B each, PSRAM)
+
+// --- HID Trace Capture ---
+#define HID_TRACE_MAX     (64 * 1024) // trace buffer; capture stops when full
+
+// --- Deferred Logging (logger.h) ---
+#define LOG_RING_LEN      64      // records per core (power of two, 64 B each)
+#define LOG_TASK_STACK    4096
+#define LOG_TASK_PRIO     1       // loop-task level: below the parser and live HID
+#define LOG_TASK_CORE     -1      // either core
+#define LOG_DRAIN_MS      20      // poll interval while the rings are empty
+#define LOG_FILE          "/logs/log.txt"
+#define LOG_FILE_OLD      "/logs/log.1.txt"
+#define LOG_FILE_MAX      (32 * 1024) // rotate past this size
+#define LOG_SINKS         (LOG_SINK_SERIAL | LOG_SINK_FILE) // after mount
+
+// --- Task Placement (task_placement.h, /api/tasks) ---
+#define TASK_PLACEMENT_FILE "/config/tasks.txt" // saved overrides of the defaults
+#define TASK_PRIO_MAX     15      // stay below lwIP (18) and the Wi-Fi driver (23)
+#define WEB_TASK_PRIO     3       // AsyncTCP's own default
+#ifdef CONFIG_ASYNC_TCP_RUNNING_CORE
+#define WEB_TASK_CORE     CONFIG_ASYNC_TCP_RUNNING_CORE // build-time only
+#else
+#define WEB_TASK_CORE     -1
+#endif
+
+// --- Contention Test (contention.h, /api/contention) ---
+#define CONTENTION_MAX_REPORTS 4000 // reports per run (4 B of heap each)
+#define CONTENTION_INTERVAL_MS 5    // default gap: typeString()'s inter-key delay
+#define CONTENTION_TASK_STACK  3072
+
+// --- Boot Trace (/api/boot-trace) ---
+#define BOOT_TRACE_MAX    32      // boot events kept (12 B each, ring)
 
 // --- Keyboard Layout Fix ---
 #define FIX_LAYOUT_DELAY  100     // ms to hold ALT+SHIFT for layout switch
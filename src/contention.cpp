@@ -0,0 +1,132 @@
+// ============================================================
+//  Contention Test — Keystroke Jitter Under Network Load
+// ============================================================
+
+#include "contention.h"
+#include "config.h"
+#include "ducky_parser.h"
+#include "logger.h"
+#include "metrics.h"
+#include "usb_hid.h"
+
+#include <algorithm>
+
+static ContentionResult sResult = {};
+static uint32_t *sJitter = nullptr; // |gap - interval| per gap (µs)
+static TaskHandle_t sTask = nullptr;
+static portMUX_TYPE sMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Summary of the `n` recorded gaps (sorts them in place)
+static void summarize(uint32_t n) {
+  uint64_t sum = 0;
+  for (uint32_t i = 0; i < n; i++)
+    sum += sJitter[i];
+  std::sort(sJitter, sJitter + n);
+
+  portENTER_CRITICAL(&sMux);
+  sResult.jitterAvgUs = n ? sum / n : 0;
+  sResult.jitterP50Us = n ? sJitter[n / 2] : 0;
+  sResult.jitterP99Us = n ? sJitter[(uint64_t)n * 99 / 100] : 0;
+  sResult.jitterMaxUs = n ? sJitter[n - 1] : 0;
+  portEXIT_CRITICAL(&sMux);
+}
+
+// One all-keys-up report, unless a script owns the HID output
+static bool sendEmptyReport() {
+  if (duckyIsRunning() || !hidAcquire(0))
+    return false;
+  releaseAllKeys();
+  hidRelease();
+  return true;
+}
+
+static void contentionTask(void *) {
+  const uint32_t total = sResult.reports;
+  const uint32_t intervalUs = sResult.intervalUs;
+  const uint32_t http0 = metricsHttpRequests();
+  const uint32_t t0 = millis();
+
+  // Empty reports: the host sees key-up events and types nothing.
+  // Each takes the HID output (usb_hid.h); a script that has it wins.
+  bool started = sendEmptyReport();
+  bool interrupted = !started;
+  uint32_t prev = micros();
+  uint32_t gaps = 0;
+  for (uint32_t i = 1; started && i < total; i++) {
+    delay(intervalUs / 1000);
+    if (!sendEmptyReport()) {
+      interrupted = true;
+      break;
+    }
+    uint32_t now = micros();
+    uint32_t gap = now - prev;
+    prev = now;
+    sJitter[gaps++] = gap > intervalUs ? gap - intervalUs : intervalUs - gap;
+  }
+
+  summarize(gaps);
+  free(sJitter);
+  sJitter = nullptr;
+
+  portENTER_CRITICAL(&sMux);
+  sResult.reports = started ? gaps + 1 : 0;
+  sResult.durationMs = millis() - t0;
+  sResult.httpRequests = metricsHttpRequests() - http0;
+  sResult.interrupted = interrupted;
+  sResult.running = false;
+  sResult.runs++;
+  sTask = nullptr;
+  portEXIT_CRITICAL(&sMux);
+
+  logPrintf("[Contention] %u reports on core %d prio %u: jitter avg %u p99 "
+            "%u max %u us, %u HTTP requests%s",
+            sResult.reports, sResult.core, sResult.prio, sResult.jitterAvgUs,
+            sResult.jitterP99Us, sResult.jitterMaxUs, sResult.httpRequests,
+            interrupted ? " (interrupted)" : "");
+  vTaskDelete(nullptr);
+}
+
+// ================================================================
+//  Public API
+// ================================================================
+
+const char *contentionStart(uint32_t reports, uint32_t intervalMs) {
+  if (sTask)
+    return "contention test already running";
+  if (duckyIsRunning())
+    return "a script is running";
+
+  sJitter = (uint32_t *)malloc((reports - 1) * sizeof(uint32_t));
+  if (!sJitter)
+    return "out of memory";
+
+  // Same core and priority as the parser would get for a script
+  TaskPlacement p = placementGet(TASK_ROLE_PARSER);
+  uint32_t runs = sResult.runs;
+  portENTER_CRITICAL(&sMux);
+  sResult = {};
+  sResult.running = true;
+  sResult.runs = runs;
+  sResult.reports = reports;
+  sResult.intervalUs = intervalMs * 1000;
+  sResult.core = p.core;
+  sResult.prio = p.prio;
+  portEXIT_CRITICAL(&sMux);
+
+  if (xTaskCreatePinnedToCore(contentionTask, "Contention",
+                              CONTENTION_TASK_STACK, nullptr, p.prio, &sTask,
+                              p.core < 0 ? tskNO_AFFINITY : p.core) != pdPASS) {
+    free(sJitter);
+    sJitter = nullptr;
+    sResult.running = false;
+    return "out of memory";
+  }
+  return nullptr;
+}
+
+ContentionResult contentionGetResult() {
+  portENTER_CRITICAL(&sMux);
+  ContentionResult r = sResult;
+  portEXIT_CRITICAL(&sMux);
+  return r;
+}
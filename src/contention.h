@@ -0,0 +1,47 @@
+#pragma once
+
+// ============================================================
+//  Contention Test — Keystroke Jitter Under Network Load
+// ============================================================
+//
+//  Sends a fixed number of empty keyboard reports (nothing is typed
+//  on the host) at typeString()'s pacing from a task with the
+//  parser's placement (task_placement.h), and records how far each
+//  gap between reports strays from the interval. Run it while
+//  clients hammer the API (scripts/contention.py) to compare core
+//  and priority placements; the result also counts the HTTP
+//  requests served meanwhile so runs under different load can be
+//  told apart.
+//
+//  The test refuses to start while a script runs and stops early if
+//  one starts.
+//
+// ============================================================
+
+#include "task_placement.h"
+
+#include <Arduino.h>
+
+struct ContentionResult {
+  bool running;
+  bool interrupted;     // a script started mid-run
+  uint32_t runs;        // completed runs since boot
+  uint32_t reports;     // reports sent
+  uint32_t intervalUs;  // requested gap
+  uint32_t durationMs;
+  uint32_t jitterAvgUs; // |gap - interval| over all gaps
+  uint32_t jitterP50Us;
+  uint32_t jitterP99Us;
+  uint32_t jitterMaxUs;
+  uint32_t httpRequests; // HTTP requests served during the run
+  int8_t core;           // placement the test task ran with
+  uint8_t prio;
+};
+
+/// Start a run of `reports` (2..CONTENTION_MAX_REPORTS) reports,
+/// `intervalMs` apart. Returns nullptr, or why the run was refused
+/// (a test or script is already running, or out of memory).
+const char *contentionStart(uint32_t reports, uint32_t intervalMs);
+
+/// Last (or current) result.
+ContentionResult contentionGetResult();
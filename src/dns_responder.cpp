@@ -0,0 +1,170 @@
+// ============================================================
+//  DNS Responder — Captive-Portal DNS on Its Own Task
+// ============================================================
+
+#include "dns_responder.h"
+#include "config.h"
+#include "logger.h"
+
+#include <atomic>
+
+#ifdef NATIVE_BUILD
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#else
+#include <lwip/sockets.h>
+#endif
+
+#define DNS_HEADER_LEN 12
+#define DNS_ANSWER_LEN 16
+#define DNS_TYPE_A 1
+#define DNS_TYPE_ANY 255
+#define DNS_CLASS_IN 1
+#define DNS_CLASS_ANY 255
+
+// Answer record appended after the question: pointer to the name at
+// offset 12, type A, class IN, TTL, RDLENGTH 4, address
+static uint8_t sAnswer[DNS_ANSWER_LEN] = {
+    0xC0, 0x0C, 0, DNS_TYPE_A, 0, DNS_CLASS_IN,
+    (uint8_t)(DNS_TTL_S >> 24), (uint8_t)(DNS_TTL_S >> 16),
+    (uint8_t)(DNS_TTL_S >> 8), (uint8_t)DNS_TTL_S, 0, 4};
+
+static int sSock = -1;
+static TaskHandle_t sTask = nullptr;
+static std::atomic<bool> sRun{false};
+
+static std::atomic<uint32_t> sQueries{0};
+static std::atomic<uint32_t> sAnswered{0};
+static std::atomic<uint32_t> sEmpty{0};
+static std::atomic<uint32_t> sDropped{0};
+
+static uint16_t be16(const uint8_t *p) { return (uint16_t)(p[0] << 8 | p[1]); }
+
+// ================================================================
+//  Reply
+// ================================================================
+
+size_t dnsBuildReply(const uint8_t *q, size_t len, uint8_t *out) {
+  // Standard query (QR = 0, OPCODE = 0) with exactly one question
+  if (len < DNS_HEADER_LEN || len > DNS_PACKET_MAX || (q[2] & 0xF8) != 0 ||
+      be16(q + 4) != 1)
+    return 0;
+
+  // QNAME: uncompressed labels up to the root label
+  size_t pos = DNS_HEADER_LEN;
+  while (pos < len && q[pos] != 0) {
+    if (q[pos] > 63)
+      return 0;
+    pos += 1 + q[pos];
+  }
+  size_t qend = pos + 1 + 4; // root label, QTYPE, QCLASS
+  if (qend > len)
+    return 0;
+  uint16_t qtype = be16(q + pos + 1);
+  uint16_t qclass = be16(q + pos + 3);
+  bool answer = (qtype == DNS_TYPE_A || qtype == DNS_TYPE_ANY) &&
+                (qclass == DNS_CLASS_IN || qclass == DNS_CLASS_ANY);
+  if (qend + (answer ? DNS_ANSWER_LEN : 0) > DNS_PACKET_MAX)
+    return 0;
+
+  // Header + question as received; additional records (EDNS) dropped
+  memcpy(out, q, qend);
+  out[2] = 0x84 | (q[2] & 0x01); // QR, AA, RD as asked
+  out[3] = 0x00;                 // RA = 0, RCODE = NOERROR
+  out[6] = 0;
+  out[7] = answer ? 1 : 0; // ANCOUNT
+  memset(out + 8, 0, 4);   // NSCOUNT, ARCOUNT
+  if (!answer)
+    return qend;
+  memcpy(out + qend, sAnswer, DNS_ANSWER_LEN);
+  return qend + DNS_ANSWER_LEN;
+}
+
+// ================================================================
+//  Task
+// ================================================================
+
+static void dnsTask(void *param) {
+  // One byte of headroom: recvfrom() cuts a datagram to the buffer,
+  // and an oversized one must still look oversized to dnsBuildReply()
+  static uint8_t rx[DNS_PACKET_MAX + 1];
+  static uint8_t tx[DNS_PACKET_MAX];
+
+  while (sRun.load(std::memory_order_relaxed)) {
+    sockaddr_in from;
+    socklen_t fromLen = sizeof(from);
+    int n = recvfrom(sSock, rx, sizeof(rx), 0, (sockaddr *)&from, &fromLen);
+    if (n <= 0)
+      continue; // DNS_POLL_MS timeout: re-check sRun
+
+    sQueries.fetch_add(1, std::memory_order_relaxed);
+    size_t out = dnsBuildReply(rx, n, tx);
+    if (!out) {
+      sDropped.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+    (tx[7] ? sAnswered : sEmpty).fetch_add(1, std::memory_order_relaxed);
+    sendto(sSock, tx, out, 0, (sockaddr *)&from, fromLen);
+  }
+
+  close(sSock);
+  sSock = -1;
+  sTask = nullptr;
+  vTaskDelete(nullptr);
+}
+
+// ================================================================
+//  Public API
+// ================================================================
+
+bool dnsStart(const uint8_t ip[4], uint16_t port) {
+  if (sTask)
+    return false;
+  memcpy(sAnswer + 12, ip, 4);
+
+  sSock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (sSock < 0) {
+    logPrintf("[DNS] socket() failed");
+    return false;
+  }
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  timeval tv = {DNS_POLL_MS / 1000, (DNS_POLL_MS % 1000) * 1000};
+  setsockopt(sSock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  if (bind(sSock, (sockaddr *)&addr, sizeof(addr)) < 0) {
+    logPrintf("[DNS] bind to port %u failed", port);
+    close(sSock);
+    sSock = -1;
+    return false;
+  }
+
+  sRun = true;
+  if (xTaskCreatePinnedToCore(dnsTask, "DNS", DNS_TASK_STACK, nullptr,
+                              DNS_TASK_PRIO, &sTask,
+                              tskNO_AFFINITY) != pdPASS) {
+    sRun = false;
+    close(sSock);
+    sSock = -1;
+    return false;
+  }
+  return true;
+}
+
+void dnsStop() {
+  sRun = false;
+  while (sTask)
+    delay(10);
+}
+
+DnsStats dnsGetStats() {
+  DnsStats s;
+  s.queries = sQueries.load(std::memory_order_relaxed);
+  s.answered = sAnswered.load(std::memory_order_relaxed);
+  s.empty = sEmpty.load(std::memory_order_relaxed);
+  s.dropped = sDropped.load(std::memory_order_relaxed);
+  return s;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+// ============================================================
+//  DNS Responder — Captive-Portal DNS on Its Own Task
+// ============================================================
+//
+//  Answers every A query with the AP address, so phones and laptops
+//  joining the AP open the dashboard instead of waiting out DNS
+//  timeouts. A low-priority task blocks in recvfrom() on a UDP
+//  socket; loop() is not involved.
+//
+//  Replies are built in place from the query: header flags patched,
+//  the question copied, and a preformatted 16-byte answer appended
+//  (name pointer, A/IN, DNS_TTL_S, address). No allocation per
+//  packet. Other query types get an empty NOERROR reply (clients
+//  fall back to A at once); malformed or oversized packets and
+//  responses are dropped.
+//
+//  BSD sockets only (lwIP on the device, the host's own on Linux),
+//  so the same code runs in the native build against local UDP
+//  sockets (test/test_dns_responder, `pio test -e native`).
+//
+// ============================================================
+
+#include <Arduino.h>
+
+/// Start answering on UDP `port` with IPv4 address `ip` (a.b.c.d as
+/// ip[0..3]). Returns false if the socket or task can't be created.
+bool dnsStart(const uint8_t ip[4], uint16_t port = 53);
+
+/// Stop the responder (returns within DNS_POLL_MS).
+void dnsStop();
+
+/// Build the reply to `query` into `out` (DNS_PACKET_MAX bytes).
+/// Returns the reply length, or 0 if the packet should be dropped.
+size_t dnsBuildReply(const uint8_t *query, size_t len, uint8_t *out);
+
+/// Counters since boot.
+struct DnsStats {
+  uint32_t queries;  // packets received
+  uint32_t answered; // replies with the A record
+  uint32_t empty;    // replies without an answer (AAAA, HTTPS, ...)
+  uint32_t dropped;  // malformed or not a query
+};
+
+/// Snapshot of the DNS counters.
+DnsStats dnsGetStats();
@@ -0,0 +1,933 @@
+// ============================================================
+//  DuckyScript Compiler — Source → Bytecode
+// ============================================================
+
+#include "ducky_compiler.h"
+#include "arena.h"
+#include "config.h"
+#include "ducky_parser.h"
+#include "keyboard_layout.h"
+
+// One instruction before encoding (the optimizer works on these).
+// STRING text stays in the source: `arg` bytes at `off`. `join`
+// means the optimizer merged the next op's text into this one.
+// MOUSE_PATH keeps its move until encode(): dx | dy << 16 in `off`,
+// the glide time in `arg` (0 = straight line). OP_INCLUDE is a linked
+// module: `arg` indexes the modules, `b` = 1 if it sets DEFAULT_DELAY
+// (last to `off` ms).
+#define OP_INCLUDE 0xFF // never encoded: the module's code is
+
+struct CompiledOp {
+  uint8_t op;
+  bool join;
+  uint8_t a, b;
+  uint32_t line;
+  uint32_t arg;
+  uint32_t off;
+};
+
+// Scratch of one compile: from the parser's arena on the device
+typedef std::vector<CompiledOp, ArenaAllocator<CompiledOp>> OpList;
+
+static const char *const OP_NAMES[DOP_COUNT] = {
+    "END",    "DELAY",       "DEFAULT_DELAY", "STRING",
+    "STRINGLN", "KEY",       "MOUSE_MOVE",    "MOUSE_CLICK",
+    "MOUSE_SCROLL", "REPEAT", "NOP", "MOUSE_MOVE_TO",
+    "MOUSE_PATH", "WAIT"};
+
+// WAIT_FOR_<name> commands
+struct WaitCommand {
+  const char *name;
+  uint8_t source, mode;
+};
+
+static const WaitCommand WAIT_COMMANDS[] = {
+    {"WAIT_FOR_CAPS_ON", DWAIT_CAPS_LOCK, DWAIT_ON},
+    {"WAIT_FOR_CAPS_OFF", DWAIT_CAPS_LOCK, DWAIT_OFF},
+    {"WAIT_FOR_CAPS_CHANGE", DWAIT_CAPS_LOCK, DWAIT_CHANGE},
+    {"WAIT_FOR_NUM_ON", DWAIT_NUM_LOCK, DWAIT_ON},
+    {"WAIT_FOR_NUM_OFF", DWAIT_NUM_LOCK, DWAIT_OFF},
+    {"WAIT_FOR_NUM_CHANGE", DWAIT_NUM_LOCK, DWAIT_CHANGE},
+    {"WAIT_FOR_SCROLL_ON", DWAIT_SCROLL_LOCK, DWAIT_ON},
+    {"WAIT_FOR_SCROLL_OFF", DWAIT_SCROLL_LOCK, DWAIT_OFF},
+    {"WAIT_FOR_SCROLL_CHANGE", DWAIT_SCROLL_LOCK, DWAIT_CHANGE},
+    {"WAIT_FOR_BUTTON", DWAIT_BUTTON, DWAIT_ON},
+};
+
+static uint8_t resolveKey(const String &keyName);
+static uint8_t resolveModifier(const String &modName);
+
+const char *duckyOpName(uint8_t op) {
+  return op < DOP_COUNT ? OP_NAMES[op] : "?";
+}
+
+const char *duckyWaitName(uint8_t source, uint8_t mode) {
+  for (const WaitCommand &w : WAIT_COMMANDS) {
+    if (w.source == source && w.mode == mode)
+      return w.name;
+  }
+  return "?";
+}
+
+// MOUSE_MOVE_TO pixels → absolute units (MOUSE_SCREEN)
+struct MouseScreen {
+  uint32_t w, h;
+};
+
+static bool fail(DuckyCompileResult &res, uint32_t line, const char *why) {
+  res.ok = false;
+  res.errorLine = line;
+  res.error = why;
+  return false;
+}
+
+// Integer argument starting at `from`. strtol saturates instead of
+// wrapping, so out-of-range input stays out of range.
+static long argNumber(const String &line, int from) {
+  if (from < 0 || from >= (int)line.length())
+    return 0;
+  return strtol(line.c_str() + from, nullptr, 10);
+}
+
+// ================================================================
+//  Mouse paths
+// ================================================================
+
+static int32_t divRound(int64_t num, int64_t den) {
+  return num >= 0 ? (num + den / 2) / den : -((-num + den / 2) / den);
+}
+
+// Reports in the path of `op`; sets the spacing in ms. A straight
+// move uses the fewest reports that keep every step within ±127; a
+// glide one report per poll for its duration, but no fewer than its
+// steepest (1.5×) step needs and no more than MOUSE_PATH_MAX_STEPS.
+static uint32_t pathPlan(const CompiledOp &op, uint8_t &interval) {
+  int32_t dx = (int16_t)(op.off & 0xFFFF), dy = (int16_t)(op.off >> 16);
+  uint32_t d = std::max(abs(dx), abs(dy));
+  uint32_t n = (d + 126) / 127;
+  interval = MOUSE_PATH_INTERVAL_MS;
+  if (op.arg) {
+    uint32_t ms = op.arg;
+    if (ms / interval > MOUSE_PATH_MAX_STEPS)
+      interval = (ms + MOUSE_PATH_MAX_STEPS - 1) / MOUSE_PATH_MAX_STEPS;
+    n = std::max(ms / interval, (3 * d + 251) / 252);
+  }
+  return std::max(n, (uint32_t)1);
+}
+
+// Offset along one axis after report i of n (eased for a glide)
+static int32_t pathPos(int32_t d, uint32_t i, uint32_t n, bool ease) {
+  if (!ease)
+    return divRound((int64_t)d * i, n);
+  // smoothstep: 3t² − 2t³
+  int64_t num = (int64_t)3 * i * i * n - (int64_t)2 * i * i * i;
+  return divRound(d * num, (int64_t)n * n * n);
+}
+
+static void putPath(std::vector<uint8_t> &code, const CompiledOp &op,
+                    uint32_t n) {
+  int32_t dx = (int16_t)(op.off & 0xFFFF), dy = (int16_t)(op.off >> 16);
+  bool ease = op.arg != 0;
+  for (uint32_t i = 1; i <= n; i++) {
+    code.push_back(
+        (uint8_t)(pathPos(dx, i, n, ease) - pathPos(dx, i - 1, n, ease)));
+    code.push_back(
+        (uint8_t)(pathPos(dy, i, n, ease) - pathPos(dy, i - 1, n, ease)));
+  }
+}
+
+// "<dx> <dy>" at `from`; false if either is missing
+static bool argPair(const String &line, int from, long &x, long &y) {
+  int spaceIdx = line.indexOf(' ', from);
+  if (spaceIdx <= from)
+    return false;
+  x = argNumber(line, from);
+  y = argNumber(line, spaceIdx + 1);
+  return true;
+}
+
+// ================================================================
+//  Lines → instructions
+// ================================================================
+
+// One command line, trimmed; it starts at `base` in the source.
+// Returns nullptr, or why the line is rejected.
+static const char *compileCommand(const String &line, uint32_t base,
+                                  CompiledOp &op, const DuckyLimits &lim,
+                                  const MouseScreen &screen) {
+  op.op = DOP_NOP;
+
+  // --- DELAY ---
+  if (line.startsWith("DELAY ")) {
+    long ms = argNumber(line, 6);
+    if (ms < 0 || ms > (long)lim.maxDelayMs)
+      return "DELAY out of range";
+    op.op = DOP_DELAY;
+    op.arg = ms;
+    return nullptr;
+  }
+
+  // --- STRING ---
+  if (line.startsWith("STRING ")) {
+    op.op = DOP_STRING;
+    op.off = base + 7;
+    op.arg = line.length() - 7;
+    return nullptr;
+  }
+  if (line.startsWith("STRINGLN ")) {
+    op.op = DOP_STRINGLN;
+    op.off = base + 9;
+    op.arg = line.length() - 9;
+    return nullptr;
+  }
+
+  // --- WAIT_FOR_* [timeout ms] — until the host signals ---
+  if (line.startsWith("WAIT_FOR_")) {
+    int spaceIdx = line.indexOf(' ');
+    String name = spaceIdx < 0 ? line : line.substring(0, spaceIdx);
+    for (const WaitCommand &w : WAIT_COMMANDS) {
+      if (name != w.name)
+        continue;
+      long ms = spaceIdx < 0 ? std::min((uint32_t)DUCKY_WAIT_TIMEOUT_MS,
+                                        lim.maxDelayMs)
+                             : argNumber(line, spaceIdx + 1);
+      if (ms < 1 || ms > (long)lim.maxDelayMs)
+        return "WAIT_FOR timeout out of range";
+      op.op = DOP_WAIT;
+      op.a = w.source;
+      op.b = w.mode;
+      op.arg = ms;
+      return nullptr;
+    }
+    return "unknown WAIT_FOR condition"; // a typo must not skip the wait
+  }
+
+  // --- MOUSE commands ---
+  if (line.startsWith("MOUSE_MOVE ")) {
+    long dx, dy;
+    if (!argPair(line, 11, dx, dy))
+      return nullptr;
+    if (dx < -MOUSE_MOVE_MAX || dx > MOUSE_MOVE_MAX || dy < -MOUSE_MOVE_MAX ||
+        dy > MOUSE_MOVE_MAX)
+      return "MOUSE_MOVE delta out of range";
+    if (dx >= -127 && dx <= 127 && dy >= -127 && dy <= 127) {
+      op.op = DOP_MOUSE_MOVE; // fits one HID report
+      op.a = (uint8_t)(int8_t)dx;
+      op.b = (uint8_t)(int8_t)dy;
+    } else {
+      op.op = DOP_MOUSE_PATH;
+      op.off = (uint16_t)dx | (uint32_t)(uint16_t)dy << 16;
+    }
+    return nullptr;
+  }
+  if (line.startsWith("MOUSE_GLIDE ")) {
+    long dx, dy;
+    int msIdx = line.lastIndexOf(' ');
+    if (!argPair(line, 12, dx, dy) || msIdx <= line.indexOf(' ', 12))
+      return "MOUSE_GLIDE needs dx dy ms";
+    long ms = argNumber(line, msIdx + 1);
+    if (dx < -MOUSE_MOVE_MAX || dx > MOUSE_MOVE_MAX || dy < -MOUSE_MOVE_MAX ||
+        dy > MOUSE_MOVE_MAX)
+      return "MOUSE_GLIDE delta out of range";
+    if (ms < 1 || ms > MOUSE_GLIDE_MAX_MS)
+      return "MOUSE_GLIDE time out of range";
+    op.op = DOP_MOUSE_PATH;
+    op.off = (uint16_t)dx | (uint32_t)(uint16_t)dy << 16;
+    op.arg = ms;
+    return nullptr;
+  }
+  if (line.startsWith("MOUSE_MOVE_TO ")) {
+    long x, y;
+    if (!argPair(line, 14, x, y))
+      return "MOUSE_MOVE_TO needs x y";
+    if (x < 0 || x >= (long)screen.w || y < 0 || y >= (long)screen.h)
+      return "MOUSE_MOVE_TO outside the screen";
+    // Pixel centres, so the host maps back to the same pixel
+    op.op = DOP_MOUSE_MOVE_TO;
+    op.arg = (uint32_t)(((2 * x + 1) * MOUSE_ABS_MAX) / (2 * screen.w)) |
+             (uint32_t)(((2 * y + 1) * MOUSE_ABS_MAX) / (2 * screen.h)) << 16;
+    return nullptr;
+  }
+  if (line.startsWith("MOUSE_CLICK")) {
+    String arg = line.substring(11);
+    arg.trim();
+    op.op = DOP_MOUSE_CLICK;
+    op.a = arg.equalsIgnoreCase("RIGHT")    ? 1
+           : arg.equalsIgnoreCase("MIDDLE") ? 2
+                                            : 0;
+    return nullptr;
+  }
+  if (line.startsWith("MOUSE_SCROLL ")) {
+    long amount = argNumber(line, 13);
+    if (amount < -127 || amount > 127)
+      return "MOUSE_SCROLL amount outside -127..127";
+    op.op = DOP_MOUSE_SCROLL;
+    op.a = (uint8_t)(int8_t)amount;
+    return nullptr;
+  }
+
+  // --- Single keys and modifier combos ---
+  // Supports:  ENTER  |  GUI r  |  CTRL ALT DELETE  |  SHIFT TAB  etc.
+  uint8_t modMask = 0;
+  int len = line.length();
+  int pos = 0;
+
+  // Parse modifier tokens from the front — one pass over the line,
+  // each token copied once
+  while (pos < len) {
+    int end = line.indexOf(' ', pos);
+    if (end < 0)
+      end = len;
+    String token = line.substring(pos, end);
+    pos = end;
+    while (pos < len && isspace((unsigned char)line.charAt(pos)))
+      pos++;
+
+    uint8_t mod = resolveModifier(token);
+    if (mod != MOD_NONE) {
+      modMask |= mod;
+      continue;
+    }
+
+    // This token is the final key
+    uint8_t key = resolveKey(token);
+    if (key != KEY_NONE) {
+      op.op = DOP_KEY;
+      op.a = key;
+      op.b = modMask;
+    } else if (token.length() == 1) {
+      // Single character — type it with modifiers
+      KeyMapping km = getKeyMapping(token.charAt(0));
+      op.op = DOP_KEY;
+      op.a = km.keycode;
+      op.b = modMask | km.modifier;
+    }
+    return nullptr;
+  }
+
+  // If we only got modifiers with no final key (e.g. "GUI" alone)
+  if (modMask != 0) {
+    op.op = DOP_KEY;
+    op.a = KEY_NONE;
+    op.b = modMask;
+  }
+  return nullptr;
+}
+
+// ================================================================
+//  Optimizer
+// ================================================================
+
+// True if a REPEAT re-runs ops[i] (DEFAULT_DELAY doesn't count as
+// the "last command", so look past it).
+static bool repeatFollows(const OpList &ops, size_t i) {
+  while (++i < ops.size() && ops[i].op == DOP_DEFAULT_DELAY) {
+  }
+  return i < ops.size() && ops[i].op == DOP_REPEAT;
+}
+
+// Rewrites that keep the typed result and the script's waits. The
+// reports match too, except that a merged STRING run can be batched
+// into fewer NKRO reports than its lines were (typeNkroBatch() then
+// sees no line boundary). `p` is the last op kept and `c` the current
+// one; `c` is left alone if a REPEAT re-runs it.
+static void optimize(OpList &ops, const DuckyLimits &lim) {
+  size_t n = 0;        // ops[0..n) is the optimized prefix
+  uint32_t runLen = 0; // text length of the STRING run ending at `p`
+  uint32_t defaultDelay = DEFAULT_CMD_DELAY;
+
+  for (size_t i = 0; i < ops.size(); i++) {
+    CompiledOp c = ops[i];
+    if (c.op == DOP_DEFAULT_DELAY)
+      defaultDelay = c.arg;
+    if (c.op == OP_INCLUDE && c.b)
+      defaultDelay = c.off;
+    bool repeated = repeatFollows(ops, i);
+    CompiledOp *p = n ? &ops[n - 1] : nullptr;
+
+    if (!repeated && c.op == DOP_NOP && defaultDelay == 0)
+      continue; // does nothing, waits nothing
+
+    // DELAY a, [default], DELAY b  →  DELAY a+default+b
+    if (!repeated && p && p->op == DOP_DELAY &&
+        (c.op == DOP_DELAY || c.op == DOP_NOP)) {
+      uint64_t ms = (uint64_t)p->arg + defaultDelay +
+                    (c.op == DOP_DELAY ? c.arg : 0);
+      if (ms <= lim.maxDelayMs) {
+        p->arg = ms;
+        continue;
+      }
+    }
+
+    // STRING a, STRING b  →  STRING ab (no DEFAULT_DELAY between them);
+    // encode() concatenates the joined run
+    bool text = c.op == DOP_STRING || c.op == DOP_STRINGLN;
+    if (!repeated && defaultDelay == 0 && p && p->op == DOP_STRING && text &&
+        runLen + c.arg <= lim.maxLineLen) {
+      p->join = true;
+      runLen += c.arg;
+    } else {
+      runLen = text ? c.arg : 0;
+    }
+    ops[n++] = c;
+  }
+  ops.resize(n);
+}
+
+// ================================================================
+//  Encoding
+// ================================================================
+
+static void putVarint(std::vector<uint8_t> &code, uint32_t v) {
+  while (v >= 0x80) {
+    code.push_back((v & 0x7F) | 0x80);
+    v >>= 7;
+  }
+  code.push_back(v);
+}
+
+static size_t varintSize(uint32_t v) {
+  size_t n = 1;
+  while (v >= 0x80) {
+    v >>= 7;
+    n++;
+  }
+  return n;
+}
+
+static bool getVarint(const uint8_t *code, size_t len, size_t &pos,
+                      uint32_t &v) {
+  v = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (pos >= len)
+      return false;
+    uint8_t b = code[pos++];
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80))
+      return true;
+  }
+  return false;
+}
+
+// Operand bytes of a non-STRING op
+static size_t operandSize(const CompiledOp &op) {
+  switch (op.op) {
+  case DOP_DELAY:
+  case DOP_DEFAULT_DELAY:
+  case DOP_REPEAT:
+    return varintSize(op.arg);
+  case DOP_KEY:
+  case DOP_MOUSE_MOVE:
+    return 2;
+  case DOP_MOUSE_CLICK:
+  case DOP_MOUSE_SCROLL:
+    return 1;
+  case DOP_MOUSE_MOVE_TO:
+    return 4;
+  case DOP_WAIT:
+    return 2 + varintSize(op.arg);
+  case DOP_MOUSE_PATH: {
+    uint8_t interval;
+    uint32_t n = pathPlan(op, interval);
+    return 1 + varintSize(n) + 2 * n;
+  }
+  default:
+    return 0;
+  }
+}
+
+// Copy a module's instructions with their line set to `line`, adding
+// the bytes they take to `bytes`. With `code` null, only count. False
+// if the image is malformed.
+static bool linkModule(const std::vector<uint8_t> &img, uint32_t line,
+                       std::vector<uint8_t> *code, uint32_t &insns,
+                       size_t &bytes) {
+  uint32_t lines, l;
+  size_t pos;
+  if (!duckyCodeHeader(img.data(), img.size(), lines, pos))
+    return false;
+  DuckyInsn in;
+  for (;;) {
+    size_t operands = pos + 1;
+    if (!duckyDecode(img.data(), img.size(), pos, in))
+      return false;
+    if (in.op == DOP_END)
+      return true;
+    getVarint(img.data(), img.size(), operands, l); // skip the old line
+    bytes += 1 + varintSize(line) + (pos - operands);
+    insns++;
+    if (code) {
+      code->push_back(in.op);
+      putVarint(*code, line);
+      code->insert(code->end(), img.begin() + operands, img.begin() + pos);
+    }
+  }
+}
+
+// Last DEFAULT_DELAY a module sets, if any
+static bool moduleDefaultDelay(const std::vector<uint8_t> &img,
+                               uint32_t &ms) {
+  uint32_t lines;
+  size_t pos;
+  bool set = false;
+  if (!duckyCodeHeader(img.data(), img.size(), lines, pos))
+    return false;
+  DuckyInsn in;
+  while (duckyDecode(img.data(), img.size(), pos, in) && in.op != DOP_END) {
+    if (in.op == DOP_DEFAULT_DELAY) {
+      ms = in.arg;
+      set = true;
+    }
+  }
+  return set;
+}
+
+// `insns` gets the number of instructions written. The image is sized
+// exactly up front, so it never holds spare capacity. False if a
+// linked module is malformed.
+static bool encode(const OpList &ops, const char *src, uint32_t lines,
+                   const std::vector<DuckyImage> &modules,
+                   std::vector<uint8_t> &code, uint32_t &insns) {
+  size_t size = 4 + varintSize(lines) + 1;
+  insns = 0;
+  for (size_t i = 0; i < ops.size(); i++) {
+    if (ops[i].op == OP_INCLUDE) {
+      if (!linkModule(*modules[ops[i].arg], ops[i].line, nullptr, insns,
+                      size))
+        return false;
+      continue;
+    }
+    size += 1 + varintSize(ops[i].line);
+    if (ops[i].op != DOP_STRING && ops[i].op != DOP_STRINGLN) {
+      size += operandSize(ops[i]);
+      continue;
+    }
+    uint32_t len = ops[i].arg;
+    while (ops[i].join)
+      len += ops[++i].arg;
+    size += varintSize(len) + len;
+  }
+  code.clear();
+  code.reserve(size);
+  code.insert(code.end(), DUCKY_BYTECODE_MAGIC, DUCKY_BYTECODE_MAGIC + 4);
+  putVarint(code, lines);
+
+  insns = 0;
+  for (size_t i = 0; i < ops.size(); i++, insns++) {
+    const CompiledOp &op = ops[i];
+    if (op.op == OP_INCLUDE) {
+      size_t bytes = 0;
+      linkModule(*modules[op.arg], op.line, &code, insns, bytes);
+      insns--; // the loop counts the INCLUDE itself
+      continue;
+    }
+    if (op.op == DOP_STRING || op.op == DOP_STRINGLN) {
+      // One instruction for the run ops[i..j]: first line, last op
+      size_t j = i;
+      uint32_t len = op.arg;
+      while (ops[j].join)
+        len += ops[++j].arg;
+      code.push_back(ops[j].op);
+      putVarint(code, op.line);
+      putVarint(code, len);
+      for (; i <= j; i++)
+        code.insert(code.end(), src + ops[i].off,
+                    src + ops[i].off + ops[i].arg);
+      i = j;
+      continue;
+    }
+
+    code.push_back(op.op);
+    putVarint(code, op.line);
+    switch (op.op) {
+    case DOP_DELAY:
+    case DOP_DEFAULT_DELAY:
+    case DOP_REPEAT:
+      putVarint(code, op.arg);
+      break;
+    case DOP_KEY:
+    case DOP_MOUSE_MOVE:
+      code.push_back(op.a);
+      code.push_back(op.b);
+      break;
+    case DOP_MOUSE_CLICK:
+    case DOP_MOUSE_SCROLL:
+      code.push_back(op.a);
+      break;
+    case DOP_MOUSE_MOVE_TO:
+      for (int shift = 0; shift < 32; shift += 8)
+        code.push_back((uint8_t)(op.arg >> shift));
+      break;
+    case DOP_WAIT:
+      code.push_back(op.a);
+      code.push_back(op.b);
+      putVarint(code, op.arg);
+      break;
+    case DOP_MOUSE_PATH: {
+      uint8_t interval;
+      uint32_t n = pathPlan(op, interval);
+      code.push_back(interval);
+      putVarint(code, n);
+      putPath(code, op, n);
+      break;
+    }
+    }
+  }
+  code.push_back(DOP_END);
+  return true;
+}
+
+// ================================================================
+//  Public API
+// ================================================================
+
+bool duckyCompile(const char *src, size_t len, std::vector<uint8_t> &code,
+                  DuckyCompileResult &res, bool optimize_,
+                  DuckyIncludeFn include) {
+  res = {false, 0, "", 0, 0, 0, 0, 0, 0};
+  DuckyLimits lim = duckyGetLimits();
+  OpList ops;
+  MouseScreen screen = {MOUSE_SCREEN_W, MOUSE_SCREEN_H};
+  uint32_t lineNo = 0;
+  uint64_t commands = 0;
+  uint32_t weight = 1; // budget one run of the last command takes
+  std::vector<DuckyImage> modules; // INCLUDEd images, by OP_INCLUDE arg
+  bool afterInclude = false;       // no command since the last INCLUDE
+  String line;
+
+  size_t pos = 0;
+  while (pos < len) {
+    const char *nl = (const char *)memchr(src + pos, '\n', len - pos);
+    size_t end = nl ? nl - src : len;
+    res.lines = ++lineNo;
+    if (lineNo > lim.maxLines)
+      return fail(res, 0, "script exceeds the line limit");
+    if (end - pos > lim.maxLineLen)
+      return fail(res, lineNo, "line exceeds the length limit");
+
+    size_t start = pos; // where the trimmed line begins
+    while (start < end && isspace((unsigned char)src[start]))
+      start++;
+    line.remove(0); // keeps its buffer for the next line
+    line.concat(src + start, end - start);
+    line.trim();
+    pos = end + 1;
+
+    if (line.length() == 0 || line.startsWith("REM") || line.startsWith("//"))
+      continue; // skip blanks and comments
+
+    CompiledOp op = {DOP_NOP, false, 0, 0, lineNo, 0, 0};
+
+    // DEFAULT_DELAY / DEFAULTDELAY
+    if (line.startsWith("DEFAULT_DELAY ") || line.startsWith("DEFAULTDELAY ")) {
+      long ms = argNumber(line, line.indexOf(' ') + 1);
+      if (ms < 0 || ms > (long)lim.maxDelayMs)
+        return fail(res, lineNo, "DEFAULT_DELAY out of range");
+      op.op = DOP_DEFAULT_DELAY;
+      op.arg = ms;
+      ops.push_back(op);
+      continue;
+    }
+
+    // MOUSE_SCREEN w h — pixel size for the MOUSE_MOVE_TO lines after it
+    if (line.startsWith("MOUSE_SCREEN ")) {
+      long w, h;
+      if (!argPair(line, 13, w, h) || w < 1 || w > MOUSE_ABS_MAX + 1 ||
+          h < 1 || h > MOUSE_ABS_MAX + 1)
+        return fail(res, lineNo, "MOUSE_SCREEN size out of range");
+      screen = {(uint32_t)w, (uint32_t)h};
+      continue;
+    }
+
+    // INCLUDE <name> — another payload's code, linked in at this line
+    if (line.startsWith("INCLUDE ")) {
+      String name = line.substring(8);
+      name.trim();
+      if (!include)
+        return fail(res, lineNo, "INCLUDE isn't available here");
+      const char *why = "INCLUDE module not found";
+      DuckyImage img = include(name, why);
+      if (!img)
+        return fail(res, lineNo, why);
+      DuckyCompileResult mod;
+      if (!duckyVerify(img->data(), img->size(), mod))
+        return fail(res, lineNo, "INCLUDE module is not a valid image");
+      commands += mod.commands;
+      if (commands > lim.maxCommands)
+        return fail(res, lineNo, "script exceeds the command limit");
+      op.op = OP_INCLUDE;
+      op.arg = modules.size();
+      op.b = moduleDefaultDelay(*img, op.off);
+      modules.push_back(img);
+      ops.push_back(op);
+      afterInclude = true;
+      continue;
+    }
+
+    // REPEAT n — re-runs the previous command n times
+    if (line.startsWith("REPEAT")) {
+      if (afterInclude)
+        return fail(res, lineNo, "REPEAT can't follow INCLUDE");
+      int spaceIdx = line.indexOf(' ');
+      long count = (spaceIdx >= 0) ? argNumber(line, spaceIdx + 1) : 1;
+      if (count < 1)
+        count = 1;
+      if (count > (long)lim.maxRepeat)
+        return fail(res, lineNo, "REPEAT count above the limit");
+      commands += (uint64_t)count * weight;
+      if (commands > lim.maxCommands)
+        return fail(res, lineNo, "script exceeds the command limit");
+      op.op = DOP_REPEAT;
+      op.arg = count;
+      ops.push_back(op);
+      continue;
+    }
+
+    if (const char *err = compileCommand(line, start, op, lim, screen))
+      return fail(res, lineNo, err);
+    afterInclude = false;
+    // A mouse path counts each of its reports
+    uint8_t interval;
+    weight = op.op == DOP_MOUSE_PATH ? pathPlan(op, interval) : 1;
+    commands += weight;
+    if (commands > lim.maxCommands)
+      return fail(res, lineNo, "script exceeds the command limit");
+    if (op.op == DOP_NOP && !res.unknown++)
+      res.unknownLine = lineNo;
+    ops.push_back(op);
+  }
+
+  if (optimize_)
+    optimize(ops, lim);
+  if (!encode(ops, src, lineNo, modules, code, res.insns))
+    return fail(res, 0, "INCLUDE module is not a valid image");
+  res.ok = true;
+  res.lines = lineNo;
+  res.commands = commands;
+  res.includes = modules.size();
+  return true;
+}
+
+bool duckyIsBytecode(const uint8_t *data, size_t len) {
+  return len >= 4 && memcmp(data, DUCKY_BYTECODE_MAGIC, 4) == 0;
+}
+
+bool duckyCodeHeader(const uint8_t *code, size_t len, uint32_t &lines,
+                     size_t &start) {
+  if (!duckyIsBytecode(code, len))
+    return false;
+  start = 4;
+  return getVarint(code, len, start, lines);
+}
+
+bool duckyDecode(const uint8_t *code, size_t len, size_t &pos,
+                 DuckyInsn &in) {
+  if (pos >= len)
+    return false;
+  in = {code[pos++], 0, 0, 0, 0, nullptr};
+  if (in.op == DOP_END)
+    return true;
+  if (in.op >= DOP_COUNT || !getVarint(code, len, pos, in.line))
+    return false;
+
+  switch (in.op) {
+  case DOP_DELAY:
+  case DOP_DEFAULT_DELAY:
+  case DOP_REPEAT:
+    return getVarint(code, len, pos, in.arg);
+  case DOP_STRING:
+  case DOP_STRINGLN:
+    if (!getVarint(code, len, pos, in.arg) || in.arg > len - pos)
+      return false;
+    in.str = (const char *)code + pos;
+    pos += in.arg;
+    return true;
+  case DOP_KEY:
+  case DOP_MOUSE_MOVE:
+    if (len - pos < 2)
+      return false;
+    in.a = code[pos++];
+    in.b = code[pos++];
+    return true;
+  case DOP_MOUSE_CLICK:
+  case DOP_MOUSE_SCROLL:
+    if (len - pos < 1)
+      return false;
+    in.a = code[pos++];
+    return true;
+  case DOP_MOUSE_MOVE_TO:
+    if (len - pos < 4)
+      return false;
+    for (int shift = 0; shift < 32; shift += 8)
+      in.arg |= (uint32_t)code[pos++] << shift;
+    return true;
+  case DOP_MOUSE_PATH:
+    if (len - pos < 1)
+      return false;
+    in.a = code[pos++];
+    if (!getVarint(code, len, pos, in.arg) || in.arg > (len - pos) / 2)
+      return false;
+    in.str = (const char *)code + pos;
+    pos += 2 * in.arg;
+    return true;
+  case DOP_WAIT:
+    if (len - pos < 2)
+      return false;
+    in.a = code[pos++];
+    in.b = code[pos++];
+    return getVarint(code, len, pos, in.arg);
+  default:
+    return true;
+  }
+}
+
+bool duckyVerify(const uint8_t *code, size_t len, DuckyCompileResult &res) {
+  res = {false, 0, "", 0, 0, 0, 0, 0, 0};
+  DuckyLimits lim = duckyGetLimits();
+  uint32_t lines;
+  size_t pos;
+  if (!duckyCodeHeader(code, len, lines, pos))
+    return fail(res, 0, "not a DKB1 image");
+  if (lines > lim.maxLines)
+    return fail(res, 0, "script exceeds the line limit");
+
+  uint32_t lastLine = 0;
+  uint64_t commands = 0;
+  uint32_t weight = 1;
+  DuckyInsn in;
+  while (duckyDecode(code, len, pos, in)) {
+    if (in.op == DOP_END) {
+      if (pos != len)
+        return fail(res, lastLine, "data after the end instruction");
+      res.ok = true;
+      res.lines = lines;
+      res.commands = commands;
+      return true;
+    }
+    if (in.line < lastLine || in.line > lines)
+      return fail(res, in.line, "instruction line out of order");
+    lastLine = in.line;
+    res.insns++;
+    if (in.op == DOP_NOP && !res.unknown++)
+      res.unknownLine = in.line;
+
+    switch (in.op) {
+    case DOP_DELAY:
+    case DOP_DEFAULT_DELAY:
+      if (in.arg > lim.maxDelayMs)
+        return fail(res, in.line, "DELAY out of range");
+      break;
+    case DOP_STRING:
+    case DOP_STRINGLN:
+      if (in.arg > lim.maxLineLen)
+        return fail(res, in.line, "line exceeds the length limit");
+      break;
+    case DOP_MOUSE_CLICK:
+      if (in.a > 2)
+        return fail(res, in.line, "unknown mouse button");
+      break;
+    case DOP_REPEAT:
+      if (in.arg < 1 || in.arg > lim.maxRepeat)
+        return fail(res, in.line, "REPEAT count above the limit");
+      break;
+    case DOP_MOUSE_MOVE_TO:
+      if ((in.arg & 0xFFFF) > MOUSE_ABS_MAX || (in.arg >> 16) > MOUSE_ABS_MAX)
+        return fail(res, in.line, "MOUSE_MOVE_TO outside the screen");
+      break;
+    case DOP_MOUSE_PATH:
+      if (in.arg < 1 || in.arg > MOUSE_PATH_MAX_STEPS || in.a < 1)
+        return fail(res, in.line, "bad mouse path");
+      break;
+    case DOP_WAIT:
+      if (duckyWaitName(in.a, in.b)[0] == '?')
+        return fail(res, in.line, "unknown WAIT_FOR condition");
+      if (in.arg < 1 || in.arg > lim.maxDelayMs)
+        return fail(res, in.line, "WAIT_FOR timeout out of range");
+      break;
+    }
+    if (in.op != DOP_DEFAULT_DELAY) {
+      if (in.op != DOP_REPEAT)
+        weight = in.op == DOP_MOUSE_PATH ? in.arg : 1;
+      commands += (uint64_t)(in.op == DOP_REPEAT ? in.arg : 1) * weight;
+      if (commands > lim.maxCommands)
+        return fail(res, in.line, "script exceeds the command limit");
+    }
+  }
+  return fail(res, lastLine, "truncated or unknown instruction");
+}
+
+// ================================================================
+//  Key & Modifier Resolution (DuckyScript names → HID codes)
+// ================================================================
+
+static uint8_t resolveKey(const String &keyName) {
+  if (keyName == "ENTER" || keyName == "RETURN")
+    return KEY_ENTER;
+  if (keyName == "TAB")
+    return KEY_TAB;
+  if (keyName == "ESCAPE" || keyName == "ESC")
+    return KEY_ESCAPE;
+  if (keyName == "SPACE")
+    return KEY_SPACE;
+  if (keyName == "BACKSPACE" || keyName == "BKSP")
+    return KEY_BACKSPACE;
+  if (keyName == "DELETE" || keyName == "DEL")
+    return KEY_DELETE;
+  if (keyName == "INSERT")
+    return KEY_INSERT;
+  if (keyName == "HOME")
+    return KEY_HOME;
+  if (keyName == "END")
+    return KEY_END;
+  if (keyName == "PAGEUP")
+    return KEY_PAGE_UP;
+  if (keyName == "PAGEDOWN")
+    return KEY_PAGE_DOWN;
+  if (keyName == "UP" || keyName == "UPARROW")
+    return KEY_UP_ARROW;
+  if (keyName == "DOWN" || keyName == "DOWNARROW")
+    return KEY_DOWN_ARROW;
+  if (keyName == "LEFT" || keyName == "LEFTARROW")
+    return KEY_LEFT_ARROW;
+  if (keyName == "RIGHT" || keyName == "RIGHTARROW")
+    return KEY_RIGHT_ARROW;
+  if (keyName == "CAPSLOCK")
+    return KEY_CAPSLOCK;
+  if (keyName == "PRINTSCREEN")
+    return KEY_PRINT_SCREEN;
+  if (keyName == "SCROLLLOCK")
+    return KEY_SCROLL_LOCK;
+  if (keyName == "PAUSE" || keyName == "BREAK")
+    return KEY_PAUSE;
+  if (keyName == "NUMLOCK")
+    return KEY_NUM_LOCK;
+  if (keyName == "MENU" || keyName == "APP")
+    return KEY_MENU;
+
+  // Function keys
+  for (int f = 1; f <= 12; f++) {
+    if (keyName == "F" + String(f))
+      return KEY_F1 + f - 1;
+  }
+
+  // Single letter/digit
+  if (keyName.length() == 1) {
+    KeyMapping km = getKeyMapping(keyName.charAt(0));
+    return km.keycode;
+  }
+
+  return KEY_NONE;
+}
+
+static uint8_t resolveModifier(const String &modName) {
+  if (modName == "GUI" || modName == "WINDOWS" || modName == "SUPER" ||
+      modName == "META")
+    return MOD_LEFT_GUI;
+  if (modName == "CTRL" || modName == "CONTROL")
+    return MOD_LEFT_CTRL;
+  if (modName == "ALT")
+    return MOD_LEFT_ALT;
+  if (modName == "SHIFT")
+    return MOD_LEFT_SHIFT;
+  return MOD_NONE;
+}
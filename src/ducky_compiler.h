@@ -0,0 +1,173 @@
+#pragma once
+
+// ============================================================
+//  DuckyScript Compiler — Source → Bytecode
+// ============================================================
+//
+//  The parser task no longer interprets text: it compiles the
+//  script here, then runs the bytecode. The same sources build
+//  the host `ducky_compile` CLI, so a payload compiled on a
+//  workstation runs exactly as if the device had compiled it,
+//  and POST /api/payloads/<name>/compiled stores it without any
+//  parse work on the device.
+//
+//  Format (all varints LEB128):
+//
+//    "DKB1"                 magic
+//    varint lines           source line count (status reporting)
+//    per instruction:
+//      u8 op | varint line | operands
+//    u8 DOP_END             last byte of the image
+//
+//    DOP_DELAY          varint ms
+//    DOP_DEFAULT_DELAY  varint ms
+//    DOP_STRING         varint len | len bytes
+//    DOP_STRINGLN       varint len | len bytes   (typed, then ENTER)
+//    DOP_KEY            u8 keycode | u8 modifiers
+//    DOP_MOUSE_MOVE     i8 dx | i8 dy
+//    DOP_MOUSE_CLICK    u8 button (0 left, 1 right, 2 middle)
+//    DOP_MOUSE_SCROLL   i8 amount
+//    DOP_REPEAT         varint count   (re-runs the last command)
+//    DOP_NOP            a command that does nothing but still
+//                       takes the DEFAULT_DELAY
+//    DOP_MOUSE_MOVE_TO  u16 x | u16 y  (absolute, 0..MOUSE_ABS_MAX)
+//    DOP_MOUSE_PATH     u8 interval ms | varint n | n × (i8 dx, i8 dy)
+//    DOP_WAIT           u8 DuckyWaitSource | u8 DuckyWaitMode | varint
+//                       timeout ms
+//
+//  Mouse paths are computed here, not on the device: a MOUSE_MOVE
+//  beyond ±127 becomes the fewest full-size reports along the line,
+//  a MOUSE_GLIDE an eased sequence, and the parser only sends them
+//  one per `interval` (the HID poll interval unless the glide is
+//  longer than MOUSE_PATH_MAX_STEPS polls). MOUSE_MOVE_TO pixels
+//  are scaled by the MOUSE_SCREEN size in force at that line.
+//
+//  INCLUDE <name> links another payload in at compile time: the
+//  caller's DuckyIncludeFn hands back that payload's image (on the
+//  device, from the module cache), and its instructions are copied
+//  in place, carrying the INCLUDE line number. As if pasted, a
+//  DEFAULT_DELAY set in a module stays in force after it. REPEAT
+//  can't follow an INCLUDE (which of the module's commands would it
+//  mean?).
+//
+//  WAIT_FOR_CAPS_ON / _OFF / _CHANGE (also NUM, SCROLL) and
+//  WAIT_FOR_BUTTON [timeout ms] block until the host signals instead
+//  of guessing with a DELAY: a lock LED in the host's keyboard output
+//  report, or a press of the WAIT button (DUCKY_WAIT_BUTTON_PIN). A
+//  _CHANGE waits for the LED to differ from its state when the wait
+//  starts; a button wait for a press that starts after it. Past the
+//  timeout (default DUCKY_WAIT_TIMEOUT_MS) the script stops with an
+//  error.
+//
+//  Key names are resolved at compile time. The optimizer only
+//  makes changes that leave the typed text and the script's waits
+//  unchanged: adjacent DELAYs merge, do-nothing lines vanish when
+//  no DEFAULT_DELAY applies, and with no DEFAULT_DELAY adjacent
+//  STRING/STRINGLN lines merge. Nothing merges into a command that
+//  a REPEAT re-runs. Under boot protocol the report stream is
+//  identical; under NKRO a merged STRING run may batch keys across
+//  the old line boundary, so it takes fewer reports and less time
+//  (`STRING ab` + `STRING cd`: 2 reports instead of 4).
+//
+//  Every image — compiled here or uploaded — passes duckyVerify()
+//  before it runs: operands in bounds and within duckyGetLimits().
+//
+// ============================================================
+
+#include <Arduino.h>
+#include <memory>
+#include <vector>
+
+#define DUCKY_BYTECODE_MAGIC "DKB1"
+
+enum DuckyOp : uint8_t {
+  DOP_END = 0,
+  DOP_DELAY,
+  DOP_DEFAULT_DELAY,
+  DOP_STRING,
+  DOP_STRINGLN,
+  DOP_KEY,
+  DOP_MOUSE_MOVE,
+  DOP_MOUSE_CLICK,
+  DOP_MOUSE_SCROLL,
+  DOP_REPEAT,
+  DOP_NOP,
+  DOP_MOUSE_MOVE_TO,
+  DOP_MOUSE_PATH,
+  DOP_WAIT,
+  DOP_COUNT
+};
+
+/// What a DOP_WAIT watches. The lock LEDs are their bit numbers in
+/// the HID LED report (usb_hid.h HID_LED_*).
+enum DuckyWaitSource : uint8_t {
+  DWAIT_NUM_LOCK = 0,
+  DWAIT_CAPS_LOCK,
+  DWAIT_SCROLL_LOCK,
+  DWAIT_BUTTON
+};
+
+/// What ends a DOP_WAIT. The button only waits for DWAIT_ON (pressed).
+enum DuckyWaitMode : uint8_t { DWAIT_OFF = 0, DWAIT_ON, DWAIT_CHANGE };
+
+/// One decoded instruction. `str` points into the image.
+struct DuckyInsn {
+  uint8_t op;
+  uint32_t line;    // 1-based source line
+  uint32_t arg;     // ms, count, string length, path steps or x | y << 16
+  uint8_t a, b;     // keycode/modifiers, dx/dy, button, amount, interval,
+                    // wait source/mode
+  const char *str;  // STRING / STRINGLN text (`arg` bytes, not NUL-ended)
+                    // or MOUSE_PATH steps (`arg` dx/dy pairs)
+};
+
+/// Outcome of duckyCompile() / duckyVerify().
+struct DuckyCompileResult {
+  bool ok;
+  uint32_t errorLine; // 0 = whole script
+  const char *error;  // "" when ok
+  uint32_t lines;     // source lines
+  uint32_t commands;  // commands the script runs, REPEATs expanded
+                      // (a mouse path counts each report)
+  uint32_t insns;     // instructions in the image
+  uint32_t unknown;   // command lines that do nothing (unrecognised)
+  uint32_t unknownLine; // first of them, 0 if none
+  uint32_t includes;  // INCLUDE lines linked in (duckyCompile only)
+};
+
+/// A compiled image shared between its users (module cache, compiles
+/// linking it in).
+typedef std::shared_ptr<const std::vector<uint8_t>> DuckyImage;
+
+/// Resolves INCLUDE <name> to a verified image. Returns nullptr and
+/// sets `error` if the module can't be had.
+typedef DuckyImage (*DuckyIncludeFn)(const String &name, const char *&error);
+
+/// Compile DuckyScript source to bytecode, checked against
+/// duckyGetLimits(). `optimize` = false keeps one instruction per
+/// command line. Without `include`, INCLUDE lines are an error.
+bool duckyCompile(const char *src, size_t len, std::vector<uint8_t> &code,
+                  DuckyCompileResult &res, bool optimize = true,
+                  DuckyIncludeFn include = nullptr);
+
+/// True if `data` starts with the bytecode magic.
+bool duckyIsBytecode(const uint8_t *data, size_t len);
+
+/// Check an image end to end before running it.
+bool duckyVerify(const uint8_t *code, size_t len, DuckyCompileResult &res);
+
+/// Read the header: source line count and the offset of the first
+/// instruction. False if the magic or the varint is bad.
+bool duckyCodeHeader(const uint8_t *code, size_t len, uint32_t &lines,
+                     size_t &start);
+
+/// Decode the instruction at `pos` and advance past it. False on a
+/// truncated or unknown instruction.
+bool duckyDecode(const uint8_t *code, size_t len, size_t &pos,
+                 DuckyInsn &in);
+
+/// Mnemonic for an opcode ("DELAY", "KEY", ...).
+const char *duckyOpName(uint8_t op);
+
+/// Command of a DOP_WAIT ("WAIT_FOR_CAPS_ON", ...), "?" if invalid.
+const char *duckyWaitName(uint8_t source, uint8_t mode);
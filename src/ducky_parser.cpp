@@ -3,12 +3,19 @@
 // ============================================================
 
 #include "ducky_parser.h"
+#include "arena.h"
 #include "config.h"
+#include "ducky_compiler.h"
 #include "keyboard_layout.h"
+#include "module_cache.h"
+#include "payload_cache.h"
+#include "profiler.h"
+#include "status_events.h"
+#include "storage_manager.h"
+#include "task_placement.h"
 #include "usb_hid.h"
 
-
-#include <LittleFS.h>
+#include <atomic>
 #include <vector>
 
 // --- Internal state (protected by mutex) ---
@@ -17,22 +24,64 @@ static TaskHandle_t sTaskHandle = nullptr;
 static volatile DuckyStatus sStatus = DuckyStatus::IDLE;
 static volatile bool sAbort = false;
 static String sScript;
-static DuckyCallback sCallback = nullptr;
+static std::vector<uint8_t> sImage; // compiled sScript, for one run
+static String sCacheName;    // payload the script came from ("" = none)
+static uint32_t sCacheHash;  // its content hash, to cache the image
+static uint32_t sRun = 0; // run number of the current script (status events)
+static char sError[96] = "";
+// WAIT_FOR_*: given on every LED report, button edge and duckyStop()
+static SemaphoreHandle_t sWake = nullptr;
+
+// --- Complexity limits (duckySetLimits) ---
+static DuckyLimits sLimits = {DUCKY_MAX_LINE_LEN, DUCKY_MAX_LINES,
+                              DUCKY_MAX_REPEAT, DUCKY_MAX_COMMANDS,
+                              DUCKY_MAX_DELAY_MS};
+
+// --- Counters (duckyGetStats) ---
+static std::atomic<uint32_t> sScripts{0};
+static std::atomic<uint32_t> sLinesExecuted{0};
+static std::atomic<uint32_t> sLinesPending{0};
+static std::atomic<uint32_t> sAborts{0};
+static std::atomic<uint32_t> sAbortRequestUs{0};
+static std::atomic<uint32_t> sAbortLatencyUs{0};
+static std::atomic<uint32_t> sAbortLatencyMaxUs{0};
+static std::atomic<uint32_t> sStackFreeMin{0};
+static std::atomic<uint32_t> sLimitErrors{0};
+static std::atomic<uint32_t> sWaits{0};
+static std::atomic<uint32_t> sWaitTimeouts{0};
+static std::atomic<uint32_t> sWaitLastMs{0};
 
 // --- Forward declarations ---
+static void onWaitLeds(uint8_t leds);
+static void onWaitButton();
 static void parserTask(void *param);
-static void executeLine(const String &line, int defaultDelay, String &lastLine);
-static uint8_t resolveKey(const String &keyName);
-static uint8_t resolveModifier(const String &modName);
 static void reportStatus(int line, int total, DuckyStatus st);
+static bool startRun(const String &script, DuckyCallback cb,
+                     const String &cacheName, uint32_t cacheHash);
 
 // ================================================================
 //  Public API
 // ================================================================
 
-void duckyInit() { sMutex = xSemaphoreCreateMutex(); }
+void duckyInit() {
+  sMutex = xSemaphoreCreateMutex();
+  sWake = xSemaphoreCreateBinary();
+  hidOnLeds(onWaitLeds);
+  attachInterrupt(digitalPinToInterrupt(DUCKY_WAIT_BUTTON_PIN), onWaitButton,
+                  CHANGE);
+  arenaInit();
+  statusInit();
+  moduleCacheInit();
+}
 
 bool duckyExecute(const String &script, DuckyCallback cb) {
+  return startRun(script, cb, String(), 0);
+}
+
+// `cacheName` names the payload `script` was read from, so the task
+// can keep its compiled image (payload_cache.h)
+static bool startRun(const String &script, DuckyCallback cb,
+                     const String &cacheName, uint32_t cacheHash) {
   if (xSemaphoreTake(sMutex, pdMS_TO_TICKS(100)) != pdTRUE)
     return false;
 
@@ -42,8 +91,13 @@ bool duckyExecute(const String &script, DuckyCallback cb) {
   }
 
   sScript = script;
-  sCallback = cb;
+  sCacheName = cacheName;
+  sCacheHash = cacheHash;
   sAbort = false;
+  sAbortRequestUs = 0;
+  sError[0] = 0;
+  sRun = ++sScripts;
+  statusBeginRun(sRun, cb);
   sStatus = DuckyStatus::RUNNING;
   xSemaphoreGive(sMutex);
 
@@ -53,376 +107,460 @@ bool duckyExecute(const String &script, DuckyCallback cb) {
     sTaskHandle = nullptr;
   }
 
-  xTaskCreatePinnedToCore(parserTask, "DuckyParser", PARSER_TASK_STACK, nullptr,
-                          PARSER_TASK_PRIO, &sTaskHandle, PARSER_TASK_CORE);
+  placementSpawn(TASK_ROLE_PARSER, parserTask, "DuckyParser",
+                 PARSER_TASK_STACK, &sTaskHandle);
 
   return true;
 }
 
 bool duckyExecuteFile(const String &filePath, DuckyCallback cb) {
-  File f = LittleFS.open(filePath, "r");
-  if (!f)
+  String dir = String(PAYLOAD_DIR) + "/";
+  String name = filePath.startsWith(dir) ? filePath.substring(dir.length())
+                                         : String();
+  String content;
+  if (isValidPayloadName(name)) {
+    // Hot payload: its compiled image, or at least its source, from PSRAM
+    if (payloadCacheGetImage(name, content))
+      return duckyExecute(content, cb);
+    content = readPayload(name);
+    if (content.isEmpty() && payloadSize(name) != 0)
+      return false; // missing
+    uint32_t hash = contentHash((const uint8_t *)content.c_str(),
+                                content.length());
+    return startRun(content, cb, name, hash);
+  }
+
+  // Decompresses on the fly if the payload was stored compressed
+  PayloadReader r;
+  if (!r.openFile(filePath))
     return false;
-  String content = f.readString();
-  f.close();
+  content.reserve(r.size());
+  uint8_t buf[256];
+  size_t n;
+  while ((n = r.read(buf, sizeof(buf))) > 0) {
+    content.concat((const char *)buf, n);
+  }
+  r.close();
   return duckyExecute(content, cb);
 }
 
-void duckyStop() { sAbort = true; }
+void duckyStop() {
+  if (sStatus == DuckyStatus::RUNNING && !sAbort)
+    sAbortRequestUs = micros() | 1; // 0 means "no request"
+  sAbort = true;
+  if (sWake)
+    xSemaphoreGive(sWake); // end a WAIT_FOR now
+}
 
 bool duckyIsRunning() { return sStatus == DuckyStatus::RUNNING; }
 
 DuckyStatus duckyGetStatus() { return sStatus; }
 
+const char *duckyStatusName(DuckyStatus st) {
+  switch (st) {
+  case DuckyStatus::IDLE:
+    return "idle";
+  case DuckyStatus::RUNNING:
+    return "running";
+  case DuckyStatus::PAUSED:
+    return "paused";
+  case DuckyStatus::FINISHED:
+    return "finished";
+  case DuckyStatus::ERROR:
+    return "error";
+  case DuckyStatus::ABORTED:
+    return "aborted";
+  }
+  return "unknown";
+}
+
+const char *duckyLastError() { return sError; }
+
+void duckySetLimits(const DuckyLimits &limits) {
+  sLimits = limits;
+  payloadCacheDropImages(); // compiled against the old limits
+}
+
+DuckyLimits duckyGetLimits() { return sLimits; }
+
+DuckyStats duckyGetStats() {
+  DuckyStats st;
+  st.scripts = sScripts;
+  st.linesExecuted = sLinesExecuted;
+  st.linesPending = sLinesPending;
+  st.aborts = sAborts;
+  st.abortLatencyUs = sAbortLatencyUs;
+  st.abortLatencyMaxUs = sAbortLatencyMaxUs;
+  st.stackFreeMin = sStackFreeMin;
+  st.limitErrors = sLimitErrors;
+  st.waits = sWaits;
+  st.waitTimeouts = sWaitTimeouts;
+  st.waitLastMs = sWaitLastMs;
+  return st;
+}
+
 // ================================================================
-//  FreeRTOS Task — runs the script line-by-line
+//  FreeRTOS Task — compiles the script, then runs the bytecode
 // ================================================================
 
-static void parserTask(void *param) {
-  // Split script into lines
-  std::vector<String> lines;
-  int start = 0;
-  int idx;
-  while ((idx = sScript.indexOf('\n', start)) != -1) {
-    lines.push_back(sScript.substring(start, idx));
-    start = idx + 1;
-  }
-  if (start < (int)sScript.length()) {
-    lines.push_back(sScript.substring(start));
+// Counters updated as the task ends (finished or aborted)
+static void recordTaskEnd(bool aborted) {
+  sLinesPending = 0;
+  uint32_t stackFree = uxTaskGetStackHighWaterMark(nullptr);
+  if (sStackFreeMin == 0 || stackFree < sStackFreeMin)
+    sStackFreeMin = stackFree;
+  uint32_t requested = sAbortRequestUs;
+  if (aborted && requested) {
+    uint32_t latency = micros() - requested;
+    sAborts++;
+    sAbortLatencyUs = latency;
+    if (latency > sAbortLatencyMaxUs)
+      sAbortLatencyMaxUs = latency;
   }
+}
 
-  int totalLines = lines.size();
-  int defaultDelay = DEFAULT_CMD_DELAY;
-  String lastLine = "";
+// Stop the task: release keys, record counters, report `st`
+static void endTask(DuckyStatus st, int line, int total) {
+  releaseAllKeys();
+  hidRelease();
+  recordTaskEnd(st == DuckyStatus::ABORTED);
+  // vTaskDelete() of ourselves never returns and nothing on this stack
+  // is destroyed: release the run's memory before the next run can start
+  // (the image, and the script: uploaded bytecode runs from it)
+  std::vector<uint8_t>().swap(sImage);
+  sScript = String();
+  sCacheName = String();
+  arenaEnd();
+  sStatus = st;
+  reportStatus(line, total, st);
+  sTaskHandle = nullptr;
+  vTaskDelete(nullptr);
+}
 
-  reportStatus(0, totalLines, DuckyStatus::RUNNING);
+// A script broke a limit or had a bad argument: record why, then stop
+static void failTask(int line, int total, const char *why) {
+  snprintf(sError, sizeof(sError), "line %d: %s", line, why);
+  sLimitErrors++;
+  endTask(DuckyStatus::ERROR, line, total);
+}
 
-  for (int i = 0; i < totalLines; i++) {
-    // Check abort flag
-    if (sAbort) {
-      releaseAllKeys();
-      sStatus = DuckyStatus::ABORTED;
-      reportStatus(i, totalLines, DuckyStatus::ABORTED);
-      sTaskHandle = nullptr;
-      vTaskDelete(nullptr);
-      return;
-    }
+// Sleep in slices so a long DELAY still honours duckyStop()
+static void waitMs(uint32_t ms) {
+  while (ms > 0 && !sAbort) {
+    uint32_t step = ms < DUCKY_ABORT_POLL_MS ? ms : DUCKY_ABORT_POLL_MS;
+    vTaskDelay(pdMS_TO_TICKS(step));
+    ms -= step;
+  }
+}
 
-    String line = lines[i];
-    line.trim();
+// True while WAIT_FOR `source` sees its signal: the lock LED lit in
+// the host's last LED report, or the button held (active LOW)
+static bool waitSignal(uint8_t source) {
+  if (source == DWAIT_BUTTON)
+    return digitalRead(DUCKY_WAIT_BUTTON_PIN) == LOW;
+  return hidLeds() & (1 << source);
+}
 
-    if (line.length() == 0 || line.startsWith("REM") || line.startsWith("//")) {
-      continue; // skip blanks and comments
-    }
+static void onWaitLeds(uint8_t) { xSemaphoreGive(sWake); }
 
-    // Handle DEFAULT_DELAY / DEFAULTDELAY
-    if (line.startsWith("DEFAULT_DELAY ") || line.startsWith("DEFAULTDELAY ")) {
-      int spaceIdx = line.indexOf(' ');
-      defaultDelay = line.substring(spaceIdx + 1).toInt();
-      continue;
-    }
+static void IRAM_ATTR onWaitButton() {
+  BaseType_t woken = pdFALSE;
+  xSemaphoreGiveFromISR(sWake, &woken);
+  if (woken)
+    portYIELD_FROM_ISR();
+}
 
-    // Handle REPEAT
-    if (line.startsWith("REPEAT")) {
-      int spaceIdx = line.indexOf(' ');
-      int count = (spaceIdx >= 0) ? line.substring(spaceIdx + 1).toInt() : 1;
-      if (count < 1)
-        count = 1;
-      for (int r = 0; r < count && !sAbort; r++) {
-        String dummy;
-        executeLine(lastLine, 0, dummy);
-      }
-      reportStatus(i + 1, totalLines, DuckyStatus::RUNNING);
-      continue;
+// Block until the host signals. The task sleeps on sWake between
+// checks, so it wakes on the LED report or button edge itself, not
+// on a poll. False on timeout; an abort ends the wait early and the
+// run loop stops the script.
+static bool waitForHost(uint8_t source, uint8_t mode, uint32_t timeoutMs) {
+  uint32_t start = millis();
+  xSemaphoreTake(sWake, 0); // a signal from before the wait is stale
+  bool initial = waitSignal(source);
+  bool released = !initial; // the button: a press that starts now
+  for (;;) {
+    bool on = waitSignal(source);
+    bool ready;
+    if (source == DWAIT_BUTTON) {
+      released |= !on;
+      ready = released && on;
+    } else {
+      ready = mode == DWAIT_CHANGE ? on != initial : on == (mode == DWAIT_ON);
     }
-
-    executeLine(line, defaultDelay, lastLine);
-    lastLine = line;
-
-    reportStatus(i + 1, totalLines, DuckyStatus::RUNNING);
-
-    // Inter-command delay (non-blocking to other tasks)
-    if (defaultDelay > 0) {
-      vTaskDelay(pdMS_TO_TICKS(defaultDelay));
+    uint32_t elapsed = millis() - start;
+    if (ready) {
+      sWaits++;
+      sWaitLastMs = elapsed;
+      return true;
     }
+    if (sAbort)
+      return true;
+    if (elapsed >= timeoutMs) {
+      sWaitTimeouts++;
+      return false;
+    }
+    xSemaphoreTake(sWake, pdMS_TO_TICKS(timeoutMs - elapsed));
   }
+}
 
-  releaseAllKeys();
-  sStatus = DuckyStatus::FINISHED;
-  reportStatus(totalLines, totalLines, DuckyStatus::FINISHED);
-  sTaskHandle = nullptr;
-  vTaskDelete(nullptr);
+static void runBytecode(const uint8_t *code, size_t len);
+
+// Uploaded bytecode runs as-is; source is compiled into `compiled`.
+// Either way the image is verified before the first command runs.
+static bool loadImage(const String &script, std::vector<uint8_t> &compiled,
+                      const uint8_t *&code, size_t &len,
+                      DuckyCompileResult &res) {
+  code = (const uint8_t *)script.c_str();
+  len = script.length();
+  if (duckyIsBytecode(code, len))
+    return duckyVerify(code, len, res);
+  if (!duckyCompile(script.c_str(), len, compiled, res, true, moduleResolve))
+    return false;
+  code = compiled.data();
+  len = compiled.size();
+  return true;
+}
+
+static void parserTask(void *param) {
+  // The run owns the HID output until endTask(); a live event or
+  // contention report in flight finishes first
+  hidAcquire(HID_WAIT_FOREVER);
+  arenaBegin(ARENA_JOB); // the compiler's scratch, until endTask()
+  DuckyCompileResult res;
+  std::vector<uint8_t> &compiled = sImage;
+  const uint8_t *code;
+  size_t len;
+  compiled.clear();
+  if (!loadImage(sScript, compiled, code, len, res)) {
+    failTask(res.errorLine, res.lines, res.error);
+    return;
+  }
+  // Next run of this payload skips the compile (unless it links
+  // modules, which may change on their own)
+  if (!compiled.empty() && !res.includes && sCacheName.length())
+    payloadCachePutImage(sCacheName, sCacheHash, compiled.data(),
+                         compiled.size());
+  if (!compiled.empty())
+    sScript = String(); // the source isn't needed any more
+  runBytecode(code, len);
 }
 
 // ================================================================
 //  Command Execution
 // ================================================================
 
-static void executeLine(const String &line, int defaultDelay,
-                        String &lastLine) {
-  // --- DELAY ---
-  if (line.startsWith("DELAY ")) {
-    int ms = line.substring(6).toInt();
-    vTaskDelay(pdMS_TO_TICKS(ms));
-    return;
+// The parser task's HID backend: the real device, abortable DELAYs
+struct DeviceHid {
+  void typeString(const char *text, size_t len) {
+    String s;
+    s.concat(text, len);
+    ::typeString(s);
+  }
+  void pressKey(uint8_t keycode, uint8_t modifier) {
+    ::pressKey(keycode, modifier);
+  }
+  void mouseMove(int8_t dx, int8_t dy) { ::mouseMove(dx, dy); }
+  void mousePath(const int8_t *steps, size_t n, uint8_t intervalMs) {
+    ::mousePath(steps, n, intervalMs);
+  }
+  void mouseMoveTo(uint16_t x, uint16_t y) { ::mouseMoveTo(x, y); }
+  void mouseClick(uint8_t button) { ::mouseClick(button); }
+  void mouseScroll(int8_t amount) { ::mouseScroll(amount); }
+  void wait(uint32_t ms) { waitMs(ms); }
+  bool waitFor(uint8_t source, uint8_t mode, uint32_t timeoutMs) {
+    return waitForHost(source, mode, timeoutMs);
+  }
+};
+
+// Run one instruction on `hid` (DeviceHid, or HidDryRun for analysis).
+// False if it was a WAIT_FOR that timed out.
+template <class Hid> static bool execInsn(Hid &hid, const DuckyInsn &in) {
+  switch (in.op) {
+  case DOP_DELAY:
+    hid.wait(in.arg);
+    break;
+  case DOP_STRING:
+  case DOP_STRINGLN:
+    hid.typeString(in.str, in.arg);
+    if (in.op == DOP_STRINGLN)
+      hid.pressKey(KEY_ENTER, 0);
+    break;
+  case DOP_KEY:
+    hid.pressKey(in.a, in.b);
+    break;
+  case DOP_MOUSE_MOVE:
+    hid.mouseMove((int8_t)in.a, (int8_t)in.b);
+    break;
+  case DOP_MOUSE_CLICK:
+    hid.mouseClick(in.a);
+    break;
+  case DOP_MOUSE_SCROLL:
+    hid.mouseScroll((int8_t)in.a);
+    break;
+  case DOP_MOUSE_MOVE_TO:
+    hid.mouseMoveTo(in.arg & 0xFFFF, in.arg >> 16);
+    break;
+  case DOP_MOUSE_PATH:
+    hid.mousePath((const int8_t *)in.str, in.arg, in.a);
+    break;
+  case DOP_WAIT:
+    return hid.waitFor(in.a, in.b, in.arg);
   }
+  return true;
+}
 
-  // --- STRING ---
-  if (line.startsWith("STRING ")) {
-    typeString(line.substring(7));
-    return;
-  }
-  if (line.startsWith("STRINGLN ")) {
-    typeString(line.substring(9));
-    pressKey(KEY_ENTER);
-    return;
-  }
+// A WAIT_FOR ran out of time: the host never signalled
+static void waitTimedOut(const DuckyInsn &in, int total) {
+  snprintf(sError, sizeof(sError), "line %u: %s timed out after %u ms",
+           (unsigned)in.line, duckyWaitName(in.a, in.b), (unsigned)in.arg);
+  endTask(DuckyStatus::ERROR, in.line, total);
+}
 
-  // --- MOUSE commands ---
-  if (line.startsWith("MOUSE_MOVE ")) {
-    String args = line.substring(11);
-    int spaceIdx = args.indexOf(' ');
-    if (spaceIdx > 0) {
-      int8_t dx = (int8_t)args.substring(0, spaceIdx).toInt();
-      int8_t dy = (int8_t)args.substring(spaceIdx + 1).toInt();
-      mouseMove(dx, dy);
-    }
-    return;
-  }
-  if (line.startsWith("MOUSE_CLICK")) {
-    String arg = line.substring(11);
-    arg.trim();
-    if (arg.equalsIgnoreCase("RIGHT"))
-      mouseClick(1);
-    else if (arg.equalsIgnoreCase("MIDDLE"))
-      mouseClick(2);
-    else
-      mouseClick(0);
-    return;
-  }
-  if (line.startsWith("MOUSE_SCROLL ")) {
-    int8_t amount = (int8_t)line.substring(13).toInt();
-    mouseScroll(amount);
-    return;
-  }
+// Run a verified image instruction by instruction
+static void runBytecode(const uint8_t *code, size_t len) {
+  uint32_t lines = 0;
+  size_t pos = 0;
+  duckyCodeHeader(code, len, lines, pos);
+  int totalLines = lines;
 
-  // --- Single keys ---
-  if (line == "ENTER" || line == "RETURN") {
-    pressKey(KEY_ENTER);
-    return;
-  }
-  if (line == "TAB") {
-    pressKey(KEY_TAB);
-    return;
-  }
-  if (line == "ESCAPE" || line == "ESC") {
-    pressKey(KEY_ESCAPE);
-    return;
-  }
-  if (line == "SPACE") {
-    pressKey(KEY_SPACE);
-    return;
-  }
-  if (line == "BACKSPACE" || line == "BKSP") {
-    pressKey(KEY_BACKSPACE);
-    return;
-  }
-  if (line == "DELETE" || line == "DEL") {
-    pressKey(KEY_DELETE);
-    return;
-  }
-  if (line == "INSERT") {
-    pressKey(KEY_INSERT);
-    return;
-  }
-  if (line == "HOME") {
-    pressKey(KEY_HOME);
-    return;
-  }
-  if (line == "END") {
-    pressKey(KEY_END);
-    return;
-  }
-  if (line == "PAGEUP") {
-    pressKey(KEY_PAGE_UP);
-    return;
-  }
-  if (line == "PAGEDOWN") {
-    pressKey(KEY_PAGE_DOWN);
-    return;
-  }
-  if (line == "UP" || line == "UPARROW") {
-    pressKey(KEY_UP_ARROW);
-    return;
-  }
-  if (line == "DOWN" || line == "DOWNARROW") {
-    pressKey(KEY_DOWN_ARROW);
-    return;
-  }
-  if (line == "LEFT" || line == "LEFTARROW") {
-    pressKey(KEY_LEFT_ARROW);
-    return;
-  }
-  if (line == "RIGHT" || line == "RIGHTARROW") {
-    pressKey(KEY_RIGHT_ARROW);
-    return;
-  }
-  if (line == "CAPSLOCK") {
-    pressKey(KEY_CAPSLOCK);
-    return;
-  }
-  if (line == "PRINTSCREEN") {
-    pressKey(KEY_PRINT_SCREEN);
-    return;
-  }
-  if (line == "SCROLLLOCK") {
-    pressKey(KEY_SCROLL_LOCK);
-    return;
-  }
-  if (line == "PAUSE" || line == "BREAK") {
-    pressKey(KEY_PAUSE);
-    return;
-  }
-  if (line == "NUMLOCK") {
-    pressKey(KEY_NUM_LOCK);
-    return;
-  }
-  if (line == "MENU" || line == "APP") {
-    pressKey(KEY_MENU);
-    return;
-  }
+  DeviceHid hid;
+  uint32_t defaultDelay = DEFAULT_CMD_DELAY;
+  DuckyInsn last = {DOP_NOP, 0, 0, 0, 0, nullptr}; // what REPEAT re-runs
+  const bool profile = profilerBeginRun();
+  uint32_t t0 = 0, r0 = 0;
+
+  reportStatus(0, totalLines, DuckyStatus::RUNNING);
 
-  // --- Function keys ---
-  for (int f = 1; f <= 12; f++) {
-    if (line == "F" + String(f)) {
-      pressKey(KEY_F1 + f - 1);
+  DuckyInsn in;
+  while (duckyDecode(code, len, pos, in) && in.op != DOP_END) {
+    // Check abort flag
+    sLinesPending = totalLines - in.line + 1;
+    if (sAbort) {
+      endTask(DuckyStatus::ABORTED, in.line - 1, totalLines);
       return;
     }
-  }
 
-  // --- Modifier combos: GUI/WINDOWS, CTRL, ALT, SHIFT + key ---
-  // Supports:  GUI r   |   CTRL ALT DELETE   |   SHIFT TAB   etc.
-  uint8_t modMask = 0;
-  String remaining = line;
-
-  // Parse modifier tokens from the front
-  while (remaining.length() > 0) {
-    String token;
-    int spaceIdx = remaining.indexOf(' ');
-    if (spaceIdx >= 0) {
-      token = remaining.substring(0, spaceIdx);
-      remaining = remaining.substring(spaceIdx + 1);
-      remaining.trim();
-    } else {
-      token = remaining;
-      remaining = "";
+    if (in.op == DOP_DEFAULT_DELAY) {
+      defaultDelay = in.arg;
+      continue;
     }
 
-    uint8_t mod = resolveModifier(token);
-    if (mod != MOD_NONE) {
-      modMask |= mod;
-    } else {
-      // This token is the final key
-      uint8_t key = resolveKey(token);
-      if (key != KEY_NONE) {
-        pressKey(key, modMask);
-      } else if (token.length() == 1) {
-        // Single character — type it with modifiers
-        KeyMapping km = getKeyMapping(token.charAt(0));
-        pressKey(km.keycode, modMask | km.modifier);
+    if (profile) {
+      t0 = micros();
+      r0 = hidGetStats().reports;
+    }
+    if (in.op == DOP_REPEAT) {
+      for (uint32_t r = 0; r < in.arg && !sAbort; r++) {
+        if (!execInsn(hid, last)) {
+          waitTimedOut(last, totalLines);
+          return;
+        }
+        sLinesExecuted++;
       }
+      if (profile)
+        profilerRecord(in.line, "REPEAT", t0, micros() - t0,
+                       hidGetStats().reports - r0);
+      reportStatus(in.line, totalLines, DuckyStatus::RUNNING);
+      continue;
+    }
+
+    if (!execInsn(hid, in)) {
+      waitTimedOut(in, totalLines);
       return;
     }
-  }
+    sLinesExecuted++;
+    last = in;
+    if (profile)
+      profilerRecord(in.line, duckyOpName(in.op), t0, micros() - t0,
+                     hidGetStats().reports - r0);
 
-  // If we only got modifiers with no final key (e.g. "GUI" alone)
-  if (modMask != 0) {
-    pressKey(KEY_NONE, modMask);
+    reportStatus(in.line, totalLines, DuckyStatus::RUNNING);
+
+    // Inter-command delay (non-blocking to other tasks)
+    if (defaultDelay > 0) {
+      if (profile)
+        t0 = micros();
+      waitMs(defaultDelay);
+      if (profile)
+        profilerRecord(in.line, "DEFAULT_DELAY", t0, micros() - t0, 0);
+    }
   }
+
+  endTask(DuckyStatus::FINISHED, totalLines, totalLines);
 }
 
 // ================================================================
-//  Key & Modifier Resolution (DuckyScript names → HID codes)
+//  Dry Run
 // ================================================================
 
-static uint8_t resolveKey(const String &keyName) {
-  if (keyName == "ENTER" || keyName == "RETURN")
-    return KEY_ENTER;
-  if (keyName == "TAB")
-    return KEY_TAB;
-  if (keyName == "ESCAPE" || keyName == "ESC")
-    return KEY_ESCAPE;
-  if (keyName == "SPACE")
-    return KEY_SPACE;
-  if (keyName == "BACKSPACE" || keyName == "BKSP")
-    return KEY_BACKSPACE;
-  if (keyName == "DELETE" || keyName == "DEL")
-    return KEY_DELETE;
-  if (keyName == "INSERT")
-    return KEY_INSERT;
-  if (keyName == "HOME")
-    return KEY_HOME;
-  if (keyName == "END")
-    return KEY_END;
-  if (keyName == "PAGEUP")
-    return KEY_PAGE_UP;
-  if (keyName == "PAGEDOWN")
-    return KEY_PAGE_DOWN;
-  if (keyName == "UP" || keyName == "UPARROW")
-    return KEY_UP_ARROW;
-  if (keyName == "DOWN" || keyName == "DOWNARROW")
-    return KEY_DOWN_ARROW;
-  if (keyName == "LEFT" || keyName == "LEFTARROW")
-    return KEY_LEFT_ARROW;
-  if (keyName == "RIGHT" || keyName == "RIGHTARROW")
-    return KEY_RIGHT_ARROW;
-  if (keyName == "CAPSLOCK")
-    return KEY_CAPSLOCK;
-  if (keyName == "PRINTSCREEN")
-    return KEY_PRINT_SCREEN;
-  if (keyName == "SCROLLLOCK")
-    return KEY_SCROLL_LOCK;
-  if (keyName == "PAUSE" || keyName == "BREAK")
-    return KEY_PAUSE;
-  if (keyName == "NUMLOCK")
-    return KEY_NUM_LOCK;
-  if (keyName == "MENU" || keyName == "APP")
-    return KEY_MENU;
-
-  // Function keys
-  for (int f = 1; f <= 12; f++) {
-    if (keyName == "F" + String(f))
-      return KEY_F1 + f - 1;
-  }
+bool duckyAnalyze(const String &script, DuckyAnalysis &a) {
+  memset(&a, 0, sizeof(a));
+  std::vector<uint8_t> compiled;
+  const uint8_t *code;
+  size_t len;
+  if (!loadImage(script, compiled, code, len, a.compile))
+    return false;
 
-  // Single letter/digit
-  if (keyName.length() == 1) {
-    KeyMapping km = getKeyMapping(keyName.charAt(0));
-    return km.keycode;
-  }
+  uint32_t lines;
+  size_t pos;
+  duckyCodeHeader(code, len, lines, pos);
+
+  // Same walk as runBytecode(), but a REPEAT multiplies the cost of
+  // the command it re-runs instead of running it again
+  HidDryRun hid;
+  uint32_t defaultDelay = DEFAULT_CMD_DELAY;
+  DuckyInsn last = {DOP_NOP, 0, 0, 0, 0, nullptr};
+  DuckyOpCost lastCost = {1, 0, 0};
+  DuckyInsn in;
+  while (duckyDecode(code, len, pos, in) && in.op != DOP_END) {
+    if (in.op == DOP_DEFAULT_DELAY) {
+      defaultDelay = in.arg;
+      continue;
+    }
+    if (in.op == DOP_REPEAT) {
+      DuckyOpCost &c = a.byOp[last.op];
+      c.count += in.arg;
+      c.reports += lastCost.reports * in.arg;
+      c.us += lastCost.us * in.arg;
+      hid.reports += lastCost.reports * in.arg;
+      hid.us += lastCost.us * in.arg;
+      if (last.op == DOP_WAIT)
+        a.waitMaxUs += last.arg * 1000ULL * in.arg;
+      continue;
+    }
 
-  return KEY_NONE;
-}
+    uint32_t r0 = hid.reports;
+    uint64_t t0 = hid.us;
+    execInsn(hid, in);
+    if (in.op == DOP_WAIT)
+      a.waitMaxUs += in.arg * 1000ULL;
+    lastCost = {1, hid.reports - r0, hid.us - t0};
+    last = in;
+    DuckyOpCost &c = a.byOp[in.op];
+    c.count++;
+    c.reports += lastCost.reports;
+    c.us += lastCost.us;
+
+    if (defaultDelay > 0) {
+      hid.wait(defaultDelay);
+      a.byOp[DOP_DEFAULT_DELAY].count++;
+      a.byOp[DOP_DEFAULT_DELAY].us += defaultDelay * 1000ULL;
+    }
+  }
 
-static uint8_t resolveModifier(const String &modName) {
-  if (modName == "GUI" || modName == "WINDOWS" || modName == "SUPER" ||
-      modName == "META")
-    return MOD_LEFT_GUI;
-  if (modName == "CTRL" || modName == "CONTROL")
-    return MOD_LEFT_CTRL;
-  if (modName == "ALT")
-    return MOD_LEFT_ALT;
-  if (modName == "SHIFT")
-    return MOD_LEFT_SHIFT;
-  return MOD_NONE;
+  hid.releaseAllKeys(); // as endTask() does
+  a.totalUs = hid.us;
+  a.reports = hid.reports;
+  return true;
 }
 
 // ================================================================
 //  Status Reporting
 // ================================================================
 
+// Queued for the status task (status_events.h); never waits on the
+// callback or subscribers
 static void reportStatus(int line, int total, DuckyStatus st) {
-  if (sCallback) {
-    sCallback(line, total, st);
-  }
+  statusPublish(sRun, line, total, st);
 }
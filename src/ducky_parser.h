@@ -4,19 +4,23 @@
 //  DuckyScript Parser — Non-blocking FreeRTOS-based Interpreter
 // ============================================================
 
+#include "ducky_compiler.h"
+
 #include <Arduino.h>
 #include <functional>
 
 /// Execution status reported via callback
 enum class DuckyStatus { IDLE, RUNNING, PAUSED, FINISHED, ERROR, ABORTED };
 
-/// Callback: (currentLine, totalLines, status)
+/// Callback: (currentLine, totalLines, status). Runs on the status
+/// task, not the parser: progress is coalesced (status_events.h).
 using DuckyCallback = std::function<void(int, int, DuckyStatus)>;
 
 /// Initialize the parser module (creates FreeRTOS task).
 void duckyInit();
 
-/// Execute a DuckyScript payload from a string.
+/// Execute a DuckyScript payload from a string — source, or a
+/// bytecode image from duckyCompile() (see ducky_compiler.h).
 /// Returns false if another script is already running.
 bool duckyExecute(const String &script, DuckyCallback cb = nullptr);
 
@@ -32,3 +36,70 @@ bool duckyIsRunning();
 
 /// Get the current execution status.
 DuckyStatus duckyGetStatus();
+
+/// Lower-case name of `st` ("idle", "running", "finished", ...).
+const char *duckyStatusName(DuckyStatus st);
+
+/// Why the last script stopped with DuckyStatus::ERROR ("line N:
+/// ..."), or "" if it didn't.
+const char *duckyLastError();
+
+/// Complexity limits. A script that breaks one stops with ERROR
+/// before the offending line runs, so no input can keep the parser
+/// busy for longer than these allow.
+struct DuckyLimits {
+  uint32_t maxLineLen;  // bytes per line
+  uint32_t maxLines;    // lines per script
+  uint32_t maxRepeat;   // REPEAT count
+  uint32_t maxCommands; // commands per script, REPEAT expansions and
+                        // mouse path reports included
+  uint32_t maxDelayMs;  // DELAY / DEFAULT_DELAY
+};
+
+/// Replace the limits (defaults: DUCKY_MAX_* in config.h). Takes
+/// effect for the next script.
+void duckySetLimits(const DuckyLimits &limits);
+DuckyLimits duckyGetLimits();
+
+/// Dry-run cost of one kind of command.
+struct DuckyOpCost {
+  uint32_t count;   // times it ran (REPEATs expanded)
+  uint32_t reports; // HID reports
+  uint64_t us;      // time, including its own DELAY
+};
+
+/// Result of duckyAnalyze().
+struct DuckyAnalysis {
+  DuckyCompileResult compile;  // ok / error, lines, commands, unknown
+  uint64_t totalUs;            // estimated run time
+  uint32_t reports;            // HID reports the script would send
+  DuckyOpCost byOp[DOP_COUNT]; // by opcode; [DOP_DEFAULT_DELAY] is the
+                               // wait after each command
+  uint64_t waitMaxUs;          // WAIT_FOR_* timeouts: the most waiting
+                               // for the host can add (totalUs counts
+                               // none)
+};
+
+/// Dry run: compile (or verify) a script and run it through the
+/// interpreter against a null HID backend in virtual time. Touches
+/// neither USB nor the parser task, so it is safe while a script
+/// runs. False if the script doesn't compile (see a.compile).
+bool duckyAnalyze(const String &script, DuckyAnalysis &a);
+
+/// Interpreter counters since boot.
+struct DuckyStats {
+  uint32_t scripts;           // scripts started
+  uint32_t linesExecuted;     // commands dispatched (each REPEAT counts)
+  uint32_t linesPending;      // lines left in the running script
+  uint32_t aborts;            // scripts stopped by duckyStop()
+  uint32_t abortLatencyUs;    // last duckyStop() → task stopped
+  uint32_t abortLatencyMaxUs;
+  uint32_t stackFreeMin;      // lowest DuckyParser stack high-water mark
+  uint32_t limitErrors;       // scripts stopped by a limit or bad argument
+  uint32_t waits;             // WAIT_FOR_* lines the host answered
+  uint32_t waitTimeouts;      // WAIT_FOR_* lines that timed out (ERROR)
+  uint32_t waitLastMs;        // how long the last answered one waited
+};
+
+/// Snapshot of the interpreter counters.
+DuckyStats duckyGetStats();
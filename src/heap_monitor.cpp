@@ -0,0 +1,60 @@
+// ============================================================
+//  Heap Monitor — Largest Free Block Over Days of Uptime
+// ============================================================
+
+#include "heap_monitor.h"
+#include "config.h"
+
+static portMUX_TYPE sMux = portMUX_INITIALIZER_UNLOCKED;
+static HeapSample sSamples[HEAP_HISTORY_LEN];
+static uint32_t sTotal = 0; // samples ever taken; ring head = sTotal % LEN
+static uint32_t sLastMs = 0;
+static uint32_t sMinLargest = UINT32_MAX;
+
+// ----------------------------------------------------------------
+HeapSample heapSampleNow() {
+  HeapSample s = {(uint32_t)(millis() / 1000), ESP.getFreeHeap(),
+                  ESP.getMaxAllocHeap()};
+  return s;
+}
+
+void heapMonitorPoll() {
+  uint32_t now = millis();
+  if (sTotal && now - sLastMs < HEAP_SAMPLE_MS)
+    return;
+  sLastMs = now;
+  HeapSample s = heapSampleNow();
+  portENTER_CRITICAL(&sMux);
+  sSamples[sTotal % HEAP_HISTORY_LEN] = s;
+  sTotal++;
+  if (s.largest < sMinLargest)
+    sMinLargest = s.largest;
+  portEXIT_CRITICAL(&sMux);
+}
+
+float heapFragmentation(const HeapSample &s) {
+  if (!s.freeBytes || s.largest >= s.freeBytes)
+    return 0.0f;
+  return 1.0f - (float)s.largest / s.freeBytes;
+}
+
+size_t heapHistoryCount() {
+  return sTotal < HEAP_HISTORY_LEN ? sTotal : HEAP_HISTORY_LEN;
+}
+
+bool heapHistoryGet(size_t i, HeapSample &s) {
+  portENTER_CRITICAL(&sMux);
+  size_t n = heapHistoryCount();
+  bool ok = i < n;
+  if (ok)
+    s = sSamples[(sTotal - n + i) % HEAP_HISTORY_LEN];
+  portEXIT_CRITICAL(&sMux);
+  return ok;
+}
+
+uint32_t heapMinLargest() {
+  portENTER_CRITICAL(&sMux);
+  uint32_t v = sTotal ? sMinLargest : 0;
+  portEXIT_CRITICAL(&sMux);
+  return v;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+// ============================================================
+//  Heap Monitor — Largest Free Block Over Days of Uptime
+// ============================================================
+//
+//  Free heap alone hides fragmentation: after days of scripts and
+//  requests there can be plenty free and no block big enough for
+//  the next 8 KB buffer. loop() samples the internal heap every
+//  HEAP_SAMPLE_MS into a ring of HEAP_HISTORY_LEN entries (no
+//  allocation; the oldest are overwritten):
+//
+//    free        ESP.getFreeHeap()
+//    largest     ESP.getMaxAllocHeap(), the largest free block
+//    fragmentation = 1 - largest / free  (0 = one contiguous block)
+//
+//  Served at GET /api/heap with the arena counters (arena.h), and
+//  as gauges in /api/metrics.
+//
+// ============================================================
+
+#include <Arduino.h>
+
+struct HeapSample {
+  uint32_t uptimeS;   // millis() / 1000 at the sample
+  uint32_t freeBytes;
+  uint32_t largest;   // largest free block
+};
+
+/// Take a sample now if HEAP_SAMPLE_MS have passed since the last
+/// one (the first call always samples). Call from loop().
+void heapMonitorPoll();
+
+/// The heap right now (not recorded).
+HeapSample heapSampleNow();
+
+/// 1 - largest / free for `s` (0 when nothing is free).
+float heapFragmentation(const HeapSample &s);
+
+/// Samples held (at most HEAP_HISTORY_LEN).
+size_t heapHistoryCount();
+
+/// Sample `i`, oldest first. False if `i` is out of range.
+bool heapHistoryGet(size_t i, HeapSample &s);
+
+/// Smallest largest-free-block seen by any sample since boot.
+uint32_t heapMinLargest();
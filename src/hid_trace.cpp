@@ -0,0 +1,77 @@
+// ============================================================
+//  HID Trace — Report Capture for Golden-Trace Regression Checks
+// ============================================================
+
+#include "hid_trace.h"
+#include "config.h"
+
+static const uint8_t TRACE_MAGIC[4] = {'D', 'H', 'T', '1'};
+#define TRACE_RECORD_MAX 14 // kind + 5-byte varint + 8 data bytes
+
+static portMUX_TYPE sMux = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t *sBuf = nullptr;
+static size_t sCap = 0;
+static size_t sLen = 0;
+static uint32_t sLastUs = 0;
+static volatile bool sActive = false;
+static bool sTruncated = false;
+
+// ----------------------------------------------------------------
+bool hidTraceStart(size_t maxBytes) {
+  if (maxBytes == 0)
+    maxBytes = HID_TRACE_MAX;
+  hidTraceStop();
+
+  // Whole buffer up front: recording never allocates
+  if (maxBytes != sCap) {
+    free(sBuf);
+    sBuf = (uint8_t *)malloc(maxBytes);
+    sCap = sBuf ? maxBytes : 0;
+  }
+  if (!sBuf || sCap < sizeof(TRACE_MAGIC))
+    return false;
+
+  memcpy(sBuf, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+  sLen = sizeof(TRACE_MAGIC);
+  sTruncated = false;
+  sLastUs = micros();
+  sActive = true;
+  return true;
+}
+
+void hidTraceStop() { sActive = false; }
+
+bool hidTraceActive() { return sActive; }
+
+const uint8_t *hidTraceData() { return sBuf; }
+
+size_t hidTraceSize() { return sLen; }
+
+bool hidTraceTruncated() { return sTruncated; }
+
+// ----------------------------------------------------------------
+void hidTraceRecord(uint8_t kind, const uint8_t *data, size_t len) {
+  if (!sActive)
+    return;
+
+  portENTER_CRITICAL(&sMux);
+  if (sLen + TRACE_RECORD_MAX > sCap) {
+    sTruncated = true;
+    sActive = false;
+    portEXIT_CRITICAL(&sMux);
+    return;
+  }
+  uint32_t now = micros();
+  uint32_t dt = now - sLastUs;
+  sLastUs = now;
+
+  sBuf[sLen++] = kind;
+  do {
+    uint8_t b = dt & 0x7F;
+    dt >>= 7;
+    sBuf[sLen++] = dt ? (b | 0x80) : b;
+  } while (dt);
+  memcpy(sBuf + sLen, data, len);
+  sLen += len;
+  portEXIT_CRITICAL(&sMux);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+// ============================================================
+//  HID Trace — Report Capture for Golden-Trace Regression Checks
+// ============================================================
+//
+//  While capturing, usb_hid hands every report it sends to
+//  hidTraceRecord(). The trace is a compact binary stream:
+//
+//    "DHT1"                                     magic
+//    per report:  u8 kind | varint Δµs | data   (kind 1: 8-byte
+//                 keyboard report, kind 2: 4-byte mouse report
+//                 buttons, x, y, wheel, kind 3: 5-byte absolute
+//                 pointer report buttons, u16 x, u16 y, kind 4:
+//                 17-byte NKRO report modifiers, 128-bit key
+//                 bitmap)
+//
+//  Δµs is LEB128, measured from the previous report (the first
+//  from hidTraceStart()). scripts/hid_trace.py decodes and diffs
+//  traces.
+//
+// ============================================================
+
+#include <Arduino.h>
+
+#define HID_TRACE_KEYBOARD 1
+#define HID_TRACE_MOUSE 2
+#define HID_TRACE_MOUSE_ABS 3
+#define HID_TRACE_NKRO 4
+
+/// Start a fresh capture (drops any previous trace). False if the
+/// buffer can't be allocated.
+bool hidTraceStart(size_t maxBytes = 0);
+
+/// Stop capturing; the trace stays readable until the next start.
+void hidTraceStop();
+
+/// True while capturing.
+bool hidTraceActive();
+
+/// Captured bytes (header included), and whether the buffer filled up.
+const uint8_t *hidTraceData();
+size_t hidTraceSize();
+bool hidTraceTruncated();
+
+/// Append one report (called by usb_hid; no-op unless capturing).
+void hidTraceRecord(uint8_t kind, const uint8_t *data, size_t len);
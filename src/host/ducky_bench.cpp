@@ -0,0 +1,101 @@
+// ============================================================
+//  Host Benchmark — interpreter & HID throughput on env:native
+// ============================================================
+//
+//  pio run -e native_bench && .pio/build/native_bench/program
+//
+//    --scale N    synthetic case size multiplier (default 20)
+//    --runs N     repetitions per case, fastest kept (default 9);
+//                 peak heap is the largest over all of them
+//    --filter S   only cases whose name contains S
+//    --json FILE  write the baseline JSON (compare with
+//                 scripts/bench_compare.py)
+//
+// ============================================================
+
+#include "bench/bench_runner.h"
+#include "ducky_parser.h"
+#include "hid_recorder.h"
+#include "usb_hid.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+static void usage() {
+  fprintf(stderr, "usage: ducky_bench [--scale N] [--runs N] [--filter S] "
+                  "[--json FILE]\n");
+}
+
+int main(int argc, char **argv) {
+  int scale = 20;
+  int runs = 9;
+  String filter;
+  const char *jsonPath = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    String a = argv[i];
+    if (i + 1 >= argc) {
+      usage();
+      return 2;
+    }
+    if (a == "--scale") {
+      scale = atoi(argv[++i]);
+    } else if (a == "--runs") {
+      runs = atoi(argv[++i]);
+    } else if (a == "--filter") {
+      filter = argv[++i];
+    } else if (a == "--json") {
+      jsonPath = argv[++i];
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  if (runs < 1)
+    runs = 1;
+
+  // Time the code, not the DELAYs; count reports without storing them
+  hostClockUseVirtual(true);
+  hostHidStore(false);
+  initUSB();
+  duckyInit();
+
+  printf("%-14s %7s %8s %10s %12s %12s %10s\n", "case", "lines", "reports",
+         "ns/line", "reports/s", "sim ms", "peak B");
+
+  std::vector<BenchResult> results;
+  bool allOk = true;
+  for (auto &c : benchCorpus(scale)) {
+    if (filter.length() && String(c.name).indexOf(filter) < 0)
+      continue;
+    // Time of the fastest run, heap of the largest: the first run also
+    // grows the job arena, so the fastest one's heap would vary
+    BenchResult best;
+    uint32_t peakHeap = 0;
+    for (int r = 0; r < runs; r++) {
+      BenchResult res = benchRun(c);
+      if (r == 0 || res.wallUs < best.wallUs)
+        best = res;
+      peakHeap = std::max(peakHeap, res.peakHeap);
+    }
+    best.peakHeap = peakHeap;
+    allOk = allOk && best.ok;
+    printf("%-14s %7u %8u %10.1f %12.0f %12.1f %10u%s\n", best.name.c_str(),
+           best.lines, best.reports, best.nsPerLine(), best.reportsPerSec(),
+           best.simUs / 1000.0, best.peakHeap, best.ok ? "" : "  FAILED");
+    results.push_back(best);
+  }
+
+  if (jsonPath) {
+    FILE *f = fopen(jsonPath, "w");
+    if (!f) {
+      fprintf(stderr, "ducky_bench: cannot write %s\n", jsonPath);
+      return 1;
+    }
+    String json = benchToJson(results, "native");
+    fwrite(json.c_str(), 1, json.length(), f);
+    fclose(f);
+  }
+  return allOk ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+// ============================================================
+//  Offline Compiler — DuckyScript → device bytecode
+// ============================================================
+//
+//  pio run -e ducky_compile
+//  .pio/build/ducky_compile/program -o payload.dkb payload.ducky
+//
+//  Builds from the device's own compiler and parser sources, so an
+//  image that compiles here runs on the device unchanged. Upload it
+//  with POST /api/payloads/<name>/compiled.
+//
+//    -o FILE     write the bytecode image
+//    --no-opt    one instruction per command line
+//    --disasm    list the instructions
+//    --quiet     errors only
+//    --fs DIR    LittleFS root for INCLUDE (modules in DIR/payloads,
+//                as `ducky_run --fs`); without it INCLUDE is an error
+//
+//  The timing estimate is duckyAnalyze() — the same dry run as
+//  POST /api/analyze: every DELAY, DEFAULT_DELAY and the per-report
+//  HID pacing, in virtual time.
+//
+// ============================================================
+
+#include "ducky_compiler.h"
+#include "ducky_parser.h"
+#include "module_cache.h"
+#include "storage_manager.h"
+
+#include <LittleFS.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+static void usage() {
+  fprintf(stderr, "usage: ducky_compile [-o FILE] [--no-opt] [--disasm] "
+                  "[--quiet] [--fs DIR] <script>\n");
+}
+
+static void disassemble(const std::vector<uint8_t> &code) {
+  uint32_t lines;
+  size_t pos;
+  duckyCodeHeader(code.data(), code.size(), lines, pos);
+  DuckyInsn in;
+  while (duckyDecode(code.data(), code.size(), pos, in) &&
+         in.op != DOP_END) {
+    printf("%6u  %-13s", in.line, duckyOpName(in.op));
+    switch (in.op) {
+    case DOP_DELAY:
+    case DOP_DEFAULT_DELAY:
+    case DOP_REPEAT:
+      printf(" %u", in.arg);
+      break;
+    case DOP_STRING:
+    case DOP_STRINGLN:
+      printf(" \"%.*s\"", (int)in.arg, in.str);
+      break;
+    case DOP_KEY:
+      printf(" key %02x mod %02x", in.a, in.b);
+      break;
+    case DOP_MOUSE_MOVE:
+      printf(" %d %d", (int8_t)in.a, (int8_t)in.b);
+      break;
+    case DOP_MOUSE_CLICK:
+      printf(" %u", in.a);
+      break;
+    case DOP_MOUSE_SCROLL:
+      printf(" %d", (int8_t)in.a);
+      break;
+    case DOP_MOUSE_MOVE_TO:
+      printf(" %u %u", in.arg & 0xFFFF, in.arg >> 16);
+      break;
+    case DOP_MOUSE_PATH: {
+      int x = 0, y = 0;
+      for (uint32_t i = 0; i < in.arg; i++) {
+        x += (int8_t)in.str[2 * i];
+        y += (int8_t)in.str[2 * i + 1];
+      }
+      printf(" %d %d in %u reports every %u ms", x, y, in.arg, in.a);
+      break;
+    }
+    case DOP_WAIT:
+      printf(" %s, timeout %u ms", duckyWaitName(in.a, in.b), in.arg);
+      break;
+    }
+    printf("\n");
+  }
+}
+
+int main(int argc, char **argv) {
+  const char *src = nullptr;
+  const char *out = nullptr;
+  bool optimize = true;
+  bool disasm = false;
+  bool quiet = false;
+  const char *fsRoot = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    String a = argv[i];
+    if (a == "-o" && i + 1 < argc) {
+      out = argv[++i];
+    } else if (a == "--no-opt") {
+      optimize = false;
+    } else if (a == "--disasm") {
+      disasm = true;
+    } else if (a == "--quiet") {
+      quiet = true;
+    } else if (a == "--fs" && i + 1 < argc) {
+      fsRoot = argv[++i];
+    } else if (!src && !a.startsWith("-")) {
+      src = argv[i];
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  if (!src) {
+    usage();
+    return 2;
+  }
+
+  std::ifstream in(src, std::ios::binary);
+  if (!in) {
+    fprintf(stderr, "ducky_compile: cannot read '%s'\n", src);
+    return 1;
+  }
+  std::stringstream ss;
+  ss << in.rdbuf();
+  std::string text = ss.str();
+
+  DuckyIncludeFn include = nullptr;
+  if (fsRoot) {
+    LittleFS.setRoot(fsRoot);
+    storageInit();
+    moduleCacheInit();
+    include = moduleResolve;
+  }
+
+  std::vector<uint8_t> code;
+  DuckyCompileResult res;
+  if (!duckyCompile(text.data(), text.size(), code, res, optimize, include)) {
+    fprintf(stderr, "%s:%u: error: %s\n", src, res.errorLine, res.error);
+    return 1;
+  }
+
+  if (out) {
+    FILE *f = fopen(out, "wb");
+    if (!f || fwrite(code.data(), 1, code.size(), f) != code.size()) {
+      fprintf(stderr, "ducky_compile: cannot write %s\n", out);
+      if (f)
+        fclose(f);
+      return 1;
+    }
+    fclose(f);
+  }
+
+  if (disasm)
+    disassemble(code);
+  if (quiet)
+    return 0;
+
+  String image;
+  image.concat((const char *)code.data(), code.size());
+  DuckyAnalysis a;
+  duckyAnalyze(image, a);
+  printf("# %s: %u lines, %u commands, %u instructions\n", src, res.lines,
+         res.commands, res.insns);
+  printf("# %zu B source -> %zu B bytecode\n", text.size(), code.size());
+  printf("# estimated run time %.3f s, %u HID reports\n", a.totalUs / 1e6,
+         a.reports);
+  if (a.waitMaxUs)
+    printf("# plus up to %.3f s waiting for the host (WAIT_FOR_*)\n",
+           a.waitMaxUs / 1e6);
+  for (int op = 0; op < DOP_COUNT; op++) {
+    const DuckyOpCost &c = a.byOp[op];
+    if (c.count)
+      printf("#   %-13s %7u x %10.3f s %8u reports\n", duckyOpName(op),
+             c.count, c.us / 1e6, c.reports);
+  }
+  if (res.unknown)
+    fprintf(stderr, "%s:%u: warning: %u unrecognised command line(s) ignored\n",
+            src, res.unknownLine, res.unknown);
+  return 0;
+}
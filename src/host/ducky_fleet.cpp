@@ -0,0 +1,508 @@
+// ============================================================
+//  Fleet Tool — drive many devices' REST APIs at once
+// ============================================================
+//
+//  pio run -e ducky_fleet
+//  .pio/build/ducky_fleet/program --devices rack.txt sync payloads/
+//
+//  One thread, one epoll set (fleet_http.h): every device's
+//  requests chain from their callbacks, and all devices progress
+//  in parallel, at most --parallel connections open at a time.
+//
+//    -d HOST[:PORT]  a device (repeatable; port 80 by default)
+//    --devices FILE  devices one per line, '#' starts a comment
+//    --parallel N    open connections at most (32)
+//    --timeout MS    per request, connect to last byte (5000)
+//    --json          one JSON document instead of the table
+//
+//  Commands:
+//
+//    status          GET /api/status from every device
+//    sync DIR        make every file in DIR a payload of the same
+//                    name. Sources are compiled here (INCLUDE
+//                    resolves in DIR) and uploaded as bytecode with
+//                    POST /api/payloads/<name>/compiled; *.dkb files
+//                    go as they are. A GET with If-None-Match skips
+//                    payloads the device already has.
+//    run NAME        POST /api/execute/NAME; with --wait, poll
+//                    /api/status until the run is over
+//    stop            POST /api/stop
+//
+//  The exit status is 1 if any device failed. Test without
+//  hardware against ducky_mockdev.
+//
+// ============================================================
+
+#include "config.h"
+#include "ducky_compiler.h"
+#include "fleet_http.h"
+#include "storage_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <dirent.h>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <sys/stat.h>
+
+#define FLEET_POLL_MS 250 // run --wait: /api/status interval
+
+struct Device {
+  std::string spec; // as given
+  std::string host;
+  uint16_t port;
+  bool ok = true;
+  std::string result; // status, run outcome, sync summary
+  std::string detail; // error or progress
+  uint32_t uploaded = 0;
+  uint32_t unchanged = 0;
+  uint64_t startMs = 0;
+  uint64_t ms = 0;
+};
+
+struct LibraryPayload {
+  std::string name;
+  std::string image; // bytecode
+  std::string etag;
+};
+
+static std::vector<Device> sDevices;
+static bool sJson = false;
+
+static uint64_t nowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static void usage() {
+  fprintf(stderr,
+          "usage: ducky_fleet (-d HOST[:PORT] | --devices FILE)... "
+          "[--parallel N] [--timeout MS] [--json]\n"
+          "                   status | sync DIR | run NAME [--wait] | stop\n");
+}
+
+static bool readFile(const std::string &path, std::string &out) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in)
+    return false;
+  std::stringstream ss;
+  ss << in.rdbuf();
+  out = ss.str();
+  return true;
+}
+
+static bool loadDevices(const char *path) {
+  std::ifstream in(path);
+  if (!in)
+    return false;
+  std::string line;
+  while (std::getline(in, line)) {
+    line = line.substr(0, line.find('#'));
+    size_t a = line.find_first_not_of(" \t\r");
+    if (a == std::string::npos)
+      continue;
+    size_t b = line.find_last_not_of(" \t\r");
+    sDevices.push_back({line.substr(a, b - a + 1)});
+  }
+  return true;
+}
+
+static std::string urlEncode(const std::string &s) {
+  std::string out;
+  for (unsigned char ch : s) {
+    if (isalnum(ch) || strchr("-._~", ch)) {
+      out += (char)ch;
+    } else {
+      char esc[4];
+      snprintf(esc, sizeof(esc), "%%%02X", ch);
+      out += esc;
+    }
+  }
+  return out;
+}
+
+static HttpRequest request(const Device &d, const char *method,
+                           const std::string &path) {
+  HttpRequest r;
+  r.host = d.host;
+  r.port = d.port;
+  r.method = method;
+  r.path = path;
+  return r;
+}
+
+static void fail(Device &d, const HttpResponse &res) {
+  d.ok = false;
+  d.result = "failed";
+  if (res.status) {
+    std::string error;
+    jsonGet(res.body, "error", error);
+    d.detail = "HTTP " + std::to_string(res.status) +
+               (error.empty() ? "" : ": " + error);
+  } else {
+    d.detail = res.error;
+  }
+}
+
+static void finished(Device &d) { d.ms = nowMs() - d.startMs; }
+
+// ================================================================
+//  Library: compile DIR, INCLUDE resolving in DIR
+// ================================================================
+
+static std::string sLibDir;
+static String sStack[MODULE_MAX_DEPTH];
+static int sDepth = 0;
+static std::map<std::string, DuckyImage> sModules;
+static std::string sCycleError; // "INCLUDE cycle: a -> b -> a"
+
+static bool compileFile(const std::string &name, const std::string &src,
+                        std::vector<uint8_t> &code, DuckyCompileResult &res);
+
+static DuckyImage libResolve(const String &name, const char *&error) {
+  auto it = sModules.find(name.c_str());
+  if (it != sModules.end())
+    return it->second;
+  for (int i = 0; i < sDepth; i++) {
+    if (sStack[i] == name) {
+      sCycleError = "INCLUDE cycle: ";
+      for (int j = i; j < sDepth; j++)
+        sCycleError += std::string(sStack[j].c_str()) + " -> ";
+      sCycleError += name.c_str();
+      error = sCycleError.c_str();
+      return nullptr;
+    }
+  }
+  if (sDepth >= MODULE_MAX_DEPTH) {
+    error = "INCLUDE nested too deep";
+    return nullptr;
+  }
+  std::string src;
+  if (!isValidPayloadName(name) ||
+      !readFile(sLibDir + "/" + name.c_str(), src)) {
+    error = "INCLUDE module not found";
+    return nullptr;
+  }
+
+  auto code = std::make_shared<std::vector<uint8_t>>();
+  DuckyCompileResult res;
+  sStack[sDepth++] = name;
+  bool ok = compileFile(name.c_str(), src, *code, res);
+  sDepth--;
+  if (!ok) {
+    fprintf(stderr, "%s/%s:%u: error: %s\n", sLibDir.c_str(), name.c_str(),
+            res.errorLine, res.error);
+    error = res.error == sCycleError.c_str() ? res.error
+                                             : "INCLUDE module doesn't compile";
+    return nullptr;
+  }
+  sModules[name.c_str()] = code;
+  return code;
+}
+
+static bool compileFile(const std::string &name, const std::string &src,
+                        std::vector<uint8_t> &code, DuckyCompileResult &res) {
+  if (duckyIsBytecode((const uint8_t *)src.data(), src.size())) {
+    code.assign(src.begin(), src.end());
+    return duckyVerify(code.data(), code.size(), res);
+  }
+  return duckyCompile(src.data(), src.size(), code, res, true, libResolve);
+}
+
+static bool loadLibrary(const char *dir, std::vector<LibraryPayload> &lib) {
+  sLibDir = dir;
+  DIR *d = opendir(dir);
+  if (!d) {
+    fprintf(stderr, "ducky_fleet: cannot open '%s'\n", dir);
+    return false;
+  }
+  std::vector<std::string> names;
+  while (dirent *e = readdir(d)) {
+    struct stat st;
+    std::string path = sLibDir + "/" + e->d_name;
+    if (e->d_name[0] != '.' && stat(path.c_str(), &st) == 0 &&
+        S_ISREG(st.st_mode))
+      names.push_back(e->d_name);
+  }
+  closedir(d);
+  std::sort(names.begin(), names.end());
+
+  bool ok = true;
+  for (auto &name : names) {
+    std::string src;
+    std::vector<uint8_t> code;
+    DuckyCompileResult res;
+    if (!isValidPayloadName(name.c_str()) ||
+        !readFile(sLibDir + "/" + name, src)) {
+      fprintf(stderr, "ducky_fleet: cannot read '%s/%s'\n", dir, name.c_str());
+      ok = false;
+      continue;
+    }
+    if (!compileFile(name, src, code, res)) {
+      fprintf(stderr, "%s/%s:%u: error: %s\n", dir, name.c_str(),
+              res.errorLine, res.error);
+      ok = false;
+      continue;
+    }
+    if (code.size() > MAX_PAYLOAD_SIZE) {
+      fprintf(stderr, "%s/%s: error: image over %u bytes\n", dir, name.c_str(),
+              MAX_PAYLOAD_SIZE);
+      ok = false;
+      continue;
+    }
+    char etag[12];
+    snprintf(etag, sizeof(etag), "\"%08x\"",
+             (unsigned)contentHash(code.data(), code.size()));
+    lib.push_back({name, std::string(code.begin(), code.end()), etag});
+  }
+  return ok;
+}
+
+// ================================================================
+//  Commands
+// ================================================================
+
+static void cmdStatus(HttpPool &pool) {
+  for (Device &d : sDevices) {
+    pool.submit(request(d, "GET", "/api/status"),
+                [&d](const HttpResponse &res) {
+                  finished(d);
+                  if (res.status != 200)
+                    return fail(d, res);
+                  jsonGet(res.body, "status", d.result);
+                  std::string line, total, error;
+                  if (jsonGet(res.body, "progress.line", line) &&
+                      jsonGet(res.body, "progress.total", total))
+                    d.detail = "line " + line + "/" + total;
+                  if (jsonGet(res.body, "lastError", error))
+                    d.detail += (d.detail.empty() ? "" : ", ") + error;
+                  if (d.result == "error")
+                    d.ok = false;
+                });
+  }
+}
+
+// One payload at a time per device: check, then upload if it differs
+static void syncNext(HttpPool &pool, Device &d,
+                     const std::vector<LibraryPayload> &lib, size_t i) {
+  if (i == lib.size()) {
+    finished(d);
+    d.result = "synced";
+    d.detail = std::to_string(d.uploaded) + " uploaded, " +
+               std::to_string(d.unchanged) + " unchanged";
+    return;
+  }
+  const LibraryPayload &p = lib[i];
+  std::string path = "/api/payloads/" + urlEncode(p.name);
+  HttpRequest check = request(d, "GET", path);
+  check.headers.push_back({"If-None-Match", p.etag});
+
+  pool.submit(check, [&pool, &d, &lib, i, path](const HttpResponse &res) {
+    const LibraryPayload &p = lib[i];
+    if (res.status == 304) {
+      d.unchanged++;
+      return syncNext(pool, d, lib, i + 1);
+    }
+    if (res.status != 200 && res.status != 404) {
+      finished(d);
+      return fail(d, res);
+    }
+    HttpRequest up = request(d, "POST", path + "/compiled");
+    up.headers.push_back({"Content-Type", "application/octet-stream"});
+    up.body = p.image;
+    pool.submit(up, [&pool, &d, &lib, i](const HttpResponse &res) {
+      if (res.status != 200) {
+        finished(d);
+        fail(d, res);
+        d.detail = lib[i].name + ": " + d.detail;
+        return;
+      }
+      d.uploaded++;
+      syncNext(pool, d, lib, i + 1);
+    });
+  });
+}
+
+static void pollRun(HttpPool &pool, Device &d, int delayMs) {
+  pool.submit(
+      request(d, "GET", "/api/status"),
+      [&pool, &d](const HttpResponse &res) {
+        if (res.status != 200) {
+          finished(d);
+          return fail(d, res);
+        }
+        std::string status, error;
+        jsonGet(res.body, "status", status);
+        if (status == "running" || status == "paused")
+          return pollRun(pool, d, FLEET_POLL_MS);
+        finished(d);
+        d.result = status;
+        if (status != "finished") {
+          d.ok = false;
+          if (jsonGet(res.body, "lastError", error))
+            d.detail = error;
+        }
+      },
+      delayMs);
+}
+
+static void cmdRun(HttpPool &pool, const std::string &name, bool wait) {
+  for (Device &d : sDevices) {
+    pool.submit(request(d, "POST", "/api/execute/" + urlEncode(name)),
+                [&pool, &d, wait](const HttpResponse &res) {
+                  if (res.status == 409) {
+                    finished(d);
+                    d.ok = false;
+                    d.result = "busy";
+                    return;
+                  }
+                  if (res.status != 200) {
+                    finished(d);
+                    return fail(d, res);
+                  }
+                  if (wait)
+                    return pollRun(pool, d, FLEET_POLL_MS);
+                  finished(d);
+                  d.result = "started";
+                });
+  }
+}
+
+static void cmdStop(HttpPool &pool) {
+  for (Device &d : sDevices) {
+    pool.submit(request(d, "POST", "/api/stop"),
+                [&d](const HttpResponse &res) {
+                  finished(d);
+                  if (res.status != 200)
+                    return fail(d, res);
+                  jsonGet(res.body, "status", d.result);
+                });
+  }
+}
+
+// ================================================================
+//  Report
+// ================================================================
+
+static void report(const char *command, uint64_t ms) {
+  int failed = 0;
+  std::map<std::string, int> byResult;
+  for (const Device &d : sDevices) {
+    failed += !d.ok;
+    byResult[d.result]++;
+  }
+
+  if (sJson) {
+    printf("{\"command\":%s,\"ms\":%llu,\"devices\":[", jsonQuote(command).c_str(),
+           (unsigned long long)ms);
+    for (size_t i = 0; i < sDevices.size(); i++) {
+      const Device &d = sDevices[i];
+      printf("%s{\"device\":%s,\"ok\":%s,\"result\":%s,\"detail\":%s,"
+             "\"uploaded\":%u,\"unchanged\":%u,\"ms\":%llu}",
+             i ? "," : "", jsonQuote(d.spec).c_str(), d.ok ? "true" : "false",
+             jsonQuote(d.result).c_str(), jsonQuote(d.detail).c_str(),
+             d.uploaded, d.unchanged, (unsigned long long)d.ms);
+    }
+    printf("],\"totals\":{");
+    bool first = true;
+    for (auto &kv : byResult) {
+      printf("%s%s:%d", first ? "" : ",", jsonQuote(kv.first).c_str(),
+             kv.second);
+      first = false;
+    }
+    printf("},\"failed\":%d}\n", failed);
+    return;
+  }
+
+  size_t width = 6;
+  for (const Device &d : sDevices)
+    width = std::max(width, d.spec.size());
+  printf("%-*s  %-9s %7s  %s\n", (int)width, "DEVICE", "RESULT", "MS",
+         "DETAIL");
+  for (const Device &d : sDevices)
+    printf("%-*s  %-9s %7llu  %s\n", (int)width, d.spec.c_str(),
+           d.result.c_str(), (unsigned long long)d.ms, d.detail.c_str());
+  printf("# %s: %zu devices in %.3f s:", command, sDevices.size(), ms / 1e3);
+  for (auto &kv : byResult)
+    printf(" %d %s", kv.second, kv.first.c_str());
+  printf("\n");
+}
+
+int main(int argc, char **argv) {
+  int parallel = 32;
+  int timeoutMs = 5000;
+  bool wait = false;
+  std::vector<std::string> args;
+
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    if (a == "-d" && i + 1 < argc) {
+      sDevices.push_back({argv[++i]});
+    } else if (a == "--devices" && i + 1 < argc) {
+      if (!loadDevices(argv[++i])) {
+        fprintf(stderr, "ducky_fleet: cannot read '%s'\n", argv[i]);
+        return 2;
+      }
+    } else if (a == "--parallel" && i + 1 < argc) {
+      parallel = atoi(argv[++i]);
+    } else if (a == "--timeout" && i + 1 < argc) {
+      timeoutMs = atoi(argv[++i]);
+    } else if (a == "--json") {
+      sJson = true;
+    } else if (a == "--wait") {
+      wait = true;
+    } else if (a[0] != '-') {
+      args.push_back(a);
+    } else {
+      usage();
+      return 2;
+    }
+  }
+
+  std::string command = args.empty() ? "" : args[0];
+  size_t need = command == "sync" || command == "run" ? 2 : 1;
+  if (sDevices.empty() || args.size() != need ||
+      (command != "status" && command != "sync" && command != "run" &&
+       command != "stop") ||
+      parallel < 1 || timeoutMs < 1 || (wait && command != "run")) {
+    usage();
+    return 2;
+  }
+  for (Device &d : sDevices) {
+    if (!httpParseEndpoint(d.spec, d.host, d.port)) {
+      fprintf(stderr, "ducky_fleet: bad device '%s'\n", d.spec.c_str());
+      return 2;
+    }
+  }
+
+  std::vector<LibraryPayload> lib;
+  if (command == "sync" && !loadLibrary(args[1].c_str(), lib))
+    return 1;
+
+  HttpPool pool(parallel, timeoutMs);
+  uint64_t t0 = nowMs();
+  for (Device &d : sDevices)
+    d.startMs = t0;
+  if (command == "status") {
+    cmdStatus(pool);
+  } else if (command == "sync") {
+    for (Device &d : sDevices)
+      syncNext(pool, d, lib, 0);
+  } else if (command == "run") {
+    cmdRun(pool, args[1], wait);
+  } else {
+    cmdStop(pool);
+  }
+  pool.run();
+
+  report(command.c_str(), nowMs() - t0);
+  for (const Device &d : sDevices) {
+    if (!d.ok)
+      return 1;
+  }
+  return 0;
+}
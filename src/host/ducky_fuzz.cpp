@@ -0,0 +1,164 @@
+// ============================================================
+//  Parser Fuzz Harness — libFuzzer entry + worst-case replay
+// ============================================================
+//
+//  Feeds arbitrary bytes to duckyExecute() on the native shim
+//  (virtual clock, recorder HID with storage off) and waits for
+//  the parser task to finish.
+//
+//  env:native_fuzz (clang, libFuzzer + ASan/UBSan):
+//    pio run -e native_fuzz
+//    .pio/build/native_fuzz/program -max_len=8192 -timeout=2
+//        -rss_limit_mb=512 -malloc_limit_mb=64 fuzz/corpus fuzz/worstcase
+//
+//  env:native_fuzz_replay (gcc, no sanitizers) runs files once
+//  each and fails if any takes longer than the budget:
+//    .pio/build/native_fuzz_replay/program [--max-ms N] FILE|DIR...
+//
+//  The harness uses tighter limits than the device (FUZZ_*) so
+//  every input stays well under the libFuzzer timeout; the
+//  replay keeps the DUCKY_MAX_* defaults.
+//
+// ============================================================
+
+#include "ducky_parser.h"
+#include "hid_recorder.h"
+#include "host_clock.h"
+#include "usb_hid.h"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#define FUZZ_MAX_REPEAT 100
+#define FUZZ_MAX_COMMANDS 2000
+
+static volatile bool sDone = false;
+
+static void setup() {
+  hostClockUseVirtual(true);
+  hostHidStore(false);
+  initUSB();
+  duckyInit();
+}
+
+// Run one script to completion; the parser task has exited on return.
+static DuckyStatus runScript(const uint8_t *data, size_t size) {
+  String script;
+  script.concat((const char *)data, size);
+
+  UBaseType_t tasks = uxTaskGetNumberOfTasks();
+  sDone = false;
+  auto cb = [](int line, int total, DuckyStatus st) {
+    if (st != DuckyStatus::RUNNING)
+      sDone = true;
+  };
+  if (!duckyExecute(script, cb))
+    return DuckyStatus::IDLE;
+  // Real sleep: delay() would advance the virtual clock
+  while (!sDone || uxTaskGetNumberOfTasks() > tasks)
+    std::this_thread::sleep_for(std::chrono::microseconds(20));
+  return duckyGetStatus();
+}
+
+#ifndef DUCKY_FUZZ_REPLAY
+
+extern "C" int LLVMFuzzerInitialize(int *argc, char ***argv) {
+  setup();
+  DuckyLimits limits = duckyGetLimits();
+  limits.maxRepeat = FUZZ_MAX_REPEAT;
+  limits.maxCommands = FUZZ_MAX_COMMANDS;
+  duckySetLimits(limits);
+  return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  runScript(data, size);
+  return 0;
+}
+
+#else // DUCKY_FUZZ_REPLAY
+
+#include <algorithm>
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+static const char *statusName(DuckyStatus st) {
+  switch (st) {
+  case DuckyStatus::FINISHED:
+    return "finished";
+  case DuckyStatus::ERROR:
+    return "error";
+  case DuckyStatus::ABORTED:
+    return "aborted";
+  default:
+    return "busy";
+  }
+}
+
+static void collect(const std::string &path, std::vector<std::string> &out) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0)
+    return;
+  if (!S_ISDIR(st.st_mode)) {
+    out.push_back(path);
+    return;
+  }
+  DIR *d = opendir(path.c_str());
+  std::vector<std::string> names;
+  while (struct dirent *e = readdir(d)) {
+    if (e->d_name[0] != '.')
+      names.push_back(e->d_name);
+  }
+  closedir(d);
+  std::sort(names.begin(), names.end());
+  for (auto &n : names)
+    collect(path + "/" + n, out);
+}
+
+int main(int argc, char **argv) {
+  double maxMs = 1000;
+  std::vector<std::string> files;
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    if (a == "--max-ms" && i + 1 < argc)
+      maxMs = atof(argv[++i]);
+    else
+      collect(a, files);
+  }
+  if (files.empty()) {
+    fprintf(stderr, "usage: ducky_fuzz [--max-ms N] FILE|DIR...\n");
+    return 2;
+  }
+
+  setup();
+  int slow = 0;
+  for (auto &path : files) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::string data = ss.str();
+
+    uint32_t r0 = hidGetStats().reports;
+    auto t0 = std::chrono::steady_clock::now();
+    DuckyStatus st = runScript((const uint8_t *)data.data(), data.size());
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - t0)
+                    .count();
+    uint32_t reports = hidGetStats().reports - r0;
+
+    bool over = ms > maxMs;
+    slow += over;
+    printf("%-40s %7zu B %8u reports %9.3f ms  %-8s %s%s\n", path.c_str(),
+           data.size(), reports, ms, statusName(st), duckyLastError(),
+           over ? "  SLOW" : "");
+  }
+  printf("# %zu inputs, %d over %.0f ms\n", files.size(), slow, maxMs);
+  return slow ? 1 : 0;
+}
+
+#endif // DUCKY_FUZZ_REPLAY
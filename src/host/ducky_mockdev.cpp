@@ -0,0 +1,390 @@
+// ============================================================
+//  Mock Device — the fleet REST API on the host parser
+// ============================================================
+//
+//  pio run -e ducky_mockdev
+//  .pio/build/ducky_mockdev/program --port 8081 --fs /tmp/dev1
+//
+//  Serves the routes ducky_fleet and scripts/etag_check.py use,
+//  backed by the real storage, compiler and parser on the native
+//  shim, so fleet runs can be tested without hardware: start one
+//  per port and list them as devices. Reports go nowhere; time is virtual unless --realtime.
+//
+//    GET    /api/payloads                  list
+//    GET    /api/payloads/<name>           content, ETag / If-None-Match
+//    POST   /api/payloads                  save {"name","content"}
+//    PATCH  /api/payloads/<name>           byte-range edits, If-Match
+//    DELETE /api/payloads/<name>           delete
+//    POST   /api/payloads/<name>/compiled  store a bytecode image
+//    POST   /api/execute/<name>            start a payload
+//    POST   /api/stop                      stop it
+//    GET    /api/status                    status, progress, lastError
+//
+//    --port N     listen port (8080)
+//    --bind ADDR  listen address (127.0.0.1)
+//    --fs DIR     LittleFS root (payloads in DIR/payloads)
+//    --realtime   use the wall clock, so runs take their real time
+//    --quiet      don't log requests
+//
+//  One connection at a time, one request per connection — enough
+//  for a test rack, not a web server.
+//
+// ============================================================
+
+#include "config.h"
+#include "ducky_compiler.h"
+#include "ducky_parser.h"
+#include "fleet_http.h"
+#include "hid_recorder.h"
+#include "host_clock.h"
+#include "storage_manager.h"
+#include "usb_hid.h"
+
+#include <LittleFS.h>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cstdio>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define MOCK_IO_TIMEOUT_S 5 // per connection
+
+static std::atomic<uint32_t> sRun{0};
+static std::atomic<int> sLine{0};
+static std::atomic<int> sTotal{0};
+
+static void usage() {
+  fprintf(stderr, "usage: ducky_mockdev [--port N] [--bind ADDR] [--fs DIR] "
+                  "[--realtime] [--quiet]\n");
+}
+
+static std::string etagFor(uint32_t hash) {
+  char buf[12];
+  snprintf(buf, sizeof(buf), "\"%08x\"", (unsigned)hash);
+  return buf;
+}
+
+static std::string urlDecode(const std::string &s) {
+  std::string out;
+  for (size_t i = 0; i < s.size(); i++) {
+    if (s[i] == '%' && i + 2 < s.size() && isxdigit((unsigned char)s[i + 1]) &&
+        isxdigit((unsigned char)s[i + 2])) {
+      out += (char)strtol(s.substr(i + 1, 2).c_str(), nullptr, 16);
+      i += 2;
+    } else {
+      out += s[i];
+    }
+  }
+  return out;
+}
+
+static void sendResponse(int fd, int status, const std::string &body,
+                         const HttpHeaders &extra = {}) {
+  std::string out = "HTTP/1.1 " + std::to_string(status) + " " +
+                    httpReason(status) + "\r\nConnection: close\r\n";
+  if (!body.empty())
+    out += "Content-Type: application/json\r\n";
+  out += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+  for (auto &h : extra)
+    out += h.first + ": " + h.second + "\r\n";
+  out += "\r\n" + body;
+  for (size_t sent = 0; sent < out.size();) {
+    ssize_t n = send(fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0)
+      return;
+    sent += n;
+  }
+}
+
+static void sendError(int fd, int status, const char *error) {
+  sendResponse(fd, status, "{\"error\":" + jsonQuote(error) + "}");
+}
+
+// ================================================================
+//  Routes
+// ================================================================
+
+static void listPayloadsRoute(int fd) {
+  std::string body = "{\"payloads\":[";
+  bool first = true;
+  for (auto &name : listPayloads()) {
+    body += (first ? "" : ",") + jsonQuote(name.c_str());
+    first = false;
+  }
+  sendResponse(fd, 200, body + "]}");
+}
+
+static void getPayloadRoute(int fd, const std::string &name,
+                            const HttpHeaders &headers) {
+  if (!isValidPayloadName(name.c_str()) || payloadSize(name.c_str()) < 0)
+    return sendError(fd, 404, "Not found");
+  std::string etag = etagFor(payloadHash(name.c_str()));
+  std::string match = httpHeader(headers, "If-None-Match");
+  if (match == "*" || (!match.empty() && match.find(etag) != std::string::npos))
+    return sendResponse(fd, 304, "", {{"ETag", etag}});
+
+  String content = readPayload(name.c_str());
+  std::string body = "{\"name\":" + jsonQuote(name);
+  if (duckyIsBytecode((const uint8_t *)content.c_str(), content.length()))
+    body += ",\"compiled\":true";
+  else
+    body += ",\"content\":" +
+            jsonQuote(std::string(content.c_str(), content.length()));
+  body += ",\"size\":" + std::to_string(content.length()) +
+          ",\"etag\":" + jsonQuote(etag) + "}";
+  sendResponse(fd, 200, body, {{"ETag", etag}});
+}
+
+static void savePayloadRoute(int fd, const std::string &body) {
+  std::string name, content;
+  jsonGet(body, "name", name);
+  jsonGet(body, "content", content);
+  if (name.empty())
+    return sendError(fd, 400, "Name required");
+  String text;
+  text.concat(content.data(), content.size());
+  if (!savePayload(name.c_str(), text, true))
+    return sendError(fd, 500, "Save failed");
+  sendResponse(fd, 200,
+               "{\"status\":\"saved\",\"etag\":" +
+                   jsonQuote(etagFor(payloadHash(name.c_str()))) + "}");
+}
+
+// Same semantics as the device: If-Match, then all edits or none
+static void patchPayloadRoute(int fd, const std::string &name,
+                              const HttpHeaders &headers,
+                              const std::string &body) {
+  if (!isValidPayloadName(name.c_str()) || payloadSize(name.c_str()) < 0)
+    return sendError(fd, 404, "Not found");
+  std::string match = httpHeader(headers, "If-Match");
+  if (!match.empty() && match != "*" &&
+      match.find(etagFor(payloadHash(name.c_str()))) == std::string::npos)
+    return sendError(fd, 412, "ETag mismatch");
+
+  std::vector<std::string> items;
+  if (!jsonItems(body, "edits", items))
+    return sendError(fd, 400, "Edits required");
+  std::vector<PayloadEdit> edits;
+  for (auto &item : items) {
+    std::string offset, remove, text;
+    jsonGet(item, "offset", offset);
+    jsonGet(item, "remove", remove);
+    jsonGet(item, "text", text);
+    PayloadEdit e = {strtoul(offset.c_str(), nullptr, 10),
+                     strtoul(remove.c_str(), nullptr, 10), String()};
+    e.text.concat(text.data(), text.size());
+    edits.push_back(e);
+  }
+  if (!patchPayload(name.c_str(), edits))
+    return sendError(fd, 422, "Edit out of range");
+  std::string etag = etagFor(payloadHash(name.c_str()));
+  sendResponse(fd, 200,
+               "{\"status\":\"patched\",\"etag\":" + jsonQuote(etag) + "}",
+               {{"ETag", etag}});
+}
+
+static void deletePayloadRoute(int fd, const std::string &name) {
+  if (!isValidPayloadName(name.c_str()) || !deletePayload(name.c_str()))
+    return sendError(fd, 404, "Not found");
+  sendResponse(fd, 200, "{\"status\":\"deleted\"}");
+}
+
+static void saveCompiledRoute(int fd, const std::string &name,
+                              const std::string &image) {
+  if (image.size() > MAX_PAYLOAD_SIZE)
+    return sendError(fd, 413, "Too large");
+  DuckyCompileResult check;
+  if (!duckyVerify((const uint8_t *)image.data(), image.size(), check)) {
+    return sendResponse(fd, 400,
+                        "{\"error\":" + jsonQuote(check.error) +
+                            ",\"line\":" + std::to_string(check.errorLine) +
+                            "}");
+  }
+  String content;
+  content.concat(image.data(), image.size());
+  if (!isValidPayloadName(name.c_str()) ||
+      !savePayload(name.c_str(), content, true))
+    return sendError(fd, 500, "Save failed");
+  sendResponse(fd, 200,
+               "{\"status\":\"saved\",\"lines\":" +
+                   std::to_string(check.lines) +
+                   ",\"commands\":" + std::to_string(check.commands) +
+                   ",\"etag\":" + jsonQuote(etagFor(payloadHash(name.c_str()))) +
+                   "}");
+}
+
+static void executeRoute(int fd, const std::string &name) {
+  if (!isValidPayloadName(name.c_str()) || payloadSize(name.c_str()) < 0)
+    return sendError(fd, 404, "Not found");
+  if (duckyIsRunning())
+    return sendError(fd, 409, "Already running");
+  uint32_t run = ++sRun;
+  sLine = 0;
+  sTotal = 0;
+  auto cb = [run](int line, int total, DuckyStatus st) {
+    if (run == sRun) {
+      sLine = line;
+      sTotal = total;
+    }
+  };
+  if (!duckyExecuteFile(String(PAYLOAD_DIR) + "/" + name.c_str(), cb))
+    return sendError(fd, 500, "Execution failed");
+  sendResponse(fd, 200, "{\"status\":\"executing\"}");
+}
+
+static void stopRoute(int fd) {
+  if (!duckyIsRunning())
+    return sendResponse(fd, 200, "{\"status\":\"idle\"}");
+  duckyStop();
+  sendResponse(fd, 200, "{\"status\":\"stopping\"}");
+}
+
+static void statusRoute(int fd) {
+  std::string body = "{\"running\":";
+  body += duckyIsRunning() ? "true" : "false";
+  body += ",\"status\":" + jsonQuote(duckyStatusName(duckyGetStatus()));
+  if (duckyLastError()[0])
+    body += ",\"lastError\":" + jsonQuote(duckyLastError());
+  if (sRun)
+    body += ",\"progress\":{\"run\":" + std::to_string(sRun.load()) +
+            ",\"line\":" + std::to_string(sLine.load()) +
+            ",\"total\":" + std::to_string(sTotal.load()) + "}";
+  size_t total, used;
+  getStorageInfo(total, used);
+  body += ",\"storage\":{\"total\":" + std::to_string(total) +
+          ",\"used\":" + std::to_string(used) + "}}";
+  sendResponse(fd, 200, body);
+}
+
+// Read one request from `fd` and answer it. False if none arrived.
+static bool serve(int fd, std::string &method, std::string &path) {
+  std::string in;
+  size_t bodyStart;
+  std::string start;
+  HttpHeaders headers;
+  char buf[4096];
+  while (!httpParseHead(in, bodyStart, start, headers)) {
+    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0 || in.size() > 16384)
+      return false;
+    in.append(buf, n);
+  }
+  size_t sp1 = start.find(' ');
+  size_t sp2 = start.find(' ', sp1 + 1);
+  if (sp1 == std::string::npos || sp2 == std::string::npos) {
+    sendError(fd, 400, "Bad request");
+    return true;
+  }
+  method = start.substr(0, sp1);
+  path = start.substr(sp1 + 1, sp2 - sp1 - 1);
+  path = path.substr(0, path.find('?'));
+
+  size_t length = strtoul(httpHeader(headers, "Content-Length").c_str(),
+                          nullptr, 10);
+  if (length > MAX_PAYLOAD_SIZE) {
+    sendError(fd, 413, "Too large");
+    return true;
+  }
+  while (in.size() - bodyStart < length) {
+    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0)
+      return false;
+    in.append(buf, n);
+  }
+  std::string body = in.substr(bodyStart, length);
+
+  static const std::string kPayloads = "/api/payloads/";
+  static const std::string kExecute = "/api/execute/";
+  static const std::string kCompiled = "/compiled";
+  if (method == "GET" && path == "/api/payloads") {
+    listPayloadsRoute(fd);
+  } else if (method == "GET" && path.compare(0, kPayloads.size(), kPayloads) == 0) {
+    getPayloadRoute(fd, urlDecode(path.substr(kPayloads.size())), headers);
+  } else if (method == "POST" && path.compare(0, kPayloads.size(), kPayloads) == 0 &&
+             path.size() > kPayloads.size() + kCompiled.size() &&
+             path.compare(path.size() - kCompiled.size(), kCompiled.size(),
+                          kCompiled) == 0) {
+    saveCompiledRoute(fd,
+                      urlDecode(path.substr(kPayloads.size(),
+                                            path.size() - kPayloads.size() -
+                                                kCompiled.size())),
+                      body);
+  } else if (method == "POST" && path == "/api/payloads") {
+    savePayloadRoute(fd, body);
+  } else if (method == "PATCH" &&
+             path.compare(0, kPayloads.size(), kPayloads) == 0) {
+    patchPayloadRoute(fd, urlDecode(path.substr(kPayloads.size())), headers,
+                      body);
+  } else if (method == "DELETE" &&
+             path.compare(0, kPayloads.size(), kPayloads) == 0) {
+    deletePayloadRoute(fd, urlDecode(path.substr(kPayloads.size())));
+  } else if (method == "POST" && path.compare(0, kExecute.size(), kExecute) == 0) {
+    executeRoute(fd, urlDecode(path.substr(kExecute.size())));
+  } else if (method == "POST" && path == "/api/stop") {
+    stopRoute(fd);
+  } else if (method == "GET" && path == "/api/status") {
+    statusRoute(fd);
+  } else {
+    sendError(fd, 404, "Not found");
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  int port = 8080;
+  const char *bindAddr = "127.0.0.1";
+  bool realtime = false;
+  bool quiet = false;
+
+  for (int i = 1; i < argc; i++) {
+    String a = argv[i];
+    if (a == "--port" && i + 1 < argc) {
+      port = atoi(argv[++i]);
+    } else if (a == "--bind" && i + 1 < argc) {
+      bindAddr = argv[++i];
+    } else if (a == "--fs" && i + 1 < argc) {
+      LittleFS.setRoot(argv[++i]);
+    } else if (a == "--realtime") {
+      realtime = true;
+    } else if (a == "--quiet") {
+      quiet = true;
+    } else {
+      usage();
+      return 2;
+    }
+  }
+
+  hostClockUseVirtual(!realtime);
+  hostHidStore(false);
+  storageInit();
+  initUSB();
+  duckyInit();
+
+  int ls = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(ls, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  if (inet_pton(AF_INET, bindAddr, &addr.sin_addr) != 1 ||
+      bind(ls, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(ls, 64) < 0) {
+    fprintf(stderr, "ducky_mockdev: cannot listen on %s:%d\n", bindAddr, port);
+    return 1;
+  }
+  fprintf(stderr, "# ducky_mockdev on %s:%d\n", bindAddr, port);
+
+  for (;;) {
+    int fd = accept(ls, nullptr, nullptr);
+    if (fd < 0)
+      continue;
+    timeval tv = {MOCK_IO_TIMEOUT_S, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    std::string method, path;
+    bool served = serve(fd, method, path);
+    close(fd);
+    if (!quiet && served)
+      fprintf(stderr, "%s %s\n", method.c_str(), path.c_str());
+  }
+}
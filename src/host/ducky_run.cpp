@@ -0,0 +1,220 @@
+// ============================================================
+//  Host Runner — execute a DuckyScript against the native shim
+// ============================================================
+//
+//  pio run -e native && .pio/build/native/program script.ducky
+//
+//  Runs the real parser/HID code on Linux with the recorder HID
+//  backend and prints every report it would have sent. Time is
+//  virtual unless --realtime is given, so DELAYs cost nothing.
+//
+//    --realtime   use the wall clock for delay()/vTaskDelay()
+//    --fs DIR     LittleFS root (payload names resolve in DIR/payloads)
+//    --quiet      print only the summary line
+//    --boot-protocol  host selects boot protocol (no NKRO)
+//    --trace FILE write a binary HID trace (see hid_trace.h)
+//    --profile FILE write a per-line Chrome trace (see profiler.h)
+//    --leds MS:BITS the host's LED report at MS into the run (bit 0
+//                 Num, 1 Caps, 2 Scroll Lock; repeatable), for WAIT_FOR_*
+//    --button MS  press the WAIT_FOR_BUTTON button at MS, for 100 ms
+//
+// ============================================================
+
+// `pio test -e native` links the test's own main() instead
+#ifndef PIO_UNIT_TESTING
+
+#include "config.h"
+#include "ducky_parser.h"
+#include "hid_trace.h"
+#include "profiler.h"
+#include "hid_recorder.h"
+#include "host_clock.h"
+#include "storage_manager.h"
+#include "usb_hid.h"
+
+#include <LittleFS.h>
+#include <USBHID.h>
+#include <USBHIDKeyboard.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#define RUN_BUTTON_HOLD_MS 100 // --button
+
+static std::atomic<bool> sDone{false};
+static std::atomic<int> sLines{0};
+
+static void usage() {
+  fprintf(stderr,
+          "usage: ducky_run [--realtime] [--fs DIR] [--quiet] [--boot-protocol] "
+          "[--trace FILE] [--profile FILE] [--leds MS:BITS]... "
+          "[--button MS]... <script|name>\n");
+}
+
+static bool loadScript(const char *arg, String &script) {
+  std::ifstream in(arg, std::ios::binary);
+  if (in) {
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::string data = ss.str();
+    script = String();
+    script.concat(data.data(), data.size()); // may be a bytecode image
+    return true;
+  }
+  // Not a host file: try it as a payload name on the LittleFS root
+  if (payloadSize(arg) < 0)
+    return false;
+  script = readPayload(arg);
+  return true;
+}
+
+static void printReport(const HidReport &r) {
+  printf("%10.3f ms  %s ", r.us / 1000.0,
+         r.kind == HID_MOUSE    ? "mse"
+         : r.kind == HID_REPORT ? "hid"
+                                : "kbd");
+  for (int i = 0; i < r.len; i++)
+    printf(" %02x", r.data[i]);
+  printf("\n");
+}
+
+int main(int argc, char **argv) {
+  bool realtime = false;
+  bool quiet = false;
+  bool bootProtocol = false;
+  const char *target = nullptr;
+  const char *tracePath = nullptr;
+  const char *profilePath = nullptr;
+  std::vector<std::pair<uint32_t, int>> leds; // ms, bits
+  std::vector<uint32_t> presses;              // ms
+
+  for (int i = 1; i < argc; i++) {
+    String a = argv[i];
+    if (a == "--realtime") {
+      realtime = true;
+    } else if (a == "--quiet") {
+      quiet = true;
+    } else if (a == "--boot-protocol") {
+      bootProtocol = true;
+    } else if (a == "--fs" && i + 1 < argc) {
+      LittleFS.setRoot(argv[++i]);
+    } else if (a == "--trace" && i + 1 < argc) {
+      tracePath = argv[++i];
+    } else if (a == "--profile" && i + 1 < argc) {
+      profilePath = argv[++i];
+    } else if (a == "--leds" && i + 1 < argc && strchr(argv[i + 1], ':')) {
+      const char *arg = argv[++i];
+      leds.push_back({(uint32_t)atol(arg), atoi(strchr(arg, ':') + 1)});
+    } else if (a == "--button" && i + 1 < argc) {
+      presses.push_back(atol(argv[++i]));
+    } else if (!target && !a.startsWith("--")) {
+      target = argv[i];
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  if (!target) {
+    usage();
+    return 2;
+  }
+
+  hostClockUseVirtual(!realtime);
+  storageInit();
+
+  String script;
+  if (!loadScript(target, script)) {
+    fprintf(stderr, "ducky_run: cannot read '%s'\n", target);
+    return 1;
+  }
+
+  initUSB();
+  if (bootProtocol)
+    hostHidSetProtocol(0);
+  duckyInit();
+  hostHidClear();
+  hostClockReset();
+  if (profilePath && !profilerEnable(true)) {
+    fprintf(stderr, "ducky_run: cannot allocate profile buffer\n");
+    return 1;
+  }
+  if (tracePath && !hidTraceStart()) {
+    fprintf(stderr, "ducky_run: cannot allocate trace buffer\n");
+    return 1;
+  }
+
+  uint64_t t0 = hostClockMicros();
+  // The cooperating host's signals, seen by WAIT_FOR_* as they poll
+  for (auto &l : leds) {
+    int bits = l.second;
+    hostClockAt(t0 + l.first * 1000ULL, [bits] { hostHidSetLeds(bits); });
+  }
+  for (uint32_t ms : presses) {
+    hostClockAt(t0 + ms * 1000ULL,
+                [] { hostGpioSet(DUCKY_WAIT_BUTTON_PIN, LOW); });
+    hostClockAt(t0 + (ms + RUN_BUTTON_HOLD_MS) * 1000ULL,
+                [] { hostGpioSet(DUCKY_WAIT_BUTTON_PIN, HIGH); });
+  }
+  auto cb = [](int line, int total, DuckyStatus st) {
+    sLines = line;
+    if (st != DuckyStatus::RUNNING)
+      sDone = true;
+  };
+  if (!duckyExecute(script, cb)) {
+    fprintf(stderr, "ducky_run: parser busy\n");
+    return 1;
+  }
+  // Real sleep: delay() would advance the virtual clock
+  while (!sDone)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  uint64_t elapsed = hostClockMicros() - t0;
+
+  if (tracePath) {
+    hidTraceStop();
+    FILE *f = fopen(tracePath, "wb");
+    if (!f) {
+      fprintf(stderr, "ducky_run: cannot write %s\n", tracePath);
+      return 1;
+    }
+    fwrite(hidTraceData(), 1, hidTraceSize(), f);
+    fclose(f);
+    if (hidTraceTruncated())
+      fprintf(stderr, "ducky_run: trace truncated at %zu bytes\n",
+              hidTraceSize());
+  }
+
+  if (profilePath) {
+    FILE *f = fopen(profilePath, "w");
+    if (!f) {
+      fprintf(stderr, "ducky_run: cannot write %s\n", profilePath);
+      return 1;
+    }
+    ProfileJsonWriter w;
+    uint8_t buf[512];
+    size_t n;
+    while ((n = w.read(buf, sizeof(buf))) > 0)
+      fwrite(buf, 1, n, f);
+    fclose(f);
+  }
+
+  std::vector<HidReport> reports = hostHidReports();
+  if (!quiet) {
+    for (auto &r : reports)
+      printReport(r);
+  }
+  DuckyStatus st = duckyGetStatus();
+  printf("# %d lines, %zu reports, %.3f ms %s, status %s\n", sLines.load(),
+         reports.size(), elapsed / 1000.0, realtime ? "real" : "virtual",
+         st == DuckyStatus::FINISHED ? "finished"
+         : st == DuckyStatus::ERROR  ? "error"
+                                     : "aborted");
+  if (st == DuckyStatus::ERROR)
+    fprintf(stderr, "ducky_run: %s\n", duckyLastError());
+  return st == DuckyStatus::FINISHED ? 0 : 1;
+}
+
+#endif // PIO_UNIT_TESTING
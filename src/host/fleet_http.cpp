@@ -0,0 +1,520 @@
+// ============================================================
+//  Fleet HTTP — Concurrent REST Client and Message Helpers
+// ============================================================
+
+#include "fleet_http.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define HTTP_MAX_WAIT_MS 100 // epoll_wait slice: timeouts and delays
+
+static uint64_t nowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+struct HttpPool::Conn {
+  HttpRequest req;
+  HttpDone done;
+  int fd = -1;
+  bool connected = false;
+  std::string out; // request bytes
+  size_t sent = 0;
+  std::string in;  // response bytes so far
+  uint64_t deadlineMs = 0;
+};
+
+HttpPool::HttpPool(int maxConns, int timeoutMs)
+    : _ep(epoll_create1(0)), _maxConns(maxConns < 1 ? 1 : maxConns),
+      _timeoutMs(timeoutMs) {}
+
+HttpPool::~HttpPool() {
+  for (auto &kv : _open) {
+    close(kv.first);
+    delete kv.second;
+  }
+  close(_ep);
+}
+
+void HttpPool::submit(const HttpRequest &req, HttpDone done, int delayMs) {
+  _queue.push_back({req, done, nowMs() + (delayMs > 0 ? delayMs : 0)});
+}
+
+void HttpPool::run() {
+  while (!_queue.empty() || !_open.empty()) {
+    // Start what is due, up to the connection limit
+    uint64_t now = nowMs();
+    for (size_t i = 0; i < _queue.size() && (int)_open.size() < _maxConns;) {
+      if (_queue[i].dueMs <= now) {
+        Pending p = std::move(_queue[i]);
+        _queue.erase(_queue.begin() + i);
+        start(p);
+      } else {
+        i++;
+      }
+    }
+
+    epoll_event events[64];
+    int n = epoll_wait(_ep, events, 64, HTTP_MAX_WAIT_MS);
+    for (int i = 0; i < n; i++)
+      step((Conn *)events[i].data.ptr, events[i].events);
+
+    now = nowMs();
+    std::vector<Conn *> expired;
+    for (auto &kv : _open) {
+      if (kv.second->deadlineMs <= now)
+        expired.push_back(kv.second);
+    }
+    for (Conn *c : expired)
+      finish(c, "timeout");
+  }
+}
+
+void HttpPool::start(Pending &p) {
+  Conn *c = new Conn;
+  c->req = std::move(p.req);
+  c->done = std::move(p.done);
+  c->deadlineMs = nowMs() + _timeoutMs;
+
+  // Request bytes
+  const HttpRequest &r = c->req;
+  c->out = r.method + " " + r.path + " HTTP/1.1\r\nHost: " + r.host + ":" +
+           std::to_string(r.port) + "\r\nConnection: close\r\n";
+  if (!r.body.empty() || r.method != "GET")
+    c->out += "Content-Length: " + std::to_string(r.body.size()) + "\r\n";
+  for (auto &h : r.headers)
+    c->out += h.first + ": " + h.second + "\r\n";
+  c->out += "\r\n";
+  c->out += r.body;
+
+  addrinfo hints = {}, *ai = nullptr;
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  std::string port = std::to_string(r.port);
+  if (getaddrinfo(r.host.c_str(), port.c_str(), &hints, &ai) != 0 || !ai) {
+    HttpResponse res;
+    res.error = "cannot resolve " + r.host;
+    c->done(res);
+    delete c;
+    return;
+  }
+  c->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  int rc = c->fd < 0 ? -1 : connect(c->fd, ai->ai_addr, ai->ai_addrlen);
+  freeaddrinfo(ai);
+  if (c->fd < 0 || (rc < 0 && errno != EINPROGRESS)) {
+    HttpResponse res;
+    res.error = std::string("connect: ") + strerror(errno);
+    if (c->fd >= 0)
+      close(c->fd);
+    c->done(res);
+    delete c;
+    return;
+  }
+
+  epoll_event ev = {};
+  ev.events = EPOLLOUT;
+  ev.data.ptr = c;
+  epoll_ctl(_ep, EPOLL_CTL_ADD, c->fd, &ev);
+  _open[c->fd] = c;
+}
+
+void HttpPool::step(Conn *c, uint32_t events) {
+  if (!c->connected) {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+    if (err) {
+      std::string why = std::string("connect: ") + strerror(err);
+      finish(c, why.c_str());
+      return;
+    }
+    c->connected = true;
+  }
+
+  if (c->sent < c->out.size()) {
+    ssize_t n = send(c->fd, c->out.data() + c->sent, c->out.size() - c->sent,
+                     MSG_NOSIGNAL);
+    if (n < 0 && errno != EAGAIN) {
+      finish(c, "send failed");
+      return;
+    }
+    if (n > 0)
+      c->sent += n;
+    if (c->sent == c->out.size()) {
+      epoll_event ev = {};
+      ev.events = EPOLLIN;
+      ev.data.ptr = c;
+      epoll_ctl(_ep, EPOLL_CTL_MOD, c->fd, &ev);
+    }
+    return;
+  }
+
+  if (!(events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+    return;
+  char buf[4096];
+  for (;;) {
+    ssize_t n = recv(c->fd, buf, sizeof(buf), 0);
+    if (n > 0) {
+      c->in.append(buf, n);
+      continue;
+    }
+    if (n == 0) {
+      complete(c); // EOF: the whole response is in
+      return;
+    }
+    if (errno == EAGAIN)
+      break;
+    finish(c, "receive failed");
+    return;
+  }
+
+  // Done early if Content-Length says so
+  size_t bodyStart;
+  std::string start;
+  HttpHeaders headers;
+  if (httpParseHead(c->in, bodyStart, start, headers)) {
+    std::string cl = httpHeader(headers, "Content-Length");
+    if (!cl.empty() && c->in.size() - bodyStart >= std::stoul(cl))
+      complete(c);
+  }
+}
+
+// Remove `c`, then report `error` (nullptr: a parsed response in c->in)
+void HttpPool::finish(Conn *c, const char *error) {
+  epoll_ctl(_ep, EPOLL_CTL_DEL, c->fd, nullptr);
+  close(c->fd);
+  _open.erase(c->fd);
+
+  HttpResponse res;
+  if (error) {
+    res.error = error;
+  } else {
+    size_t bodyStart;
+    std::string start;
+    if (!httpParseHead(c->in, bodyStart, start, res.headers) ||
+        start.compare(0, 5, "HTTP/") != 0 || start.find(' ') == std::string::npos) {
+      res.error = "bad response";
+    } else {
+      res.status = atoi(start.c_str() + start.find(' ') + 1);
+      res.body = c->in.substr(bodyStart);
+      std::string cl = httpHeader(res.headers, "Content-Length");
+      if (!cl.empty() && res.body.size() > std::stoul(cl))
+        res.body.resize(std::stoul(cl));
+    }
+  }
+
+  // Chunked: size line, data, CRLF ... 0 CRLF CRLF
+  if (res.status &&
+      strcasecmp(httpHeader(res.headers, "Transfer-Encoding").c_str(),
+                 "chunked") == 0) {
+    std::string body;
+    size_t pos = 0;
+    for (;;) {
+      size_t eol = res.body.find("\r\n", pos);
+      if (eol == std::string::npos)
+        break;
+      size_t len = strtoul(res.body.c_str() + pos, nullptr, 16);
+      if (len == 0 || eol + 2 + len > res.body.size())
+        break;
+      body.append(res.body, eol + 2, len);
+      pos = eol + 2 + len + 2;
+    }
+    res.body = body;
+  }
+
+  c->done(res); // may submit more
+  delete c;
+}
+
+void HttpPool::complete(Conn *c) { finish(c, nullptr); }
+
+// ================================================================
+//  Message Helpers
+// ================================================================
+
+bool httpParseEndpoint(const std::string &s, std::string &host,
+                       uint16_t &port, uint16_t defaultPort) {
+  size_t colon = s.rfind(':');
+  host = s.substr(0, colon);
+  port = defaultPort;
+  if (colon != std::string::npos) {
+    char *end;
+    long p = strtol(s.c_str() + colon + 1, &end, 10);
+    if (*end || p < 1 || p > 65535)
+      return false;
+    port = p;
+  }
+  return !host.empty();
+}
+
+bool httpParseHead(const std::string &buf, size_t &bodyStart,
+                   std::string &startLine, HttpHeaders &headers) {
+  size_t end = buf.find("\r\n\r\n");
+  if (end == std::string::npos)
+    return false;
+  bodyStart = end + 4;
+  headers.clear();
+  size_t pos = buf.find("\r\n");
+  startLine = buf.substr(0, pos);
+  while (pos < end) {
+    size_t next = buf.find("\r\n", pos + 2);
+    std::string line = buf.substr(pos + 2, next - pos - 2);
+    size_t colon = line.find(':');
+    if (colon != std::string::npos) {
+      size_t v = line.find_first_not_of(' ', colon + 1);
+      headers.push_back({line.substr(0, colon),
+                         v == std::string::npos ? "" : line.substr(v)});
+    }
+    pos = next;
+  }
+  return true;
+}
+
+std::string httpHeader(const HttpHeaders &headers, const char *name) {
+  for (auto &h : headers) {
+    if (strcasecmp(h.first.c_str(), name) == 0)
+      return h.second;
+  }
+  return "";
+}
+
+const char *httpReason(int status) {
+  switch (status) {
+  case 200:
+    return "OK";
+  case 304:
+    return "Not Modified";
+  case 400:
+    return "Bad Request";
+  case 404:
+    return "Not Found";
+  case 409:
+    return "Conflict";
+  case 412:
+    return "Precondition Failed";
+  case 413:
+    return "Payload Too Large";
+  case 422:
+    return "Unprocessable Entity";
+  default:
+    return status < 500 ? "Error" : "Internal Server Error";
+  }
+}
+
+// ================================================================
+//  JSON
+// ================================================================
+
+std::string jsonQuote(const std::string &s) {
+  std::string out = "\"";
+  for (unsigned char ch : s) {
+    switch (ch) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      if (ch < 0x20) {
+        char esc[8];
+        snprintf(esc, sizeof(esc), "\\u%04x", ch);
+        out += esc;
+      } else {
+        out += (char)ch;
+      }
+    }
+  }
+  return out + "\"";
+}
+
+static void skipSpace(const std::string &j, size_t &p) {
+  while (p < j.size() && isspace((unsigned char)j[p]))
+    p++;
+}
+
+// String at `p` (on its opening quote); unescaped into `out` if given
+static bool readString(const std::string &j, size_t &p, std::string *out) {
+  if (p >= j.size() || j[p] != '"')
+    return false;
+  for (p++; p < j.size(); p++) {
+    char ch = j[p];
+    if (ch == '"') {
+      p++;
+      return true;
+    }
+    if (ch == '\\' && ++p < j.size()) {
+      ch = j[p];
+      if (ch == 'n')
+        ch = '\n';
+      else if (ch == 't')
+        ch = '\t';
+      else if (ch == 'r')
+        ch = '\r';
+      else if (ch == 'u' && p + 4 < j.size()) {
+        ch = (char)strtol(j.substr(p + 1, 4).c_str(), nullptr, 16);
+        p += 4;
+      }
+    }
+    if (out)
+      *out += ch;
+  }
+  return false;
+}
+
+static bool skipValue(const std::string &j, size_t &p) {
+  skipSpace(j, p);
+  if (p >= j.size())
+    return false;
+  if (j[p] == '"')
+    return readString(j, p, nullptr);
+  if (j[p] == '{' || j[p] == '[') {
+    char close = j[p] == '{' ? '}' : ']';
+    p++;
+    skipSpace(j, p);
+    if (p < j.size() && j[p] == close) {
+      p++;
+      return true;
+    }
+    for (;;) {
+      if (close == '}') {
+        skipSpace(j, p);
+        if (!readString(j, p, nullptr))
+          return false;
+        skipSpace(j, p);
+        if (p >= j.size() || j[p++] != ':')
+          return false;
+      }
+      if (!skipValue(j, p))
+        return false;
+      skipSpace(j, p);
+      if (p >= j.size())
+        return false;
+      if (j[p] == close) {
+        p++;
+        return true;
+      }
+      if (j[p++] != ',')
+        return false;
+    }
+  }
+  while (p < j.size() && !strchr(",}] \t\r\n", j[p]))
+    p++; // number, true, false, null
+  return true;
+}
+
+// Move `p` from an object's '{' to the value of `key`
+static bool findKey(const std::string &j, size_t &p, const std::string &key) {
+  skipSpace(j, p);
+  if (p >= j.size() || j[p] != '{')
+    return false;
+  p++;
+  for (;;) {
+    skipSpace(j, p);
+    std::string k;
+    if (!readString(j, p, &k))
+      return false;
+    skipSpace(j, p);
+    if (p >= j.size() || j[p++] != ':')
+      return false;
+    skipSpace(j, p);
+    if (k == key)
+      return true;
+    if (!skipValue(j, p))
+      return false;
+    skipSpace(j, p);
+    if (p >= j.size() || j[p++] != ',')
+      return false;
+  }
+}
+
+static bool locate(const std::string &j, const char *path, size_t &p) {
+  p = 0;
+  std::string rest = path;
+  while (!rest.empty()) {
+    size_t dot = rest.find('.');
+    if (!findKey(j, p, rest.substr(0, dot)))
+      return false;
+    rest = dot == std::string::npos ? "" : rest.substr(dot + 1);
+  }
+  skipSpace(j, p);
+  return p < j.size();
+}
+
+bool jsonGet(const std::string &json, const char *path, std::string &out) {
+  size_t p;
+  if (!locate(json, path, p))
+    return false;
+  out.clear();
+  if (json[p] == '"')
+    return readString(json, p, &out);
+  size_t start = p;
+  if (!skipValue(json, p))
+    return false;
+  out = json.substr(start, p - start);
+  return true;
+}
+
+bool jsonStrings(const std::string &json, const char *path,
+                 std::vector<std::string> &out) {
+  size_t p;
+  if (!locate(json, path, p) || json[p] != '[')
+    return false;
+  out.clear();
+  p++;
+  for (;;) {
+    skipSpace(json, p);
+    if (p < json.size() && json[p] == ']')
+      return true;
+    std::string s;
+    if (!readString(json, p, &s))
+      return false;
+    out.push_back(s);
+    skipSpace(json, p);
+    if (p < json.size() && json[p] == ',')
+      p++;
+  }
+}
+
+bool jsonItems(const std::string &json, const char *path,
+               std::vector<std::string> &out) {
+  size_t p;
+  if (!locate(json, path, p) || json[p] != '[')
+    return false;
+  out.clear();
+  p++;
+  for (;;) {
+    skipSpace(json, p);
+    if (p < json.size() && json[p] == ']')
+      return true;
+    size_t start = p;
+    if (!skipValue(json, p))
+      return false;
+    out.push_back(json.substr(start, p - start));
+    skipSpace(json, p);
+    if (p < json.size() && json[p] == ',')
+      p++;
+    else if (p >= json.size() || json[p] != ']')
+      return false;
+  }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+// ============================================================
+//  Fleet HTTP — Concurrent REST Client and Message Helpers
+// ============================================================
+//
+//  ducky_fleet drives a rack of devices from one thread. Every
+//  request is a non-blocking socket in one epoll set, at most
+//  `maxConns` open at once and the rest queued. A request's
+//  callback runs on that thread when its response (or error) is
+//  in, and may submit follow-ups, so each device's sequence
+//  (check, upload, run, poll) chains without threads or locks
+//  while all devices progress in parallel.
+//
+//  One request per connection ("Connection: close"). Responses
+//  are read to Content-Length or EOF; chunked bodies are decoded.
+//
+//  The parsing helpers are shared with ducky_mockdev; the JSON
+//  reader handles the device's responses, not JSON in general
+//  (no \u escapes beyond ASCII).
+//
+// ============================================================
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef std::vector<std::pair<std::string, std::string>> HttpHeaders;
+
+struct HttpRequest {
+  std::string host; // name or IPv4 address
+  uint16_t port = 80;
+  std::string method = "GET";
+  std::string path;
+  HttpHeaders headers; // besides Host, Connection, Content-Length
+  std::string body;
+};
+
+struct HttpResponse {
+  int status = 0;    // 0 = no response, see `error`
+  std::string error; // "timeout", "connect: ...", "bad response"
+  HttpHeaders headers;
+  std::string body;
+};
+
+typedef std::function<void(const HttpResponse &res)> HttpDone;
+
+class HttpPool {
+public:
+  /// At most `maxConns` connections at once; each request gets
+  /// `timeoutMs` from connect to the last byte.
+  HttpPool(int maxConns, int timeoutMs);
+  ~HttpPool();
+
+  /// Queue `req`, started no sooner than `delayMs` from now.
+  /// `done` runs inside run().
+  void submit(const HttpRequest &req, HttpDone done, int delayMs = 0);
+
+  /// Serve requests until none are queued or open.
+  void run();
+
+private:
+  struct Conn;
+  struct Pending {
+    HttpRequest req;
+    HttpDone done;
+    uint64_t dueMs;
+  };
+
+  void start(Pending &p);
+  void step(Conn *c, uint32_t events);
+  void finish(Conn *c, const char *error);
+  void complete(Conn *c);
+
+  int _ep;
+  int _maxConns;
+  int _timeoutMs;
+  std::deque<Pending> _queue;
+  std::map<int, Conn *> _open; // by socket
+};
+
+/// Split "host[:port]". False if the host is empty or the port bad.
+bool httpParseEndpoint(const std::string &s, std::string &host,
+                       uint16_t &port, uint16_t defaultPort = 80);
+
+/// Parse a message head (start line, headers, CRLF CRLF) at the
+/// front of `buf`. `bodyStart` gets the offset just past it. False
+/// while the head is incomplete.
+bool httpParseHead(const std::string &buf, size_t &bodyStart,
+                   std::string &startLine, HttpHeaders &headers);
+
+/// Value of header `name`, case-insensitive ("" if absent).
+std::string httpHeader(const HttpHeaders &headers, const char *name);
+
+/// Reason phrase for a status code ("OK", "Not Found", ...).
+const char *httpReason(int status);
+
+/// `s` as a quoted, escaped JSON string.
+std::string jsonQuote(const std::string &s);
+
+/// Value at `path` ("a.b" walks nested objects). Strings come back
+/// unescaped, anything else as its JSON text. False if absent.
+bool jsonGet(const std::string &json, const char *path, std::string &out);
+
+/// The strings of the array at `path`. False if it isn't one.
+bool jsonStrings(const std::string &json, const char *path,
+                 std::vector<std::string> &out);
+
+/// The elements of the array at `path`, each as its JSON text (for
+/// jsonGet() on object elements). False if it isn't one.
+bool jsonItems(const std::string &json, const char *path,
+               std::vector<std::string> &out);
@@ -0,0 +1,239 @@
+// ============================================================
+//  Live Channel — Low-Latency Keyboard/Mouse over WebSocket
+// ============================================================
+
+#include "live_channel.h"
+#include "config.h"
+#include "ducky_parser.h"
+#include "task_placement.h"
+#include "usb_hid.h"
+
+#include <AsyncTCP.h>
+#include <errno.h>
+#include <lwip/sockets.h>
+
+// --- One queued event (fixed size, copied into the FreeRTOS queue) ---
+struct LiveEvent {
+  uint8_t type;
+  uint8_t len;
+  uint32_t seq;
+  uint32_t client;
+  uint32_t recvUs;
+  uint8_t data[LIVE_TEXT_MAX];
+};
+
+// --- One ack on its way back (HID task → AsyncTCP task) ---
+struct LiveAck {
+  uint32_t client;
+  uint32_t seq;
+  uint32_t latencyUs;
+  uint8_t result;
+};
+
+static AsyncWebSocket sWs(LIVE_WS_PATH);
+static QueueHandle_t sQueue = nullptr;
+static QueueHandle_t sAcks = nullptr;
+static TaskHandle_t sTaskHandle = nullptr;
+
+// AsyncWebSocket isn't thread-safe: only the AsyncTCP task may use it.
+// The HID task queues its acks and rings this loopback doorbell; the
+// byte arrives as a TCP event on the AsyncTCP task, which sends them.
+static AsyncServer sDoorbell(IPAddress(127, 0, 0, 1), LIVE_DOORBELL_PORT);
+static int sBell = -1; // HID task's end (lwIP sockets are thread-safe)
+
+static portMUX_TYPE sStatsMux = portMUX_INITIALIZER_UNLOCKED;
+static LiveStats sStats = {};
+static uint64_t sTotalUs = 0;
+
+static void sendAck(uint32_t client, uint32_t seq, LiveResult result,
+                    uint32_t latencyUs) {
+  uint8_t msg[10] = {LIVE_ACK};
+  for (int i = 0; i < 4; i++) {
+    msg[1 + i] = seq >> (8 * i);
+    msg[6 + i] = latencyUs >> (8 * i);
+  }
+  msg[5] = result;
+  sWs.binary(client, msg, sizeof(msg));
+}
+
+static void countRejected() {
+  portENTER_CRITICAL(&sStatsMux);
+  sStats.rejected++;
+  portEXIT_CRITICAL(&sStatsMux);
+}
+
+// Reject on the AsyncTCP task: answer at once
+static void reject(uint32_t client, uint32_t seq, LiveResult result) {
+  countRejected();
+  sendAck(client, seq, result, 0);
+}
+
+// AsyncTCP task: send the acks the HID task has finished
+static void sendQueuedAcks() {
+  LiveAck a;
+  while (xQueueReceive(sAcks, &a, 0) == pdTRUE)
+    sendAck(a.client, a.seq, (LiveResult)a.result, a.latencyUs);
+}
+
+// HID task: wake the AsyncTCP task (connecting on first use)
+static void ringDoorbell() {
+  if (sBell < 0) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(LIVE_DOORBELL_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0)
+      return;
+    if (connect(fd, (sockaddr *)&addr, sizeof(addr)) != 0) {
+      close(fd);
+      return; // the next ring retries; queued acks wait for it
+    }
+    sBell = fd;
+  }
+  uint8_t ring = 1;
+  if (send(sBell, &ring, 1, MSG_DONTWAIT) < 0 && errno != EAGAIN &&
+      errno != EWOULDBLOCK) {
+    close(sBell);
+    sBell = -1;
+  }
+}
+
+// HID task: hand an ack to the AsyncTCP task
+static void queueAck(uint32_t client, uint32_t seq, LiveResult result,
+                     uint32_t latencyUs) {
+  LiveAck a = {client, seq, latencyUs, result};
+  xQueueSend(sAcks, &a, 0); // full: the AsyncTCP task is stuck anyway
+  ringDoorbell();
+}
+
+// ================================================================
+//  HID Task — drains the queue straight into the HID layer
+// ================================================================
+
+static void liveTask(void *param) {
+  LiveEvent ev;
+  while (true) {
+    if (placementMoveDue(TASK_ROLE_LIVE_HID)) {
+      placementRespawn(TASK_ROLE_LIVE_HID); // moved: carry on on the new core
+      vTaskDelete(nullptr);
+      return;
+    }
+    if (xQueueReceive(sQueue, &ev, pdMS_TO_TICKS(1000)) != pdTRUE)
+      continue;
+    // The HID output is the script's while one runs (usb_hid.h)
+    if (duckyIsRunning() || !hidAcquire(0)) {
+      countRejected();
+      queueAck(ev.client, ev.seq, LIVE_BUSY, 0);
+      continue;
+    }
+
+    uint32_t latency = micros() - ev.recvUs;
+    switch (ev.type) {
+    case LIVE_KEY:
+      pressKey(ev.data[0], ev.data[1]);
+      break;
+    case LIVE_TEXT: {
+      String text;
+      text.concat((const char *)ev.data, ev.len);
+      typeString(text);
+      break;
+    }
+    case LIVE_MOUSE:
+      if (ev.data[0] || ev.data[1])
+        mouseMove((int8_t)ev.data[0], (int8_t)ev.data[1]);
+      if (ev.data[2])
+        mouseScroll((int8_t)ev.data[2]);
+      if (ev.data[3] & 1)
+        mouseClick(0);
+      if (ev.data[3] & 2)
+        mouseClick(1);
+      if (ev.data[3] & 4)
+        mouseClick(2);
+      break;
+    }
+    hidRelease();
+
+    portENTER_CRITICAL(&sStatsMux);
+    sStats.events++;
+    sStats.lastUs = latency;
+    if (latency > sStats.maxUs)
+      sStats.maxUs = latency;
+    sTotalUs += latency;
+    sStats.avgUs = sTotalUs / sStats.events;
+    portEXIT_CRITICAL(&sStatsMux);
+
+    queueAck(ev.client, ev.seq, LIVE_OK, latency);
+  }
+}
+
+// ================================================================
+//  WebSocket Events (AsyncTCP task — never blocks on HID)
+// ================================================================
+
+static void onWsEvent(AsyncWebSocket *ws, AsyncWebSocketClient *client,
+                      AwsEventType type, void *arg, uint8_t *data,
+                      size_t len) {
+  if (type == WS_EVT_CONNECT)
+    sWs.cleanupClients(); // over the client limit: close the oldest
+  if (type != WS_EVT_DATA)
+    return;
+
+  // Only single-frame binary messages; events are a few bytes each
+  AwsFrameInfo *info = (AwsFrameInfo *)arg;
+  if (!info->final || info->index != 0 || info->len != len || len < 5 ||
+      info->opcode != WS_BINARY) {
+    return;
+  }
+
+  LiveEvent ev;
+  ev.recvUs = micros();
+  ev.client = client->id();
+  ev.type = data[0];
+  ev.seq = data[1] | data[2] << 8 | data[3] << 16 | (uint32_t)data[4] << 24;
+  ev.len = len - 5;
+
+  size_t need = ev.type == LIVE_KEY ? 2 : ev.type == LIVE_MOUSE ? 4 : 1;
+  if (ev.type < LIVE_KEY || ev.type > LIVE_MOUSE || ev.len < need ||
+      ev.len > LIVE_TEXT_MAX) {
+    reject(ev.client, ev.seq, LIVE_BAD);
+    return;
+  }
+  memcpy(ev.data, data + 5, ev.len);
+
+  if (xQueueSend(sQueue, &ev, 0) != pdTRUE) {
+    reject(ev.client, ev.seq, LIVE_OVERFLOW);
+  }
+}
+
+// ================================================================
+//  Public API
+// ================================================================
+
+void liveChannelInit(AsyncWebServer &server) {
+  sQueue = xQueueCreate(LIVE_QUEUE_LEN, sizeof(LiveEvent));
+  sAcks = xQueueCreate(LIVE_QUEUE_LEN, sizeof(LiveAck));
+  sDoorbell.onClient(
+      [](void *, AsyncClient *c) {
+        c->setNoDelay(true);
+        c->onData([](void *, AsyncClient *, void *, size_t) {
+          sendQueuedAcks();
+        });
+        c->onDisconnect([](void *, AsyncClient *c) { delete c; });
+      },
+      nullptr);
+  sDoorbell.begin();
+  placementSpawn(TASK_ROLE_LIVE_HID, liveTask, "LiveHID", LIVE_TASK_STACK,
+                 &sTaskHandle);
+  sWs.onEvent(onWsEvent);
+  server.addHandler(&sWs);
+}
+
+LiveStats liveGetStats() {
+  portENTER_CRITICAL(&sStatsMux);
+  LiveStats st = sStats;
+  portEXIT_CRITICAL(&sStatsMux);
+  st.clients = sWs.count();
+  st.queued = sQueue ? uxQueueMessagesWaiting(sQueue) : 0;
+  return st;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+// ============================================================
+//  Live Channel — Low-Latency Keyboard/Mouse over WebSocket
+// ============================================================
+//
+//  Binary messages on LIVE_WS_PATH (integers little-endian):
+//
+//    browser → device   u8 type, u32 seq, payload
+//      LIVE_KEY    u8 keycode, u8 modifiers     (HID codes)
+//      LIVE_TEXT   ASCII bytes (≤ LIVE_TEXT_MAX)
+//      LIVE_MOUSE  i8 dx, i8 dy, i8 wheel, u8 click (1=L 2=R 4=M)
+//
+//    device → browser   u8 LIVE_ACK, u32 seq, u8 LiveResult,
+//                       u32 µs from receipt to first HID report
+//
+//  Events are queued to a dedicated HID task; the ack is sent once
+//  the event's reports have gone out. While a script (or another
+//  holder of the HID output, usb_hid.h) is using it, events are
+//  answered LIVE_BUSY.
+//
+// ============================================================
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+enum LiveType : uint8_t {
+  LIVE_KEY = 1,
+  LIVE_TEXT = 2,
+  LIVE_MOUSE = 3,
+  LIVE_ACK = 0x80
+};
+
+enum LiveResult : uint8_t {
+  LIVE_OK = 0,
+  LIVE_BUSY = 1,     // a script is running
+  LIVE_BAD = 2,      // malformed message
+  LIVE_OVERFLOW = 3  // queue full
+};
+
+/// Latency statistics since boot (receipt → first HID report).
+struct LiveStats {
+  uint32_t events;
+  uint32_t rejected;
+  uint32_t avgUs;
+  uint32_t maxUs;
+  uint32_t lastUs;
+  uint32_t clients;
+  uint32_t queued; // events waiting for the HID task
+};
+
+/// Register the WebSocket endpoint and start the HID task.
+void liveChannelInit(AsyncWebServer &server);
+
+/// Snapshot the latency statistics.
+LiveStats liveGetStats();
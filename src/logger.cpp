@@ -0,0 +1,309 @@
+// ============================================================
+//  Logger — Deferred Binary Logging
+// ============================================================
+
+#include "logger.h"
+#include "config.h"
+#include "task_placement.h"
+
+#include <LittleFS.h>
+#include <atomic>
+
+#define LOG_CORES 2
+#define LOG_LINE_MAX 256
+
+static_assert((LOG_RING_LEN & (LOG_RING_LEN - 1)) == 0,
+              "LOG_RING_LEN must be a power of two");
+
+// Slot `i` is free for position p when seq == p, holds the record
+// for p when seq == p + 1, and is freed for the next lap by setting
+// seq = p + LOG_RING_LEN.
+struct LogRecord {
+  std::atomic<uint32_t> seq;
+  uint32_t ms;
+  const char *fmt;
+  uint8_t len;
+  uint8_t data[LOG_ARG_BYTES];
+};
+
+struct LogRing {
+  std::atomic<uint32_t> head{0}; // next position to reserve
+  uint32_t tail = 0;             // next position to drain (drain task only)
+  LogRecord slots[LOG_RING_LEN];
+
+  LogRing() {
+    for (uint32_t i = 0; i < LOG_RING_LEN; i++)
+      slots[i].seq.store(i, std::memory_order_relaxed);
+  }
+};
+
+static LogRing sRings[LOG_CORES];
+static std::atomic<uint8_t> sSinks{0};
+static std::atomic<uint32_t> sWritten{0};
+static std::atomic<uint32_t> sDropped{0};
+static std::atomic<uint32_t> sDrained{0};
+static std::atomic<uint32_t> sRotations{0};
+static TaskHandle_t sTaskHandle = nullptr;
+static File sFile;
+
+// ================================================================
+//  Producer side
+// ================================================================
+
+void LogPacker::raw(const void *p, size_t n) {
+  if (len + n > LOG_ARG_BYTES) {
+    len = LOG_ARG_BYTES; // later arguments decode as missing
+    return;
+  }
+  memcpy(buf + len, p, n);
+  len += n;
+}
+
+void LogPacker::put(const char *s) {
+  if (!s)
+    s = "(null)";
+  size_t avail = LOG_ARG_BYTES - len;
+  if (avail == 0)
+    return;
+  size_t n = strnlen(s, avail - 1);
+  memcpy(buf + len, s, n);
+  buf[len + n] = 0;
+  len += n + 1;
+}
+
+void logCommit(const char *fmt, const uint8_t *args, size_t len) {
+  uint32_t ms = millis();
+  LogRing &r = sRings[xPortGetCoreID() % LOG_CORES];
+
+  uint32_t pos = r.head.load(std::memory_order_relaxed);
+  LogRecord *rec;
+  for (;;) {
+    rec = &r.slots[pos & (LOG_RING_LEN - 1)];
+    int32_t dif =
+        (int32_t)(rec->seq.load(std::memory_order_acquire) - pos);
+    if (dif == 0) {
+      if (r.head.compare_exchange_weak(pos, pos + 1,
+                                       std::memory_order_relaxed))
+        break;
+    } else if (dif < 0) {
+      sDropped.fetch_add(1, std::memory_order_relaxed);
+      return; // full: the drain task is behind
+    } else {
+      pos = r.head.load(std::memory_order_relaxed);
+    }
+  }
+
+  rec->ms = ms;
+  rec->fmt = fmt;
+  rec->len = len;
+  memcpy(rec->data, args, len);
+  rec->seq.store(pos + 1, std::memory_order_release);
+  sWritten.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ================================================================
+//  Formatting
+// ================================================================
+
+// Next argument of `size` bytes, or false if the record ran out.
+static bool takeArg(const LogRecord &rec, size_t &pos, void *out,
+                    size_t size) {
+  if (pos + size > rec.len)
+    return false;
+  memcpy(out, rec.data + pos, size);
+  pos += size;
+  return true;
+}
+
+// Expand rec.fmt against the packed arguments into `out`.
+static size_t formatRecord(const LogRecord &rec, char *out, size_t cap) {
+  size_t n = 0, arg = 0;
+  auto room = [&]() { return n < cap ? cap - n : 0; };
+  auto emit = [&](int w) { // snprintf result → bytes actually written
+    if (w > 0 && room())
+      n += (size_t)w < room() ? (size_t)w : room() - 1;
+  };
+
+  for (const char *p = rec.fmt; *p && n + 1 < cap; p++) {
+    if (*p != '%') {
+      out[n++] = *p;
+      continue;
+    }
+    if (p[1] == '%') {
+      out[n++] = '%';
+      p++;
+      continue;
+    }
+
+    // %[flags][width][.precision][length]conv — rebuilt with our own
+    // length modifier, since the packed size is what counts
+    char spec[24] = "%";
+    size_t s = 1;
+    const char *q = p + 1;
+    while (*q && strchr("-+ #0123456789.", *q) && s < sizeof(spec) - 4)
+      spec[s++] = *q++;
+    size_t size = 4;
+    if (*q == 'h') {
+      while (*q == 'h')
+        q++;
+    } else if (*q == 'l') {
+      size = q[1] == 'l' ? 8 : sizeof(long);
+      q += q[1] == 'l' ? 2 : 1;
+    } else if (*q == 'z' || *q == 't') {
+      size = sizeof(size_t);
+      q++;
+    } else if (*q == 'j') {
+      size = 8;
+      q++;
+    } else if (*q == 'L') {
+      q++;
+    }
+    char conv = *q;
+    if (!conv)
+      break;
+    p = q;
+
+    bool ok = true;
+    if (strchr("diouxXc", conv)) {
+      if (size == 8) {
+        spec[s++] = 'l';
+        spec[s++] = 'l';
+      }
+      spec[s++] = conv;
+      spec[s] = 0;
+      uint64_t v64;
+      uint32_t v32;
+      if (size == 8 && (ok = takeArg(rec, arg, &v64, 8)))
+        emit(snprintf(out + n, room(), spec, (unsigned long long)v64));
+      else if (size != 8 && (ok = takeArg(rec, arg, &v32, 4)))
+        emit(snprintf(out + n, room(), spec, (unsigned)v32));
+    } else if (strchr("fFeEgGaA", conv)) {
+      spec[s++] = conv;
+      spec[s] = 0;
+      double v;
+      if ((ok = takeArg(rec, arg, &v, sizeof(v))))
+        emit(snprintf(out + n, room(), spec, v));
+    } else if (conv == 's') {
+      spec[s++] = 's';
+      spec[s] = 0;
+      if ((ok = arg < rec.len)) {
+        const char *str = (const char *)rec.data + arg;
+        arg += strnlen(str, rec.len - arg) + 1;
+        emit(snprintf(out + n, room(), spec, str));
+      }
+    } else if (conv == 'p') {
+      void *v;
+      if ((ok = takeArg(rec, arg, &v, sizeof(v))))
+        emit(snprintf(out + n, room(), "%p", v));
+    } else {
+      out[n++] = conv; // unknown conversion: print it as-is
+    }
+    if (!ok)
+      emit(snprintf(out + n, room(), "<?>")); // record ran out of arguments
+  }
+  out[n < cap ? n : cap - 1] = 0;
+  return n;
+}
+
+// ================================================================
+//  Drain task
+// ================================================================
+
+static void writeFile(const char *line, size_t len) {
+  if (!sFile) {
+    if (!LittleFS.exists("/logs"))
+      LittleFS.mkdir("/logs");
+    sFile = LittleFS.open(LOG_FILE, "a");
+    if (!sFile)
+      return;
+  }
+  sFile.write((const uint8_t *)line, len);
+  if (sFile.size() > LOG_FILE_MAX) {
+    sFile.close();
+    LittleFS.remove(LOG_FILE_OLD);
+    LittleFS.rename(LOG_FILE, LOG_FILE_OLD);
+    sRotations.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+// Oldest published record across the rings, or nullptr.
+static LogRecord *nextRecord(LogRing *&from) {
+  LogRecord *best = nullptr;
+  for (LogRing &r : sRings) {
+    LogRecord &rec = r.slots[r.tail & (LOG_RING_LEN - 1)];
+    if (rec.seq.load(std::memory_order_acquire) != r.tail + 1)
+      continue;
+    if (!best || (int32_t)(rec.ms - best->ms) < 0) {
+      best = &rec;
+      from = &r;
+    }
+  }
+  return best;
+}
+
+static void logTask(void *param) {
+  char line[LOG_LINE_MAX];
+  for (;;) {
+    if (placementMoveDue(TASK_ROLE_LOGGER)) {
+      placementRespawn(TASK_ROLE_LOGGER); // moved: carry on on the new core
+      vTaskDelete(nullptr);
+      return;
+    }
+    uint8_t sinks = sSinks.load(std::memory_order_relaxed);
+    if (!(sinks & LOG_SINK_FILE) && sFile)
+      sFile.close();
+
+    bool wrote = false;
+    LogRing *ring = nullptr;
+    while (LogRecord *rec = nextRecord(ring)) {
+      int pre = snprintf(line, sizeof(line), "[%6lu.%03lu] ",
+                         (unsigned long)(rec->ms / 1000),
+                         (unsigned long)(rec->ms % 1000));
+      size_t len = pre + formatRecord(*rec, line + pre, sizeof(line) - pre - 1);
+      if (len > sizeof(line) - 2)
+        len = sizeof(line) - 2;
+      line[len++] = '\n';
+      line[len] = 0;
+
+      // Hand the slot back before the slow part
+      rec->seq.store(ring->tail + LOG_RING_LEN, std::memory_order_release);
+      ring->tail++;
+
+      if (sinks & LOG_SINK_SERIAL)
+        Serial.write((const uint8_t *)line, len);
+      if (sinks & LOG_SINK_FILE)
+        writeFile(line, len);
+      sDrained.fetch_add(1, std::memory_order_relaxed);
+      wrote = true;
+    }
+    if (wrote && sFile)
+      sFile.flush();
+
+    vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_MS));
+  }
+}
+
+// ================================================================
+//  Control
+// ================================================================
+
+void logInit(uint8_t sinks) {
+  sSinks = sinks;
+  if (sTaskHandle)
+    return;
+  placementSpawn(TASK_ROLE_LOGGER, logTask, "Logger", LOG_TASK_STACK,
+                 &sTaskHandle);
+}
+
+void logSetSinks(uint8_t sinks) { sSinks = sinks; }
+
+uint8_t logGetSinks() { return sSinks; }
+
+LogStats logGetStats() {
+  LogStats st;
+  st.written = sWritten.load(std::memory_order_relaxed);
+  st.dropped = sDropped.load(std::memory_order_relaxed);
+  st.drained = sDrained.load(std::memory_order_relaxed);
+  st.rotations = sRotations.load(std::memory_order_relaxed);
+  return st;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+// ============================================================
+//  Logger — Deferred Binary Logging
+// ============================================================
+//
+//  logPrintf() never formats and never touches the UART. It
+//  packs the format string's address (the record's format ID)
+//  and the raw argument bytes into a fixed 64-byte slot
+//  of a per-core ring and returns — a few hundred nanoseconds,
+//  safe from the parser and HID tasks. A low-priority task
+//  drains both rings in timestamp order, formats each record
+//  and writes it to the enabled sinks:
+//
+//    LOG_SINK_SERIAL   Serial, one line per record
+//    LOG_SINK_FILE     LOG_FILE on LittleFS, rotated to
+//                      LOG_FILE_OLD past LOG_FILE_MAX bytes
+//                      (GET /api/log)
+//
+//  Rings are lock-free (bounded MPMC slots with sequence
+//  numbers, one consumer), so tasks preempting each other on a
+//  core can log concurrently. A full ring drops the record and
+//  counts it; nothing blocks. Records logged before logInit()
+//  wait in the ring until the drain task starts.
+//
+//  Argument encoding is driven by the C++ type at the call site
+//  and decoded by the conversion in the format string, so the
+//  format must match the arguments as it would for printf:
+//  integers up to 32 bits and %d/%u/%x/%c take 4 bytes, 64-bit
+//  ones %lld/%llu (or %ld/%zu where those are 64-bit) take 8,
+//  floating point is stored as double, %s copies the string
+//  into the record (truncated to what fits). `*` widths are not
+//  supported. Format strings must be literals — the pointer is
+//  dereferenced later, on the drain task.
+//
+// ============================================================
+
+#include <Arduino.h>
+#include <type_traits>
+
+#define LOG_SINK_SERIAL 0x01
+#define LOG_SINK_FILE 0x02
+
+#define LOG_ARG_BYTES 48 // packed arguments per record (64-byte slots)
+
+struct LogStats {
+  uint32_t written; // records accepted into a ring
+  uint32_t dropped; // records lost to a full ring
+  uint32_t drained; // records formatted and sent to the sinks
+  uint32_t rotations;
+};
+
+/// Start the drain task. `sinks` is a LOG_SINK_* mask; enable
+/// LOG_SINK_FILE only once LittleFS is mounted.
+void logInit(uint8_t sinks = LOG_SINK_SERIAL);
+
+/// Change the sinks at runtime.
+void logSetSinks(uint8_t sinks);
+uint8_t logGetSinks();
+
+LogStats logGetStats();
+
+/// Append one record (use logPrintf()).
+void logCommit(const char *fmt, const uint8_t *args, size_t len);
+
+// ----------------------------------------------------------------
+//  Argument packing
+// ----------------------------------------------------------------
+
+class LogPacker {
+public:
+  uint8_t buf[LOG_ARG_BYTES];
+  size_t len = 0;
+
+  template <class T>
+  typename std::enable_if<std::is_integral<T>::value ||
+                          std::is_enum<T>::value>::type
+  put(T v) {
+    if (sizeof(T) <= 4) {
+      uint32_t w = (uint32_t)v;
+      raw(&w, sizeof(w));
+    } else {
+      uint64_t w = (uint64_t)v;
+      raw(&w, sizeof(w));
+    }
+  }
+
+  template <class T>
+  typename std::enable_if<std::is_floating_point<T>::value>::type put(T v) {
+    double d = v;
+    raw(&d, sizeof(d));
+  }
+
+  void put(const char *s);
+  void put(const String &s) { put(s.c_str()); }
+  void put(const void *p) { raw(&p, sizeof(p)); }
+
+  void all() {}
+  template <class T, class... Rest> void all(const T &v, const Rest &...rest) {
+    put(v);
+    all(rest...);
+  }
+
+private:
+  void raw(const void *p, size_t n);
+};
+
+/// printf-style deferred log line (no trailing newline needed).
+template <class... Args> void logPrintf(const char *fmt, const Args &...args) {
+  LogPacker pk;
+  pk.all(args...);
+  logCommit(fmt, pk.buf, pk.len);
+}
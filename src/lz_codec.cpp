@@ -0,0 +1,216 @@
+// ============================================================
+//  LZ Codec — Small-Window Streaming LZSS for Payload Storage
+// ============================================================
+
+#include "lz_codec.h"
+
+#define LZ_BUF_SIZE (2 * LZ_WINDOW)
+#define LZ_HASH_SIZE (1 << LZ_HASH_BITS)
+
+static inline uint32_t hash3(const uint8_t *p) {
+  uint32_t v = (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+  return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// ================================================================
+//  Encoder
+// ================================================================
+
+bool LzEncoder::begin(Print &out) {
+  end();
+  _buf = (uint8_t *)malloc(LZ_BUF_SIZE);
+  _head = (uint16_t *)calloc(LZ_HASH_SIZE, sizeof(uint16_t));
+  if (!_buf || !_head) {
+    end();
+    return false;
+  }
+  _out = &out;
+  _pos = _len = 0;
+  _groupLen = 1;
+  _group[0] = 0;
+  _tokens = 0;
+  _ok = true;
+  return true;
+}
+
+void LzEncoder::end() {
+  free(_buf);
+  free(_head);
+  _buf = nullptr;
+  _head = nullptr;
+  _ok = false;
+}
+
+size_t LzEncoder::write(const uint8_t *data, size_t len) {
+  size_t done = 0;
+  while (done < len && _ok) {
+    if (_len == LZ_BUF_SIZE) {
+      compress(false);
+      slide();
+    }
+    size_t n = std::min(len - done, (size_t)LZ_BUF_SIZE - _len);
+    memcpy(_buf + _len, data + done, n);
+    _len += n;
+    done += n;
+  }
+  return _ok ? len : 0;
+}
+
+bool LzEncoder::finish() {
+  if (!_ok)
+    return false;
+  compress(true);
+  if (_tokens > 0)
+    flushGroup();
+  bool ok = _ok;
+  end();
+  return ok;
+}
+
+// Greedy parse with a single hash candidate per position.
+void LzEncoder::compress(bool flush) {
+  while (_pos < _len && (flush || _len - _pos >= LZ_MAX_MATCH)) {
+    size_t bestLen = 0;
+    size_t bestOff = 0;
+
+    if (_len - _pos >= LZ_MIN_MATCH) {
+      uint32_t h = hash3(_buf + _pos);
+      size_t cand = _head[h];
+      _head[h] = _pos + 1;
+      if (cand && _pos - (cand - 1) <= LZ_WINDOW) {
+        const uint8_t *a = _buf + cand - 1;
+        const uint8_t *b = _buf + _pos;
+        size_t max = std::min((size_t)LZ_MAX_MATCH, _len - _pos);
+        size_t l = 0;
+        while (l < max && a[l] == b[l])
+          l++;
+        if (l >= LZ_MIN_MATCH) {
+          bestLen = l;
+          bestOff = _pos - (cand - 1);
+        }
+      }
+    }
+
+    if (bestLen == 0) {
+      emitLiteral(_buf[_pos++]);
+      continue;
+    }
+    emitMatch(bestOff, bestLen);
+    for (size_t i = 1; i < bestLen; i++) {
+      size_t p = _pos + i;
+      if (_len - p >= LZ_MIN_MATCH)
+        _head[hash3(_buf + p)] = p + 1;
+    }
+    _pos += bestLen;
+  }
+}
+
+// Drop everything older than one window before _pos.
+void LzEncoder::slide() {
+  if (_pos <= LZ_WINDOW)
+    return;
+  size_t shift = _pos - LZ_WINDOW;
+  memmove(_buf, _buf + shift, _len - shift);
+  _pos -= shift;
+  _len -= shift;
+  for (size_t i = 0; i < LZ_HASH_SIZE; i++) {
+    _head[i] = _head[i] > shift ? _head[i] - shift : 0;
+  }
+}
+
+void LzEncoder::emitLiteral(uint8_t c) {
+  _group[0] |= 1 << _tokens;
+  _group[_groupLen++] = c;
+  if (++_tokens == 8)
+    flushGroup();
+}
+
+void LzEncoder::emitMatch(size_t offset, size_t len) {
+  size_t o = offset - 1;
+  _group[_groupLen++] = o & 0xFF;
+  _group[_groupLen++] = (uint8_t)((o >> 8) << 5 | (len - LZ_MIN_MATCH));
+  if (++_tokens == 8)
+    flushGroup();
+}
+
+void LzEncoder::flushGroup() {
+  if (_out->write(_group, _groupLen) != _groupLen)
+    _ok = false;
+  _group[0] = 0;
+  _groupLen = 1;
+  _tokens = 0;
+}
+
+// ================================================================
+//  Decoder
+// ================================================================
+
+bool LzDecoder::begin(File &in, size_t rawSize) {
+  end();
+  _win = (uint8_t *)calloc(LZ_WINDOW, 1);
+  if (!_win)
+    return false;
+  _in = &in;
+  _wpos = 0;
+  _remaining = rawSize;
+  _bits = 0;
+  _matchLen = 0;
+  _inPos = _inLen = 0;
+  return true;
+}
+
+void LzDecoder::end() {
+  free(_win);
+  _win = nullptr;
+  _remaining = 0;
+}
+
+int LzDecoder::nextByte() {
+  if (_inPos == _inLen) {
+    _inLen = _in->read(_inBuf, sizeof(_inBuf));
+    _inPos = 0;
+    if (_inLen == 0)
+      return -1;
+  }
+  return _inBuf[_inPos++];
+}
+
+size_t LzDecoder::read(uint8_t *buf, size_t len) {
+  size_t out = 0;
+  while (out < len && _remaining > 0) {
+    uint8_t c;
+    if (_matchLen > 0) {
+      c = _win[(_wpos - _matchOff) & (LZ_WINDOW - 1)];
+      _matchLen--;
+    } else {
+      if (_bits == 0) {
+        int f = nextByte();
+        if (f < 0)
+          break;
+        _flags = f;
+        _bits = 8;
+      }
+      bool literal = _flags & 1;
+      _flags >>= 1;
+      _bits--;
+
+      int b0 = nextByte();
+      if (b0 < 0)
+        break;
+      if (literal) {
+        c = b0;
+      } else {
+        int b1 = nextByte();
+        if (b1 < 0)
+          break;
+        _matchOff = (b0 | (b1 >> 5) << 8) + 1;
+        _matchLen = (b1 & 0x1F) + LZ_MIN_MATCH;
+        continue;
+      }
+    }
+    _win[_wpos++ & (LZ_WINDOW - 1)] = c;
+    buf[out++] = c;
+    _remaining--;
+  }
+  return out;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+// ============================================================
+//  LZ Codec — Small-Window Streaming LZSS for Payload Storage
+// ============================================================
+//
+//  Token stream: a flag byte, then 8 tokens (flag bit 1 = literal,
+//  LSB first). A literal is one byte; a match is two bytes:
+//    b0 = (offset-1) & 0xFF
+//    b1 = ((offset-1) >> 8) << 5 | (length - LZ_MIN_MATCH)
+//  The stream carries no length — the container stores it.
+//
+//  Decoding needs only the LZ_WINDOW-byte history ring.
+//
+// ============================================================
+
+#include <Arduino.h>
+#include <FS.h>
+
+#define LZ_WINDOW_BITS 11
+#define LZ_WINDOW      (1 << LZ_WINDOW_BITS) // 2 KB history
+#define LZ_MIN_MATCH   3
+#define LZ_MAX_MATCH   (LZ_MIN_MATCH + 31)
+#define LZ_HASH_BITS   10
+
+/// Streaming compressor (~6 KB heap while active).
+class LzEncoder {
+public:
+  ~LzEncoder() { end(); }
+
+  /// Start a new stream written to `out`. False if allocation fails.
+  bool begin(Print &out);
+
+  /// Compress a chunk. Returns `len`, or 0 once the sink has failed.
+  size_t write(const uint8_t *data, size_t len);
+
+  /// Flush all pending tokens and release buffers. False on sink error.
+  bool finish();
+
+  /// Release buffers without flushing.
+  void end();
+
+private:
+  void compress(bool flush);
+  void slide();
+  void emitLiteral(uint8_t c);
+  void emitMatch(size_t offset, size_t len);
+  void flushGroup();
+
+  Print *_out = nullptr;
+  uint8_t *_buf = nullptr;   // 2 × LZ_WINDOW: history + lookahead
+  uint16_t *_head = nullptr; // hash → last position + 1
+  size_t _pos = 0;
+  size_t _len = 0;
+  uint8_t _group[1 + 8 * 2];
+  size_t _groupLen = 1;
+  int _tokens = 0;
+  bool _ok = false;
+};
+
+/// Streaming decompressor (LZ_WINDOW bytes of heap while active).
+class LzDecoder {
+public:
+  ~LzDecoder() { end(); }
+
+  /// Start decoding `rawSize` bytes from `in`. False if allocation fails.
+  bool begin(File &in, size_t rawSize);
+
+  /// Decode up to `len` bytes. Returns 0 at the end of the stream.
+  size_t read(uint8_t *buf, size_t len);
+
+  /// Release the window.
+  void end();
+
+private:
+  int nextByte();
+
+  File *_in = nullptr;
+  uint8_t *_win = nullptr;
+  size_t _wpos = 0;
+  size_t _remaining = 0;
+  uint8_t _flags = 0;
+  int _bits = 0;
+  size_t _matchOff = 0;
+  size_t _matchLen = 0;
+  uint8_t _inBuf[64];
+  size_t _inPos = 0;
+  size_t _inLen = 0;
+};
@@ -9,9 +9,14 @@
 //
 // ============================================================
 
+#include "boot_trace.h"
 #include "config.h"
 #include "ducky_parser.h"
+#include "heap_monitor.h"
+#include "logger.h"
+#include "status_events.h"
 #include "storage_manager.h"
+#include "task_placement.h"
 #include "usb_hid.h"
 #include "web_server.h"
 #include "wifi_manager.h"
@@ -23,15 +28,18 @@ enum BootMode { MODE_ATTACK, MODE_CONFIG };
 
 static BootMode detectBootMode();
 static void blinkLED(int count, int intervalMs);
+static void logScriptStatus(const StatusEvent &ev);
 
 // ================================================================
 //  Setup
 // ================================================================
 
 void setup() {
+  bootTraceMark("setup");
   Serial.begin(115200);
   delay(100);
-  Serial.println("\n=== BadUSB ESP32-S3 ===");
+  logInit(LOG_SINK_SERIAL);
+  logPrintf("=== BadUSB ESP32-S3 ===");
 
   // LED & button pins
   pinMode(LED_PIN, OUTPUT);
@@ -39,73 +47,81 @@ void setup() {
 
   // Initialize storage first (needed by all modes)
   if (!storageInit()) {
-    Serial.println("[FATAL] Storage init failed — halting.");
+    logPrintf("[FATAL] Storage init failed — halting.");
     while (true) {
       blinkLED(3, 100);
       delay(500);
     }
   }
 
+  // File sink needs the mount; earlier lines went to Serial only
+  logSetSinks(LOG_SINKS);
+
+  // Saved core/priority overrides (/api/tasks) before the tasks start
+  placementInit();
+
   // Initialize DuckyScript parser (creates FreeRTOS task infrastructure)
   duckyInit();
+  statusSubscribe(logScriptStatus);
+  bootTraceMark("parser ready");
 
   // Detect boot mode (2-second safety window)
   BootMode mode = detectBootMode();
+  bootTraceMark(mode == MODE_CONFIG ? "safety window: config"
+                                    : "safety window: attack");
 
   if (mode == MODE_CONFIG) {
     // --- CONFIG MODE ---
-    Serial.println("[Boot] CONFIG MODE — Wi-Fi + Web UI only");
+    logPrintf("[Boot] CONFIG MODE — Wi-Fi + Web UI only");
     digitalWrite(LED_PIN, HIGH); // solid LED = config mode
 
     wifiInit();
     webServerInit();
 
-    Serial.printf("[Boot] Connect to Wi-Fi: %s  Password: %s\n",
-                  wifiGetSSID().c_str(), WIFI_PASSWORD);
-    Serial.printf("[Boot] Open http://%s in your browser\n",
-                  wifiGetIP().c_str());
+    logPrintf("[Boot] Connect to Wi-Fi: %s  Password: %s",
+              wifiGetSSID().c_str(), WIFI_PASSWORD);
+    logPrintf("[Boot] Open http://%s in your browser",
+              wifiGetIP().c_str());
 
   } else {
     // --- ATTACK MODE ---
-    Serial.println("[Boot] ATTACK MODE — Initializing USB HID");
+    logPrintf("[Boot] ATTACK MODE — Initializing USB HID");
 
     // Initialize USB HID (keyboard + mouse)
     initUSB();
 
     // Wait for host OS to enumerate
     delay(1500);
+    bootTraceMark("enumeration wait done");
 
     // Fix keyboard layout to English
     fixLayout();
     delay(200);
+    bootTraceMark("layout fixed");
 
     // Check for autorun payload
     String autorun = getAutoRunPayload();
+    bootTraceMark("autorun read");
     if (autorun.length() > 0) {
       String path = String(PAYLOAD_DIR) + "/" + autorun;
-      Serial.printf("[Boot] Auto-running payload: %s\n", autorun.c_str());
-
-      duckyExecuteFile(path, [](int line, int total, DuckyStatus st) {
-        if (st == DuckyStatus::FINISHED) {
-          Serial.println("[Ducky] Payload execution finished.");
-        } else if (st == DuckyStatus::ERROR) {
-          Serial.println("[Ducky] Payload execution error!");
-        } else if (st == DuckyStatus::ABORTED) {
-          Serial.println("[Ducky] Payload execution aborted.");
-        }
-      });
+      logPrintf("[Boot] Auto-running payload: %s", autorun.c_str());
+
+      duckyExecuteFile(path); // outcome logged by logScriptStatus()
+      bootTraceMark("autorun started");
     } else {
-      Serial.println("[Boot] No autorun payload configured.");
+      logPrintf("[Boot] No autorun payload configured.");
     }
 
     // Also start Wi-Fi in attack mode (background, for remote control)
     wifiInit();
     webServerInit();
-    Serial.printf("[Boot] Wi-Fi active in background: %s\n",
-                  wifiGetSSID().c_str());
+    logPrintf("[Boot] Wi-Fi active in background: %s",
+              wifiGetSSID().c_str());
   }
 
-  Serial.println("[Boot] Setup complete.\n");
+  bootTraceMark("setup complete");
+  bootTraceDump();
+  logPrintf("[Boot] Setup complete.");
 }
 
 // ================================================================
@@ -115,7 +131,8 @@ void setup() {
 void loop() {
   // FreeRTOS handles the parser task.
   // Wi-Fi + Web server run on the other core.
-  // Nothing needed in loop — yield to scheduler.
+  // Only the heap history is kept here — then yield to scheduler.
+  heapMonitorPoll();
   vTaskDelay(pdMS_TO_TICKS(100));
 }
 
@@ -124,7 +141,7 @@ void loop() {
 // ================================================================
 
 static BootMode detectBootMode() {
-  Serial.println("[Boot] Safety window — hold BOOT button for Config Mode...");
+  logPrintf("[Boot] Safety window — hold BOOT button for Config Mode...");
 
   unsigned long start = millis();
   bool buttonHeld = true;
@@ -151,6 +168,20 @@ static BootMode detectBootMode() {
   return MODE_ATTACK;
 }
 
+// ================================================================
+//  Script Status (status task, status_events.h)
+// ================================================================
+
+static void logScriptStatus(const StatusEvent &ev) {
+  if (ev.status == DuckyStatus::FINISHED) {
+    logPrintf("[Ducky] Payload execution finished.");
+  } else if (ev.status == DuckyStatus::ERROR) {
+    logPrintf("[Ducky] Payload execution error: %s", duckyLastError());
+  } else if (ev.status == DuckyStatus::ABORTED) {
+    logPrintf("[Ducky] Payload execution aborted at line %d.", ev.line);
+  }
+}
+
 // ================================================================
 //  LED Utility
 // ================================================================
@@ -0,0 +1,338 @@
+// ============================================================
+//  Metrics — Prometheus Text Exposition for /api/metrics
+// ============================================================
+
+#include "metrics.h"
+#include "arena.h"
+#include "config.h"
+#include "dns_responder.h"
+#include "ducky_parser.h"
+#include "heap_monitor.h"
+#include "live_channel.h"
+#include "logger.h"
+#include "module_cache.h"
+#include "payload_cache.h"
+#include "status_events.h"
+#include "storage_manager.h"
+#include "usb_hid.h"
+
+#include <atomic>
+
+// Histogram bucket upper bounds (µs); +Inf is implicit
+static const uint32_t BUCKETS_US[] = {1000,   5000,   10000,  50000,
+                                      100000, 500000, 1000000};
+#define BUCKET_COUNT (sizeof(BUCKETS_US) / sizeof(BUCKETS_US[0]))
+
+struct RouteMetrics {
+  const char *route;
+  std::atomic<uint32_t> count;
+  std::atomic<uint64_t> sumUs;
+  std::atomic<uint32_t> buckets[BUCKET_COUNT];
+};
+
+static RouteMetrics sRoutes[METRICS_MAX_ROUTES];
+static std::atomic<int> sRouteCount{0};
+static portMUX_TYPE sRouteMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Slot for `route`, claimed on first use (nullptr once the table is full)
+static RouteMetrics *routeSlot(const char *route) {
+  int n = sRouteCount.load(std::memory_order_acquire);
+  for (int i = 0; i < n; i++) {
+    if (sRoutes[i].route == route || strcmp(sRoutes[i].route, route) == 0)
+      return &sRoutes[i];
+  }
+
+  RouteMetrics *slot = nullptr;
+  portENTER_CRITICAL(&sRouteMux);
+  n = sRouteCount.load(std::memory_order_relaxed);
+  for (int i = 0; i < n && !slot; i++) {
+    if (strcmp(sRoutes[i].route, route) == 0)
+      slot = &sRoutes[i];
+  }
+  if (!slot && n < METRICS_MAX_ROUTES) {
+    slot = &sRoutes[n];
+    slot->route = route;
+    sRouteCount.store(n + 1, std::memory_order_release);
+  }
+  portEXIT_CRITICAL(&sRouteMux);
+  return slot;
+}
+
+// ----------------------------------------------------------------
+void metricsObserveHttp(const char *route, uint32_t us) {
+  RouteMetrics *m = routeSlot(route);
+  if (!m)
+    return;
+  m->count.fetch_add(1, std::memory_order_relaxed);
+  m->sumUs.fetch_add(us, std::memory_order_relaxed);
+  for (size_t i = 0; i < BUCKET_COUNT; i++) {
+    if (us <= BUCKETS_US[i]) {
+      m->buckets[i].fetch_add(1, std::memory_order_relaxed);
+      break;
+    }
+  }
+}
+
+uint32_t metricsHttpRequests() {
+  uint32_t n = 0;
+  int routes = sRouteCount.load(std::memory_order_acquire);
+  for (int i = 0; i < routes; i++)
+    n += sRoutes[i].count.load(std::memory_order_relaxed);
+  return n;
+}
+
+// ================================================================
+//  Rendering
+// ================================================================
+
+static void header(String &out, const char *name, const char *type,
+                   const char *help) {
+  out += "# HELP ";
+  out += name;
+  out += " ";
+  out += help;
+  out += "\n# TYPE ";
+  out += name;
+  out += " ";
+  out += type;
+  out += "\n";
+}
+
+static void sample(String &out, const char *name, const String &value,
+                   const String &labels = "") {
+  out += name;
+  if (labels.length()) {
+    out += "{";
+    out += labels;
+    out += "}";
+  }
+  out += " ";
+  out += value;
+  out += "\n";
+}
+
+static void single(String &out, const char *name, const char *type,
+                   const char *help, const String &value) {
+  header(out, name, type, help);
+  sample(out, name, value);
+}
+
+static String seconds(uint64_t us) { return String(us / 1e6, 6); }
+
+static String u64(uint64_t v) { return String((unsigned long long)v); }
+
+// ----------------------------------------------------------------
+String metricsRender() {
+  String out;
+  out.reserve(4096);
+
+  single(out, "badusb_uptime_seconds", "counter", "Time since boot.",
+         seconds((uint64_t)millis() * 1000));
+
+  // --- HID ---
+  HidStats hid = hidGetStats();
+  single(out, "badusb_hid_reports_total", "counter",
+         "Keyboard and mouse reports sent.", String(hid.reports));
+  single(out, "badusb_hid_chars_typed_total", "counter",
+         "Characters typed by STRING/STRINGLN and live text.",
+         String(hid.chars));
+  single(out, "badusb_hid_chars_per_second", "gauge",
+         "Achieved typing rate while typing.",
+         String(hid.typingUs ? hid.chars * 1e6 / hid.typingUs : 0.0, 1));
+  single(out, "badusb_hid_report_jitter_max_seconds", "gauge",
+         "Largest change between consecutive report gaps in a burst.",
+         seconds(hid.jitterMaxUs));
+  single(out, "badusb_hid_report_jitter_avg_seconds", "gauge",
+         "Mean change between consecutive report gaps in a burst.",
+         seconds(hid.jitterAvgUs));
+  single(out, "badusb_hid_nkro", "gauge",
+         "1 while typing uses the NKRO report (host in report protocol).",
+         hid.nkro ? "1" : "0");
+  single(out, "badusb_hid_leds", "gauge",
+         "Lock LEDs from the host's last LED report (1 Num, 2 Caps, 4 Scroll).",
+         String(hid.leds));
+  single(out, "badusb_hid_led_reports_total", "counter",
+         "LED output reports received from the host.", String(hid.ledReports));
+
+  // --- Parser ---
+  DuckyStats ds = duckyGetStats();
+  single(out, "badusb_parser_scripts_total", "counter", "Scripts started.",
+         String(ds.scripts));
+  single(out, "badusb_parser_lines_executed_total", "counter",
+         "Commands dispatched (each REPEAT iteration counts).",
+         String(ds.linesExecuted));
+  single(out, "badusb_parser_queue_depth", "gauge",
+         "Lines left in the running script.", String(ds.linesPending));
+  single(out, "badusb_parser_aborts_total", "counter",
+         "Scripts stopped on request.", String(ds.aborts));
+  single(out, "badusb_parser_limit_errors_total", "counter",
+         "Scripts stopped by a complexity limit or bad argument.",
+         String(ds.limitErrors));
+  header(out, "badusb_parser_host_waits_total", "counter",
+         "WAIT_FOR_* lines by outcome (a timeout stops the script).");
+  sample(out, "badusb_parser_host_waits_total", String(ds.waits),
+         "result=\"ready\"");
+  sample(out, "badusb_parser_host_waits_total", String(ds.waitTimeouts),
+         "result=\"timeout\"");
+  single(out, "badusb_parser_host_wait_last_seconds", "gauge",
+         "Time the last answered WAIT_FOR_* waited for the host.",
+         seconds((uint64_t)ds.waitLastMs * 1000));
+  header(out, "badusb_parser_abort_latency_seconds", "gauge",
+         "Time from stop request to the parser task stopping.");
+  sample(out, "badusb_parser_abort_latency_seconds",
+         seconds(ds.abortLatencyUs), "stat=\"last\"");
+  sample(out, "badusb_parser_abort_latency_seconds",
+         seconds(ds.abortLatencyMaxUs), "stat=\"max\"");
+  single(out, "badusb_parser_stack_free_min_bytes", "gauge",
+         "Lowest DuckyParser stack high-water mark (0 = not run yet).",
+         String(ds.stackFreeMin));
+
+  StatusStats ss = statusGetStats();
+  header(out, "badusb_status_events_total", "counter",
+         "Parser status events by outcome (status task).");
+  sample(out, "badusb_status_events_total", String(ss.published),
+         "state=\"published\"");
+  sample(out, "badusb_status_events_total", String(ss.coalesced),
+         "state=\"coalesced\"");
+  sample(out, "badusb_status_events_total", String(ss.overflows),
+         "state=\"overflow\"");
+  sample(out, "badusb_status_events_total", String(ss.delivered),
+         "state=\"delivered\"");
+
+  // --- Live channel ---
+  LiveStats live = liveGetStats();
+  single(out, "badusb_live_queue_depth", "gauge",
+         "Live keyboard events waiting for the HID task.",
+         String(live.queued));
+  single(out, "badusb_live_events_total", "counter",
+         "Live keyboard events sent to HID.", String(live.events));
+  single(out, "badusb_live_rejected_total", "counter",
+         "Live keyboard events rejected.", String(live.rejected));
+
+  // --- Captive-portal DNS ---
+  DnsStats dns = dnsGetStats();
+  header(out, "badusb_dns_queries_total", "counter",
+         "Captive-portal DNS packets by outcome.");
+  sample(out, "badusb_dns_queries_total", String(dns.answered),
+         "result=\"answered\"");
+  sample(out, "badusb_dns_queries_total", String(dns.empty),
+         "result=\"empty\"");
+  sample(out, "badusb_dns_queries_total", String(dns.dropped),
+         "result=\"dropped\"");
+
+  // --- Memory ---
+  single(out, "badusb_heap_free_bytes", "gauge", "Free internal heap.",
+         String(ESP.getFreeHeap()));
+  single(out, "badusb_heap_min_free_bytes", "gauge",
+         "Lowest free internal heap since boot.",
+         String(ESP.getMinFreeHeap()));
+  single(out, "badusb_psram_free_bytes", "gauge", "Free PSRAM.",
+         String(ESP.getFreePsram()));
+  single(out, "badusb_psram_min_free_bytes", "gauge",
+         "Lowest free PSRAM since boot.", String(ESP.getMinFreePsram()));
+  HeapSample heap = heapSampleNow();
+  single(out, "badusb_heap_largest_free_block_bytes", "gauge",
+         "Largest free block of internal heap.", String(heap.largest));
+  single(out, "badusb_heap_fragmentation_ratio", "gauge",
+         "1 - largest free block / free internal heap.",
+         String(heapFragmentation(heap), 3));
+  header(out, "badusb_arena_peak_bytes", "gauge",
+         "Most arena bytes one job used.");
+  for (int i = 0; i < ARENA_COUNT; i++)
+    sample(out, "badusb_arena_peak_bytes",
+           String(arenaGetStats((ArenaId)i).peak),
+           String("arena=\"") + arenaName((ArenaId)i) + "\"");
+  header(out, "badusb_arena_overflows_total", "counter",
+         "Arena allocations that went to the heap.");
+  for (int i = 0; i < ARENA_COUNT; i++)
+    sample(out, "badusb_arena_overflows_total",
+           String(arenaGetStats((ArenaId)i).overflows),
+           String("arena=\"") + arenaName((ArenaId)i) + "\"");
+
+  // --- Logger ---
+  LogStats lg = logGetStats();
+  header(out, "badusb_log_records_total", "counter",
+         "Deferred log records by outcome.");
+  sample(out, "badusb_log_records_total", String(lg.written),
+         "state=\"written\"");
+  sample(out, "badusb_log_records_total", String(lg.dropped),
+         "state=\"dropped\"");
+  sample(out, "badusb_log_records_total", String(lg.drained),
+         "state=\"drained\"");
+  single(out, "badusb_log_rotations_total", "counter",
+         "Log file rotations.", String(lg.rotations));
+
+  // --- LittleFS ---
+  StorageStats fs = storageGetStats();
+  header(out, "badusb_fs_ops_total", "counter", "Payload file operations.");
+  sample(out, "badusb_fs_ops_total", String(fs.reads), "op=\"read\"");
+  sample(out, "badusb_fs_ops_total", String(fs.writes), "op=\"write\"");
+  sample(out, "badusb_fs_ops_total", String(fs.deletes), "op=\"delete\"");
+  sample(out, "badusb_fs_ops_total", String(fs.failures), "op=\"failed\"");
+  header(out, "badusb_fs_bytes_total", "counter", "Payload bytes moved.");
+  sample(out, "badusb_fs_bytes_total", u64(fs.bytesRead), "dir=\"read\"");
+  sample(out, "badusb_fs_bytes_total", u64(fs.bytesWritten),
+         "dir=\"write\"");
+
+  // --- INCLUDE module cache ---
+  ModuleCacheStats mc = moduleCacheGetStats();
+  header(out, "badusb_module_lookups_total", "counter",
+         "INCLUDE lookups by outcome.");
+  sample(out, "badusb_module_lookups_total", String(mc.hits),
+         "result=\"hit\"");
+  sample(out, "badusb_module_lookups_total", String(mc.compiles),
+         "result=\"compiled\"");
+  sample(out, "badusb_module_lookups_total", String(mc.failures),
+         "result=\"failed\"");
+  header(out, "badusb_module_drops_total", "counter",
+         "Cached modules dropped.");
+  sample(out, "badusb_module_drops_total", String(mc.invalidated),
+         "reason=\"changed\"");
+  sample(out, "badusb_module_drops_total", String(mc.evicted),
+         "reason=\"evicted\"");
+  single(out, "badusb_module_cache_bytes", "gauge",
+         "Compiled module images held in RAM.", String(mc.bytes));
+
+  // --- PSRAM payload cache ---
+  PayloadCacheStats pc = payloadCacheGetStats();
+  header(out, "badusb_payload_cache_lookups_total", "counter",
+         "Payload source reads by outcome.");
+  sample(out, "badusb_payload_cache_lookups_total", String(pc.hits),
+         "result=\"hit\"");
+  sample(out, "badusb_payload_cache_lookups_total", String(pc.misses),
+         "result=\"miss\"");
+  single(out, "badusb_payload_cache_compiled_hits_total", "counter",
+         "Payload runs that reused a cached image.", String(pc.imageHits));
+  header(out, "badusb_payload_cache_drops_total", "counter",
+         "Cached payloads dropped.");
+  sample(out, "badusb_payload_cache_drops_total", String(pc.invalidated),
+         "reason=\"changed\"");
+  sample(out, "badusb_payload_cache_drops_total", String(pc.evicted),
+         "reason=\"evicted\"");
+  single(out, "badusb_payload_cache_bytes", "gauge",
+         "Payload sources and images held in PSRAM.", String(pc.bytes));
+
+  // --- HTTP ---
+  header(out, "badusb_http_request_duration_seconds", "histogram",
+         "Request handler time by route.");
+  int n = sRouteCount.load(std::memory_order_acquire);
+  for (int i = 0; i < n; i++) {
+    RouteMetrics &m = sRoutes[i];
+    String route = String("route=\"") + m.route + "\"";
+    uint32_t cumulative = 0;
+    for (size_t b = 0; b < BUCKET_COUNT; b++) {
+      cumulative += m.buckets[b].load(std::memory_order_relaxed);
+      sample(out, "badusb_http_request_duration_seconds_bucket",
+             String(cumulative),
+             route + ",le=\"" + String(BUCKETS_US[b] / 1e6, 3) + "\"");
+    }
+    uint32_t count = m.count.load(std::memory_order_relaxed);
+    sample(out, "badusb_http_request_duration_seconds_bucket", String(count),
+           route + ",le=\"+Inf\"");
+    sample(out, "badusb_http_request_duration_seconds_sum",
+           seconds(m.sumUs.load(std::memory_order_relaxed)), route);
+    sample(out, "badusb_http_request_duration_seconds_count", String(count),
+           route);
+  }
+  return out;
+}
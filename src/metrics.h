@@ -0,0 +1,24 @@
+#pragma once
+
+// ============================================================
+//  Metrics — Prometheus Text Exposition for /api/metrics
+// ============================================================
+//
+//  Each module keeps its own atomic counters (hidGetStats,
+//  duckyGetStats, storageGetStats, liveGetStats); this module adds
+//  per-route HTTP latency histograms and renders everything in the
+//  Prometheus text format (version 0.0.4).
+//
+// ============================================================
+
+#include <Arduino.h>
+
+/// Record one HTTP request for `route` (a string literal such as
+/// "GET /api/status") whose handler ran for `us` microseconds.
+void metricsObserveHttp(const char *route, uint32_t us);
+
+/// HTTP requests recorded so far, all routes.
+uint32_t metricsHttpRequests();
+
+/// Render all metrics.
+String metricsRender();
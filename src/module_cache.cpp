@@ -0,0 +1,205 @@
+// ============================================================
+//  Module Cache — Compiled Payloads for INCLUDE
+// ============================================================
+
+#include "module_cache.h"
+#include "config.h"
+#include "logger.h"
+#include "storage_manager.h"
+
+#include <atomic>
+
+struct Module {
+  String name;
+  DuckyImage image;
+  std::vector<String> deps; // modules linked into it, at any depth
+  uint32_t used;            // LRU stamp
+};
+
+// Recursive: compiling a module resolves its own INCLUDEs. Held for
+// the whole compile, since sStack below is shared by the recursion.
+static SemaphoreHandle_t sLock = nullptr;
+static std::vector<Module> sModules;
+static size_t sBytes = 0;
+static uint32_t sStamp = 0;
+
+// Modules being compiled (outermost first), and what each links in
+static String sStack[MODULE_MAX_DEPTH];
+static std::vector<String> sStackDeps[MODULE_MAX_DEPTH];
+static int sDepth = 0;
+
+// "INCLUDE cycle: a -> b -> a" for the last cycle found. The last
+// byte is never written, so a reader racing a rewrite still stops.
+static char sCycleError[16 + (MODULE_MAX_DEPTH + 1) * (MAX_PAYLOAD_NAME + 4)];
+
+static std::atomic<uint32_t> sHits{0};
+static std::atomic<uint32_t> sCompiles{0};
+static std::atomic<uint32_t> sFailures{0};
+static std::atomic<uint32_t> sInvalidated{0};
+static std::atomic<uint32_t> sEvicted{0};
+
+static Module *findModule(const String &name) {
+  for (Module &m : sModules) {
+    if (m.name == name)
+      return &m;
+  }
+  return nullptr;
+}
+
+static void dropModule(size_t i) {
+  sBytes -= sModules[i].image->size();
+  sModules.erase(sModules.begin() + i);
+}
+
+// Cache `m`, evicting least recently used entries to make room
+static void insertModule(Module &&m) {
+  size_t size = m.image->size();
+  if (size > MODULE_CACHE_BYTES)
+    return; // used once, never cached
+  while (sBytes + size > MODULE_CACHE_BYTES && !sModules.empty()) {
+    size_t lru = 0;
+    for (size_t i = 1; i < sModules.size(); i++) {
+      if (sModules[i].used < sModules[lru].used)
+        lru = i;
+    }
+    dropModule(lru);
+    sEvicted.fetch_add(1, std::memory_order_relaxed);
+  }
+  sBytes += size;
+  sModules.push_back(std::move(m));
+}
+
+// The module one level up links in `name` and everything under it
+static void recordDependency(const String &name,
+                             const std::vector<String> &deps) {
+  if (!sDepth)
+    return;
+  std::vector<String> &parent = sStackDeps[sDepth - 1];
+  parent.push_back(name);
+  parent.insert(parent.end(), deps.begin(), deps.end());
+}
+
+// Storage listener: drop `name` and every module built from it. It
+// waits out a compile in progress, then drops whatever that compile
+// cached from the old version: this is what keeps the cache fresh.
+static void onPayloadChange(const String &name) {
+  xSemaphoreTakeRecursive(sLock, portMAX_DELAY);
+  for (size_t i = sModules.size(); i-- > 0;) {
+    const Module &m = sModules[i];
+    bool stale = m.name == name;
+    for (size_t d = 0; !stale && d < m.deps.size(); d++)
+      stale = m.deps[d] == name;
+    if (stale) {
+      dropModule(i);
+      sInvalidated.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  xSemaphoreGiveRecursive(sLock);
+}
+
+// ================================================================
+//  Resolve
+// ================================================================
+
+// Compile payload `name` (already known not to be cached)
+static DuckyImage compileModule(const String &name, const char *&error) {
+  for (int i = 0; i < sDepth; i++) {
+    if (sStack[i] == name) {
+      String chain = "INCLUDE cycle: ";
+      for (int j = i; j < sDepth; j++)
+        chain += sStack[j] + " -> ";
+      chain += name;
+      strncpy(sCycleError, chain.c_str(), sizeof(sCycleError) - 1);
+      error = sCycleError;
+      return nullptr;
+    }
+  }
+  if (sDepth >= MODULE_MAX_DEPTH) {
+    error = "INCLUDE nested too deep";
+    return nullptr;
+  }
+  if (!isValidPayloadName(name) || payloadSize(name) < 0) {
+    error = "INCLUDE module not found";
+    return nullptr;
+  }
+
+  String src = readPayload(name);
+  auto code = std::make_shared<std::vector<uint8_t>>();
+  DuckyCompileResult res;
+  bool ok;
+
+  sStack[sDepth] = name;
+  sStackDeps[sDepth].clear();
+  sDepth++;
+  if (duckyIsBytecode((const uint8_t *)src.c_str(), src.length())) {
+    code->assign(src.c_str(), src.c_str() + src.length());
+    ok = duckyVerify(code->data(), code->size(), res);
+  } else {
+    ok = duckyCompile(src.c_str(), src.length(), *code, res, true,
+                      moduleResolve);
+  }
+  sDepth--;
+
+  if (!ok) {
+    logPrintf("[Modules] %s line %u: %s", name.c_str(), res.errorLine, res.error);
+    // A cycle below is reported as one, all the way up
+    error = res.error == sCycleError ? sCycleError
+                                     : "INCLUDE module doesn't compile";
+    return nullptr;
+  }
+  sCompiles.fetch_add(1, std::memory_order_relaxed);
+
+  Module m = {name, code, std::move(sStackDeps[sDepth]), ++sStamp};
+  recordDependency(name, m.deps);
+  insertModule(std::move(m));
+  return code;
+}
+
+DuckyImage moduleResolve(const String &name, const char *&error) {
+  xSemaphoreTakeRecursive(sLock, portMAX_DELAY);
+  DuckyImage image;
+  if (Module *m = findModule(name)) {
+    m->used = ++sStamp;
+    recordDependency(name, m->deps);
+    sHits.fetch_add(1, std::memory_order_relaxed);
+    image = m->image;
+  } else {
+    image = compileModule(name, error);
+    if (!image)
+      sFailures.fetch_add(1, std::memory_order_relaxed);
+  }
+  xSemaphoreGiveRecursive(sLock);
+  return image;
+}
+
+// ================================================================
+//  Public API
+// ================================================================
+
+void moduleCacheInit() {
+  if (sLock)
+    return;
+  sLock = xSemaphoreCreateRecursiveMutex();
+  storageOnChange(onPayloadChange);
+}
+
+void moduleCacheClear() {
+  xSemaphoreTakeRecursive(sLock, portMAX_DELAY);
+  sModules.clear();
+  sBytes = 0;
+  xSemaphoreGiveRecursive(sLock);
+}
+
+ModuleCacheStats moduleCacheGetStats() {
+  ModuleCacheStats s;
+  s.hits = sHits.load(std::memory_order_relaxed);
+  s.compiles = sCompiles.load(std::memory_order_relaxed);
+  s.failures = sFailures.load(std::memory_order_relaxed);
+  s.invalidated = sInvalidated.load(std::memory_order_relaxed);
+  s.evicted = sEvicted.load(std::memory_order_relaxed);
+  xSemaphoreTakeRecursive(sLock, portMAX_DELAY);
+  s.entries = sModules.size();
+  s.bytes = sBytes;
+  xSemaphoreGiveRecursive(sLock);
+  return s;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+// ============================================================
+//  Module Cache — Compiled Payloads for INCLUDE
+// ============================================================
+//
+//  `INCLUDE <name>` links payload <name> from PAYLOAD_DIR into a
+//  script at compile time (ducky_compiler.h). moduleResolve() is
+//  the compiler's resolver on the device: it compiles the payload
+//  once — its own INCLUDEs too, up to MODULE_MAX_DEPTH deep — and
+//  keeps the image in RAM for later runs, so a shared preamble is
+//  parsed once, not once per script that uses it.
+//
+//  Each entry remembers every module linked into it, at any depth.
+//  When a payload is written or deleted, storage calls back here
+//  and exactly the entries built from it are dropped: the module
+//  itself and its dependents. Other modules stay cached. Over
+//  MODULE_CACHE_BYTES the least recently used entries go first;
+//  an image in use by a compile stays alive until it's done.
+//
+//  One lock covers lookups, compiles and that callback. A payload
+//  save or delete (e.g. from the web server's AsyncTCP task)
+//  therefore blocks in the callback until a compile in progress
+//  has finished its whole INCLUDE tree. It then drops anything that
+//  compile cached from the old version.
+//
+// ============================================================
+
+#include "ducky_compiler.h"
+
+#include <Arduino.h>
+
+/// Create the lock and register for payload changes (idempotent;
+/// duckyInit() calls it).
+void moduleCacheInit();
+
+/// INCLUDE resolver (DuckyIncludeFn): payload `name` as a verified
+/// image, cached or compiled now. nullptr with `error` set if it is
+/// missing, doesn't compile, or includes itself.
+DuckyImage moduleResolve(const String &name, const char *&error);
+
+/// Drop every cached module.
+void moduleCacheClear();
+
+/// Counters since boot, and the cache's current size.
+struct ModuleCacheStats {
+  uint32_t hits;        // INCLUDEs served from the cache
+  uint32_t compiles;    // modules compiled (misses)
+  uint32_t failures;    // INCLUDEs that failed (missing, errors, cycles)
+  uint32_t invalidated; // entries dropped: they or a dependency changed
+  uint32_t evicted;     // entries dropped for space
+  uint32_t entries;     // modules cached now
+  uint32_t bytes;       // their image bytes
+};
+
+/// Snapshot of the module cache counters.
+ModuleCacheStats moduleCacheGetStats();
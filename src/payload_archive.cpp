@@ -0,0 +1,177 @@
+// ============================================================
+//  Payload Archive — Bulk Library Import / Export
+// ============================================================
+
+#include "payload_archive.h"
+
+static void putLE(uint8_t *p, uint32_t v, int bytes) {
+  for (int i = 0; i < bytes; i++)
+    p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint32_t getLE(const uint8_t *p, int bytes) {
+  uint32_t v = 0;
+  for (int i = 0; i < bytes; i++)
+    v |= (uint32_t)p[i] << (8 * i);
+  return v;
+}
+
+// ================================================================
+//  Export
+// ================================================================
+
+ArchiveWriter::ArchiveWriter() : _names(listPayloads()) {
+  memcpy(_head, ARCHIVE_MAGIC, 4);
+  _headLen = 4;
+}
+
+// Load the next entry header into _head (or the end marker).
+bool ArchiveWriter::openNext() {
+  while (_next < _names.size()) {
+    const String &name = _names[_next++];
+    if (name.length() > MAX_PAYLOAD_NAME)
+      continue;
+    if (!_reader.open(name))
+      continue;
+    _open = true;
+
+    putLE(_head, name.length(), 2);
+    putLE(_head + 2, _reader.size(), 4);
+    putLE(_head + 6, payloadHash(name), 4);
+    memcpy(_head + ARCHIVE_HEADER_SIZE, name.c_str(), name.length());
+    _headLen = ARCHIVE_HEADER_SIZE + name.length();
+    _headPos = 0;
+    return true;
+  }
+
+  memset(_head, 0, ARCHIVE_HEADER_SIZE);
+  _headLen = ARCHIVE_HEADER_SIZE;
+  _headPos = 0;
+  _ended = true;
+  return false;
+}
+
+size_t ArchiveWriter::read(uint8_t *buf, size_t maxLen) {
+  size_t out = 0;
+  while (out < maxLen) {
+    // Pending header bytes first
+    if (_headPos < _headLen) {
+      size_t n = std::min(maxLen - out, _headLen - _headPos);
+      memcpy(buf + out, _head + _headPos, n);
+      _headPos += n;
+      out += n;
+      continue;
+    }
+    if (_open) {
+      size_t n = _reader.read(buf + out, maxLen - out);
+      out += n;
+      if (n > 0)
+        continue;
+      _reader.close();
+      _open = false;
+    }
+    if (_ended)
+      break;
+    openNext();
+  }
+  return out;
+}
+
+// ================================================================
+//  Import
+// ================================================================
+
+void ArchiveReader::reset() {
+  _writer.abort();
+  _state = MAGIC;
+  _have = 0;
+  written = skipped = failed = 0;
+}
+
+bool ArchiveReader::feed(const uint8_t *data, size_t len) {
+  size_t pos = 0;
+  while (pos < len && _state != DONE && _state != BAD) {
+    switch (_state) {
+    case MAGIC:
+    case HEADER: {
+      size_t need = (_state == MAGIC ? 4 : ARCHIVE_HEADER_SIZE) - _have;
+      size_t n = std::min(need, len - pos);
+      memcpy(_buf + _have, data + pos, n);
+      _have += n;
+      pos += n;
+      if (n < need)
+        break;
+      _have = 0;
+
+      if (_state == MAGIC) {
+        _state = memcmp(_buf, ARCHIVE_MAGIC, 4) == 0 ? HEADER : BAD;
+        break;
+      }
+      _nameLen = getLE(_buf, 2);
+      _size = getLE(_buf + 2, 4);
+      _hash = getLE(_buf + 6, 4);
+      if (_nameLen == 0) {
+        _state = DONE;
+      } else if (_nameLen > MAX_PAYLOAD_NAME) {
+        _state = BAD;
+      } else {
+        _name = "";
+        _state = NAME;
+      }
+      break;
+    }
+
+    case NAME: {
+      size_t n = std::min(_nameLen - _name.length(), len - pos);
+      _name.concat((const char *)data + pos, n);
+      pos += n;
+      if (_name.length() < _nameLen)
+        break;
+
+      // Unusable or already up to date → consume the data, skip flash
+      _skip = true;
+      if (_size > MAX_PAYLOAD_SIZE || !isValidPayloadName(_name)) {
+        failed++;
+      } else if (payloadUnchanged(_name, _hash, _size)) {
+        skipped++;
+      } else if (!_writer.begin(_name, _size >= PAYLOAD_COMPRESS_MIN)) {
+        failed++;
+      } else {
+        _skip = false;
+      }
+      _remaining = _size;
+      _state = DATA;
+      if (_remaining == 0)
+        finishEntry();
+      break;
+    }
+
+    case DATA: {
+      size_t n = std::min(_remaining, len - pos);
+      if (!_skip)
+        _writer.write(data + pos, n);
+      pos += n;
+      _remaining -= n;
+      if (_remaining == 0)
+        finishEntry();
+      break;
+    }
+
+    default:
+      break;
+    }
+  }
+  return _state != BAD;
+}
+
+void ArchiveReader::finishEntry() {
+  if (!_skip) {
+    if (_writer.hash() == _hash && _writer.commit()) {
+      written++;
+    } else {
+      _writer.abort();
+      failed++;
+    }
+  }
+  _state = HEADER;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+// ============================================================
+//  Payload Archive — Bulk Library Import / Export
+// ============================================================
+//
+//  Stream format (all integers little-endian):
+//
+//    "DKA1"                                  4-byte magic
+//    { u16 nameLen, u32 size, u32 hash,      10-byte entry header
+//      name[nameLen], data[size] } ...       hash = FNV-1a of data
+//    u16 0, u32 0, u32 0                     end marker
+//
+//  Sizes and hashes describe the plain content; compression is a
+//  per-device storage detail. Import skips entries whose name already
+//  holds content with the same size and hash, so re-syncing a library
+//  only writes changes.
+//
+// ============================================================
+
+#include "config.h"
+#include "storage_manager.h"
+#include <Arduino.h>
+#include <vector>
+
+#define ARCHIVE_MAGIC       "DKA1"
+#define ARCHIVE_HEADER_SIZE 10
+
+/// Pull-side encoder: produces the archive of every stored payload.
+class ArchiveWriter {
+public:
+  ArchiveWriter();
+
+  /// Fill up to `maxLen` bytes. Returns 0 once the archive is complete.
+  size_t read(uint8_t *buf, size_t maxLen);
+
+private:
+  bool openNext();
+
+  std::vector<String> _names;
+  size_t _next = 0;
+  uint8_t _head[4 + ARCHIVE_HEADER_SIZE + MAX_PAYLOAD_NAME];
+  size_t _headLen = 0;
+  size_t _headPos = 0;
+  PayloadReader _reader;
+  bool _open = false;
+  bool _ended = false;
+};
+
+/// Push-side decoder: writes archive entries to LittleFS as bytes arrive.
+class ArchiveReader {
+public:
+  /// Prepare for a new stream.
+  void reset();
+
+  /// Consume a chunk. Returns false once the stream is malformed.
+  bool feed(const uint8_t *data, size_t len);
+
+  /// True after the end marker has been read.
+  bool done() const { return _state == DONE; }
+
+  int written = 0; ///< entries stored
+  int skipped = 0; ///< entries already up to date
+  int failed = 0;  ///< entries rejected (bad name, hash or write error)
+
+private:
+  enum State { MAGIC, HEADER, NAME, DATA, DONE, BAD };
+
+  void finishEntry();
+
+  State _state = MAGIC;
+  uint8_t _buf[ARCHIVE_HEADER_SIZE];
+  size_t _have = 0;
+  String _name;
+  size_t _nameLen = 0;
+  size_t _remaining = 0;
+  uint32_t _size = 0;
+  uint32_t _hash = 0;
+  bool _skip = false;
+  PayloadWriter _writer;
+};
@@ -0,0 +1,211 @@
+// ============================================================
+//  Payload Cache — Hot Payloads Held in PSRAM
+// ============================================================
+
+#include "payload_cache.h"
+#include "config.h"
+#include "logger.h"
+
+#include <atomic>
+#include <vector>
+
+struct CachedPayload {
+  String name;
+  uint32_t hash;    // content hash of the source
+  uint8_t *src;     // PSRAM, NUL-terminated
+  size_t srcLen;
+  uint8_t *image;   // PSRAM, nullptr until a run compiles it
+  size_t imageLen;
+  uint32_t used;    // LRU stamp
+};
+
+static SemaphoreHandle_t sLock = nullptr;
+static std::vector<CachedPayload> sEntries;
+static size_t sCapacity = 0;
+static size_t sBytes = 0;
+static uint32_t sStamp = 0;
+static std::atomic<uint32_t> sGeneration{0};
+
+static std::atomic<uint32_t> sHits{0};
+static std::atomic<uint32_t> sMisses{0};
+static std::atomic<uint32_t> sImageHits{0};
+static std::atomic<uint32_t> sInvalidated{0};
+static std::atomic<uint32_t> sEvicted{0};
+
+// PSRAM copy of `len` bytes plus a NUL (String::concat reads one past)
+static uint8_t *psramCopy(const uint8_t *data, size_t len) {
+  uint8_t *p = (uint8_t *)ps_malloc(len + 1);
+  if (!p)
+    return nullptr;
+  memcpy(p, data, len);
+  p[len] = 0;
+  return p;
+}
+
+static int findEntry(const String &name) {
+  for (size_t i = 0; i < sEntries.size(); i++) {
+    if (sEntries[i].name == name)
+      return i;
+  }
+  return -1;
+}
+
+static void freeEntry(size_t i) {
+  CachedPayload &e = sEntries[i];
+  sBytes -= e.srcLen + e.imageLen;
+  free(e.src);
+  free(e.image);
+  sEntries.erase(sEntries.begin() + i);
+}
+
+// Evict least recently used entries, never `keep`, until `need` more
+// bytes fit. False if they can't.
+static bool makeRoom(size_t need, const String &keep) {
+  if (need > sCapacity)
+    return false;
+  while (sBytes + need > sCapacity) {
+    int lru = -1;
+    for (size_t i = 0; i < sEntries.size(); i++) {
+      if (sEntries[i].name != keep &&
+          (lru < 0 || sEntries[i].used < sEntries[lru].used))
+        lru = i;
+    }
+    if (lru < 0)
+      return false;
+    freeEntry(lru);
+    sEvicted.fetch_add(1, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+// ================================================================
+//  Public API
+// ================================================================
+
+void payloadCacheInit() {
+  if (sLock)
+    return;
+  sLock = xSemaphoreCreateMutex();
+  sCapacity = psramFound() ? PAYLOAD_CACHE_BYTES : 0;
+  if (!sCapacity)
+    logPrintf("[Cache] No PSRAM: payload cache off");
+}
+
+bool payloadCacheGet(const String &name, String &out) {
+  if (!sLock)
+    return false;
+  xSemaphoreTake(sLock, portMAX_DELAY);
+  int i = findEntry(name);
+  if (i >= 0) {
+    CachedPayload &e = sEntries[i];
+    e.used = ++sStamp;
+    out = String();
+    out.concat((const char *)e.src, e.srcLen);
+  }
+  xSemaphoreGive(sLock);
+  (i >= 0 ? sHits : sMisses).fetch_add(1, std::memory_order_relaxed);
+  return i >= 0;
+}
+
+uint32_t payloadCacheGeneration() { return sGeneration.load(); }
+
+void payloadCachePut(const String &name, uint32_t hash, const uint8_t *data,
+                     size_t len, uint32_t generation) {
+  if (!sLock)
+    return;
+  xSemaphoreTake(sLock, portMAX_DELAY);
+  if (generation != sGeneration.load()) {
+    xSemaphoreGive(sLock);
+    return;
+  }
+  int i = findEntry(name);
+  if (i >= 0)
+    freeEntry(i);
+  uint8_t *src;
+  if (makeRoom(len, name) && (src = psramCopy(data, len))) {
+    sEntries.push_back({name, hash, src, len, nullptr, 0, ++sStamp});
+    sBytes += len;
+  }
+  xSemaphoreGive(sLock);
+}
+
+bool payloadCacheGetImage(const String &name, String &out) {
+  if (!sLock)
+    return false;
+  xSemaphoreTake(sLock, portMAX_DELAY);
+  int i = findEntry(name);
+  bool hit = i >= 0 && sEntries[i].image;
+  if (hit) {
+    CachedPayload &e = sEntries[i];
+    e.used = ++sStamp;
+    out = String();
+    out.concat((const char *)e.image, e.imageLen);
+  }
+  xSemaphoreGive(sLock);
+  if (hit)
+    sImageHits.fetch_add(1, std::memory_order_relaxed);
+  return hit;
+}
+
+void payloadCachePutImage(const String &name, uint32_t hash,
+                          const uint8_t *code, size_t len) {
+  if (!sLock)
+    return;
+  xSemaphoreTake(sLock, portMAX_DELAY);
+  int i = findEntry(name);
+  // The source may have changed while it compiled
+  if (i >= 0 && sEntries[i].hash == hash && !sEntries[i].image &&
+      makeRoom(len, name)) {
+    CachedPayload &e = sEntries[findEntry(name)];
+    if ((e.image = psramCopy(code, len))) {
+      e.imageLen = len;
+      sBytes += len;
+    }
+  }
+  xSemaphoreGive(sLock);
+}
+
+void payloadCacheDrop(const String &name) {
+  if (!sLock)
+    return;
+  xSemaphoreTake(sLock, portMAX_DELAY);
+  sGeneration++;
+  int i = findEntry(name);
+  if (i >= 0) {
+    freeEntry(i);
+    sInvalidated.fetch_add(1, std::memory_order_relaxed);
+  }
+  xSemaphoreGive(sLock);
+}
+
+void payloadCacheDropImages() {
+  if (!sLock)
+    return;
+  xSemaphoreTake(sLock, portMAX_DELAY);
+  for (CachedPayload &e : sEntries) {
+    sBytes -= e.imageLen;
+    free(e.image);
+    e.image = nullptr;
+    e.imageLen = 0;
+  }
+  xSemaphoreGive(sLock);
+}
+
+PayloadCacheStats payloadCacheGetStats() {
+  PayloadCacheStats s;
+  s.hits = sHits.load(std::memory_order_relaxed);
+  s.misses = sMisses.load(std::memory_order_relaxed);
+  s.imageHits = sImageHits.load(std::memory_order_relaxed);
+  s.invalidated = sInvalidated.load(std::memory_order_relaxed);
+  s.evicted = sEvicted.load(std::memory_order_relaxed);
+  s.entries = 0;
+  s.bytes = 0;
+  s.capacity = sCapacity;
+  if (sLock) {
+    xSemaphoreTake(sLock, portMAX_DELAY);
+    s.entries = sEntries.size();
+    s.bytes = sBytes;
+    xSemaphoreGive(sLock);
+  }
+  return s;
+}
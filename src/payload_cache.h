@@ -0,0 +1,75 @@
+#pragma once
+
+// ============================================================
+//  Payload Cache — Hot Payloads Held in PSRAM
+// ============================================================
+//
+//  A lab session re-runs the same payloads over and over, and each
+//  run used to read (and maybe decompress) the file from LittleFS
+//  and compile it again. This cache keeps, per payload name:
+//
+//    - the source, with its content hash (contentHash);
+//    - once a run has compiled it, the bytecode image, so the next
+//      duckyExecuteFile() only verifies it. Scripts that INCLUDE
+//      modules keep only their source: their image depends on other
+//      payloads, and the modules are cached compiled already
+//      (module_cache.h).
+//
+//  Buffers live in PSRAM (ps_malloc), PAYLOAD_CACHE_BYTES in all,
+//  least recently used out first. Without PSRAM the cache is off.
+//
+//  storage_manager keeps it coherent: savePayload() writes the new
+//  source through, every other write, patch or delete drops the
+//  entry, so a hit is always the current content. Images are
+//  stored only against the hash they were compiled from, and
+//  duckySetLimits() drops them all.
+//
+// ============================================================
+
+#include <Arduino.h>
+
+/// Size the cache and create its lock (idempotent; storageInit()
+/// calls it).
+void payloadCacheInit();
+
+/// Copy the cached source of `name` into `out`. False on a miss.
+bool payloadCacheGet(const String &name, String &out);
+
+/// Bumped by every payloadCacheDrop(). Read it before reading a
+/// payload from flash and pass it to payloadCachePut().
+uint32_t payloadCacheGeneration();
+
+/// Cache `len` bytes of source for `name` (content hash `hash`),
+/// replacing any previous entry. Skipped if it can't fit, or if a
+/// payload changed since `generation` (the copy may be stale).
+void payloadCachePut(const String &name, uint32_t hash, const uint8_t *data,
+                     size_t len, uint32_t generation);
+
+/// Copy the cached image of `name` into `out`. False on a miss.
+bool payloadCacheGetImage(const String &name, String &out);
+
+/// Attach a compiled image to `name`'s entry if it still holds the
+/// source with content hash `hash`.
+void payloadCachePutImage(const String &name, uint32_t hash,
+                          const uint8_t *code, size_t len);
+
+/// Drop `name` (its source changed or is gone).
+void payloadCacheDrop(const String &name);
+
+/// Drop every compiled image, keeping the sources.
+void payloadCacheDropImages();
+
+/// Counters since boot, and the cache's current size.
+struct PayloadCacheStats {
+  uint32_t hits;        // sources served from PSRAM
+  uint32_t misses;      // sources read from LittleFS
+  uint32_t imageHits;   // runs that skipped the compile
+  uint32_t invalidated; // entries dropped: payload changed
+  uint32_t evicted;     // entries dropped for space
+  uint32_t entries;     // payloads cached now
+  uint32_t bytes;       // their source + image bytes
+  uint32_t capacity;    // PAYLOAD_CACHE_BYTES, 0 without PSRAM
+};
+
+/// Snapshot of the payload cache counters.
+PayloadCacheStats payloadCacheGetStats();
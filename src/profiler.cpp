@@ -0,0 +1,154 @@
+// ============================================================
+//  Profiler — Per-Line Execution Timing as Chrome Trace JSON
+// ============================================================
+
+#include "profiler.h"
+#include "config.h"
+
+static ProfileEvent *sEvents = nullptr;
+static volatile bool sEnabled = false;
+static volatile uint32_t sRun = 0;
+static volatile size_t sCount = 0;
+static volatile bool sTruncated = false;
+static uint32_t sRunStartUs = 0;
+
+// ----------------------------------------------------------------
+bool profilerEnable(bool on) {
+  if (on && !sEvents) {
+    size_t bytes = PROFILE_MAX_EVENTS * sizeof(ProfileEvent);
+    sEvents = (ProfileEvent *)(psramFound() ? ps_malloc(bytes)
+                                            : malloc(bytes));
+    if (!sEvents)
+      return false;
+  }
+  sEnabled = on;
+  return true;
+}
+
+bool profilerEnabled() { return sEnabled; }
+
+bool profilerBeginRun() {
+  if (!sEnabled || !sEvents)
+    return false;
+  sCount = 0;
+  sTruncated = false;
+  sRunStartUs = micros();
+  sRun = sRun + 1;
+  return true;
+}
+
+// ----------------------------------------------------------------
+void profilerRecord(uint16_t line, const String &text, uint32_t startUs,
+                    uint32_t durUs, uint32_t reports) {
+  size_t n = sCount;
+  if (n >= PROFILE_MAX_EVENTS) {
+    sTruncated = true;
+    return;
+  }
+  ProfileEvent &e = sEvents[n];
+  e.startUs = startUs - sRunStartUs;
+  e.durUs = durUs;
+  e.reports = reports;
+  e.line = line;
+
+  // Command word only; anything that isn't safe in a JSON string → '?'
+  size_t i = 0;
+  for (; i < PROFILE_LABEL_LEN && i < text.length(); i++) {
+    char c = text.charAt(i);
+    if (c == ' ')
+      break;
+    e.label[i] = (isalnum((unsigned char)c) || c == '_') ? c : '?';
+  }
+  e.label[i] = 0;
+  sCount = n + 1; // publish after the entry is complete
+}
+
+uint32_t profilerLastRun() { return sRun; }
+
+size_t profilerEventCount() { return sCount; }
+
+bool profilerTruncated() { return sTruncated; }
+
+// ================================================================
+//  JSON export
+// ================================================================
+
+static const char *category(const char *label) {
+  if (strncmp(label, "DELAY", 5) == 0 || strncmp(label, "DEFAULT", 7) == 0)
+    return "delay";
+  if (strncmp(label, "STRING", 6) == 0)
+    return "type";
+  if (strncmp(label, "MOUSE_", 6) == 0)
+    return "mouse";
+  if (strcmp(label, "REPEAT") == 0)
+    return "repeat";
+  return "key";
+}
+
+void ProfileJsonWriter::fill() {
+  _pending = "";
+  _pos = 0;
+  if (_stage == 0) {
+    _run = sRun;
+    _pending = "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"run\":";
+    _pending += String(_run);
+    _pending += ",\"truncated\":";
+    _pending += sTruncated ? "true" : "false";
+    _pending += "},\"traceEvents\":[\n"
+                "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+                "\"args\":{\"name\":\"DuckyParser\"}}";
+    _stage = 1;
+    return;
+  }
+  if (_stage == 1) {
+    // A few events per call keeps _pending small
+    for (int k = 0; k < 8; k++) {
+      if (_run != sRun || _next >= sCount) {
+        _stage = 2;
+        break;
+      }
+      const ProfileEvent &e = sEvents[_next++];
+      _reports += e.reports;
+      _pending += ",\n{\"name\":\"";
+      _pending += e.label;
+      _pending += "\",\"cat\":\"";
+      _pending += category(e.label);
+      _pending += "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":";
+      _pending += String(e.startUs);
+      _pending += ",\"dur\":";
+      _pending += String(e.durUs);
+      _pending += ",\"args\":{\"line\":";
+      _pending += String(e.line);
+      _pending += ",\"reports\":";
+      _pending += String(e.reports);
+      _pending += "}},\n{\"name\":\"reports\",\"ph\":\"C\",\"pid\":1,\"ts\":";
+      _pending += String(e.startUs + e.durUs);
+      _pending += ",\"args\":{\"reports\":";
+      _pending += String(_reports);
+      _pending += "}}";
+    }
+    if (_pending.length())
+      return;
+  }
+  if (_stage == 2) {
+    _pending = "\n]}\n";
+    _stage = 3;
+  }
+}
+
+size_t ProfileJsonWriter::read(uint8_t *buf, size_t maxLen) {
+  size_t out = 0;
+  while (out < maxLen) {
+    if (_pos >= _pending.length()) {
+      if (_stage == 3)
+        break;
+      fill();
+      continue;
+    }
+    size_t n = std::min(maxLen - out, (size_t)(_pending.length() - _pos));
+    memcpy(buf + out, _pending.c_str() + _pos, n);
+    _pos += n;
+    out += n;
+  }
+  return out;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+// ============================================================
+//  Profiler — Per-Line Execution Timing as Chrome Trace JSON
+// ============================================================
+//
+//  When enabled, parserTask records one event per executed line:
+//  start, duration and the HID reports it produced. Events go to a
+//  buffer allocated when profiling is switched on, so recording
+//  never allocates; with profiling off the parser pays one branch
+//  per line.
+//
+//  ProfileJsonWriter streams a run as Chrome trace_event JSON
+//  (load in chrome://tracing or ui.perfetto.dev): one complete
+//  ("X") slice per line, categorised delay / type / key / mouse /
+//  repeat, plus a cumulative "reports" counter track. Gaps between
+//  slices are parse and dispatch overhead.
+//
+// ============================================================
+
+#include <Arduino.h>
+
+#define PROFILE_LABEL_LEN 12
+
+struct ProfileEvent {
+  uint32_t startUs;
+  uint32_t durUs;
+  uint32_t reports;
+  uint16_t line;
+  char label[PROFILE_LABEL_LEN + 2]; // command word, NUL-terminated
+};
+
+/// Switch profiling on (allocates the event buffer) or off.
+bool profilerEnable(bool on);
+bool profilerEnabled();
+
+/// Start a new run if profiling is on. Returns true when this run is
+/// being recorded (the parser then calls profilerRecord per line).
+bool profilerBeginRun();
+
+/// Record one executed line (1-based `line`).
+void profilerRecord(uint16_t line, const String &text, uint32_t startUs,
+                    uint32_t durUs, uint32_t reports);
+
+/// Id of the most recent profiled run (0 = none yet), its event count,
+/// and whether it overflowed PROFILE_MAX_EVENTS.
+uint32_t profilerLastRun();
+size_t profilerEventCount();
+bool profilerTruncated();
+
+/// Streams the most recent run as trace_event JSON. Stops early (still
+/// valid JSON) if a newer run starts while streaming.
+class ProfileJsonWriter {
+public:
+  /// Fill up to `maxLen` bytes. Returns 0 once the document is complete.
+  size_t read(uint8_t *buf, size_t maxLen);
+
+private:
+  void fill();
+
+  uint32_t _run = 0;
+  size_t _next = 0;
+  uint32_t _reports = 0;
+  int _stage = 0; // 0 header, 1 events, 2 footer, 3 done
+  String _pending;
+  size_t _pos = 0;
+};
@@ -0,0 +1,179 @@
+// ============================================================
+//  Status Events — Parser Progress, Decoupled from HID Output
+// ============================================================
+
+#include "status_events.h"
+#include "config.h"
+
+#include <atomic>
+
+// Callback of one run, kept for the run and the one after it
+struct RunSlot {
+  uint32_t run;
+  DuckyCallback cb;
+};
+
+static QueueHandle_t sQueue = nullptr;   // transitions
+static StatusEvent sLatest;              // newest progress event
+static bool sHasLatest = false;
+static portMUX_TYPE sMux = portMUX_INITIALIZER_UNLOCKED;
+
+static RunSlot sRuns[2];
+static SemaphoreHandle_t sRunsMutex = nullptr;
+
+static StatusSubscriber sSubscribers[STATUS_MAX_SUBSCRIBERS];
+static std::atomic<int> sSubscriberCount{0};
+
+static std::atomic<uint32_t> sPublished{0};
+static std::atomic<uint32_t> sCoalesced{0};
+static std::atomic<uint32_t> sOverflows{0};
+static std::atomic<uint32_t> sDelivered{0};
+
+static bool isProgress(const StatusEvent &ev) {
+  return ev.status == DuckyStatus::RUNNING && ev.line > 0;
+}
+
+// FINISHED, ERROR or ABORTED: the event a run's callback must see
+static bool isEnd(const StatusEvent &ev) {
+  return ev.status != DuckyStatus::RUNNING;
+}
+
+// Put `ev` in the latest slot, superseding the event there, unless
+// that is an end and `ev` is not: then `ev` is the one dropped
+static void storeLatest(const StatusEvent &ev) {
+  portENTER_CRITICAL(&sMux);
+  bool dropped = sHasLatest;
+  if (!sHasLatest || !isEnd(sLatest) || isEnd(ev))
+    sLatest = ev;
+  sHasLatest = true;
+  portEXIT_CRITICAL(&sMux);
+  if (dropped)
+    sCoalesced.fetch_add(1, std::memory_order_relaxed);
+}
+
+static bool takeLatest(StatusEvent &ev) {
+  portENTER_CRITICAL(&sMux);
+  bool has = sHasLatest;
+  if (has)
+    ev = sLatest;
+  sHasLatest = false;
+  portEXIT_CRITICAL(&sMux);
+  return has;
+}
+
+// Undo takeLatest() unless the parser has published since; an end
+// still wins over progress published meanwhile
+static void restoreLatest(const StatusEvent &ev) {
+  portENTER_CRITICAL(&sMux);
+  bool dropped = sHasLatest && isEnd(ev) && !isEnd(sLatest);
+  if (!sHasLatest || dropped) {
+    sLatest = ev;
+    sHasLatest = true;
+  }
+  portEXIT_CRITICAL(&sMux);
+  if (dropped)
+    sCoalesced.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ================================================================
+//  Status Task
+// ================================================================
+
+static void deliver(const StatusEvent &ev) {
+  DuckyCallback cb;
+  xSemaphoreTake(sRunsMutex, portMAX_DELAY);
+  const RunSlot &slot = sRuns[ev.run % 2];
+  if (slot.run == ev.run)
+    cb = slot.cb;
+  xSemaphoreGive(sRunsMutex);
+
+  if (cb)
+    cb(ev.line, ev.total, ev.status);
+  int n = sSubscriberCount.load(std::memory_order_acquire);
+  for (int i = 0; i < n; i++)
+    sSubscribers[i](ev);
+  sDelivered.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void statusTask(void *param) {
+  uint32_t lastProgressMs = 0;
+  for (;;) {
+    StatusEvent ev, latest;
+    if (xQueueReceive(sQueue, &ev, pdMS_TO_TICKS(STATUS_COALESCE_MS)) ==
+        pdTRUE) {
+      // Keep order against the latest slot
+      if (takeLatest(latest)) {
+        if (latest.run < ev.run)
+          deliver(latest); // last progress of the previous run
+        else if (isProgress(latest) && ev.status != DuckyStatus::RUNNING)
+          sCoalesced.fetch_add(1, std::memory_order_relaxed); // run ended
+        else
+          restoreLatest(latest); // newer than ev: after it
+      }
+      deliver(ev);
+    }
+    // While transitions are queued the slot waits: the receive above
+    // orders it against them (an end there overflowed the queue, so
+    // the queued events of its run are older)
+    if (millis() - lastProgressMs >= STATUS_COALESCE_MS &&
+        !uxQueueMessagesWaiting(sQueue) && takeLatest(latest)) {
+      deliver(latest);
+      lastProgressMs = millis();
+    }
+  }
+}
+
+// ================================================================
+//  Public API
+// ================================================================
+
+void statusInit() {
+  if (sQueue)
+    return;
+  sQueue = xQueueCreate(STATUS_QUEUE_LEN, sizeof(StatusEvent));
+  sRunsMutex = xSemaphoreCreateMutex();
+  xTaskCreatePinnedToCore(statusTask, "Status", STATUS_TASK_STACK, nullptr,
+                          STATUS_TASK_PRIO, nullptr, tskNO_AFFINITY);
+}
+
+bool statusSubscribe(StatusSubscriber fn) {
+  int n = sSubscriberCount.load(std::memory_order_relaxed);
+  if (n >= STATUS_MAX_SUBSCRIBERS)
+    return false;
+  sSubscribers[n] = fn;
+  sSubscriberCount.store(n + 1, std::memory_order_release);
+  return true;
+}
+
+void statusBeginRun(uint32_t run, DuckyCallback cb) {
+  xSemaphoreTake(sRunsMutex, portMAX_DELAY);
+  sRuns[run % 2].run = run;
+  sRuns[run % 2].cb = cb;
+  xSemaphoreGive(sRunsMutex);
+}
+
+void statusPublish(uint32_t run, int line, int total, DuckyStatus st) {
+  StatusEvent ev = {run, line, total, st, (uint32_t)millis()};
+  sPublished.fetch_add(1, std::memory_order_relaxed);
+  if (isProgress(ev)) {
+    storeLatest(ev);
+    return;
+  }
+  // The last queue entry is kept for an end, so a start can't crowd
+  // one out. A transition that finds no room waits in the latest
+  // slot instead, where only another end can replace an end.
+  bool room = isEnd(ev) || uxQueueSpacesAvailable(sQueue) > 1;
+  if (!room || xQueueSend(sQueue, &ev, 0) != pdTRUE) {
+    sOverflows.fetch_add(1, std::memory_order_relaxed);
+    storeLatest(ev);
+  }
+}
+
+StatusStats statusGetStats() {
+  StatusStats s;
+  s.published = sPublished.load(std::memory_order_relaxed);
+  s.coalesced = sCoalesced.load(std::memory_order_relaxed);
+  s.overflows = sOverflows.load(std::memory_order_relaxed);
+  s.delivered = sDelivered.load(std::memory_order_relaxed);
+  return s;
+}
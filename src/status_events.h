@@ -0,0 +1,67 @@
+#pragma once
+
+// ============================================================
+//  Status Events — Parser Progress, Decoupled from HID Output
+// ============================================================
+//
+//  The parser task publishes fixed-size events and never waits:
+//
+//    - transitions (start, FINISHED, ERROR, ABORTED) go into a
+//      bounded queue of STATUS_QUEUE_LEN, whose last entry only an
+//      end (FINISHED, ERROR, ABORTED) may take;
+//    - progress (RUNNING, line > 0) overwrites a single "latest"
+//      slot, so a fast script costs one copy per line, not a queue
+//      entry. A transition that finds the queue full waits there
+//      too; an end in the slot is replaced only by a newer end.
+//
+//  A low-priority status task delivers them in order to the run's
+//  own DuckyCallback (duckyExecute) and to every subscriber, with
+//  progress coalesced to at most one event per STATUS_COALESCE_MS.
+//  Callbacks and subscribers therefore run on the status task: they
+//  may log or block without stalling keystrokes, but they see only
+//  some of the RUNNING lines (always the start and the final event).
+//
+// ============================================================
+
+#include "ducky_parser.h"
+
+#include <Arduino.h>
+
+/// One status change of one script run.
+struct StatusEvent {
+  uint32_t run;       // script number since boot (1, 2, ...)
+  int32_t line;       // current line (0 = started)
+  int32_t total;      // lines in the script
+  DuckyStatus status;
+  uint32_t ms;        // millis() when published
+};
+
+/// Subscriber, called on the status task for every delivered event.
+typedef void (*StatusSubscriber)(const StatusEvent &ev);
+
+/// Create the queue and the status task (idempotent; duckyInit()
+/// calls it).
+void statusInit();
+
+/// Add a subscriber (up to STATUS_MAX_SUBSCRIBERS; call during
+/// setup). False if the table is full.
+bool statusSubscribe(StatusSubscriber fn);
+
+/// Parser side: register `cb` for run `run` before its first event.
+/// The two most recent runs keep their callbacks.
+void statusBeginRun(uint32_t run, DuckyCallback cb);
+
+/// Parser side: publish an event. Never blocks.
+void statusPublish(uint32_t run, int line, int total, DuckyStatus st);
+
+/// Pipeline counters since boot.
+struct StatusStats {
+  uint32_t published; // events from the parser
+  uint32_t coalesced; // events replaced or dropped in the latest slot
+  uint32_t overflows; // transitions that found the queue full
+                      // (kept in the latest slot instead)
+  uint32_t delivered; // events handed to callbacks and subscribers
+};
+
+/// Snapshot of the pipeline counters.
+StatusStats statusGetStats();
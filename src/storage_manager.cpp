@@ -3,16 +3,107 @@
 // ============================================================
 
 #include "storage_manager.h"
+#include "boot_trace.h"
 #include "config.h"
+#include "logger.h"
+#include "payload_cache.h"
 
 #include <LittleFS.h>
+#include <atomic>
+#include <map>
+
+// Content hash and size by payload name, dropped whenever the file is
+// written.
+struct ContentId {
+  uint32_t hash;
+  size_t size;
+};
+static std::map<String, ContentId> sHashCache;
+
+static PayloadChangeFn sOnChange = nullptr;
+
+// Cached getCompressionStats() totals, recomputed after any write.
+static bool sStatsValid = false;
+static size_t sRawBytes = 0;
+static size_t sStoredBytes = 0;
+
+// Guards the caches above: web handlers (async_tcp) and the parser task
+// (runs, INCLUDE) use them at once. Never held across file I/O; a value
+// computed from a read is only cached if no write came in meanwhile
+// (sGeneration). Created by storageInit(); host tools that never call
+// it are single-threaded.
+static SemaphoreHandle_t sLock = nullptr;
+static uint32_t sGeneration = 0;
+
+static void lockCaches() {
+  if (sLock)
+    xSemaphoreTake(sLock, portMAX_DELAY);
+}
+
+static void unlockCaches() {
+  if (sLock)
+    xSemaphoreGive(sLock);
+}
+
+static uint32_t cacheGeneration() {
+  lockCaches();
+  uint32_t g = sGeneration;
+  unlockCaches();
+  return g;
+}
+
+// A write to `name` (or any payload, for the totals) is under way or done
+static void invalidateCaches(const String &name) {
+  lockCaches();
+  sHashCache.erase(name);
+  sStatsValid = false;
+  sGeneration++;
+  unlockCaches();
+}
+
+static void cacheHash(const String &name, uint32_t hash, size_t size,
+                      uint32_t generation) {
+  lockCaches();
+  if (generation == sGeneration)
+    sHashCache[name] = {hash, size};
+  unlockCaches();
+}
+
+// I/O counters (storageGetStats)
+static std::atomic<uint32_t> sReads{0};
+static std::atomic<uint32_t> sWrites{0};
+static std::atomic<uint32_t> sDeletes{0};
+static std::atomic<uint32_t> sFailures{0};
+static std::atomic<uint64_t> sBytesRead{0};
+static std::atomic<uint64_t> sBytesWritten{0};
+
+static void notifyChange(const String &name) {
+  payloadCacheDrop(name);
+  if (sOnChange)
+    sOnChange(name);
+}
+
+static String payloadPath(const String &name) {
+  return String(PAYLOAD_DIR) + "/" + name;
+}
+
+static String stagingPath(const String &name) {
+  return String(STAGING_DIR) + "/" + name;
+}
+
+// Compressed payload files: "DZ1\0", u32 content size (LE), LZ stream.
+static const uint8_t LZ_FILE_MAGIC[4] = {'D', 'Z', '1', 0};
+#define LZ_FILE_HEADER 8
 
 // ----------------------------------------------------------------
 bool storageInit() {
+  if (!sLock)
+    sLock = xSemaphoreCreateMutex();
   if (!LittleFS.begin(true)) { // true = format on fail
-    Serial.println("[Storage] LittleFS mount failed!");
+    logPrintf("[Storage] LittleFS mount failed!");
     return false;
   }
+  bootTraceMark("littlefs mounted");
 
   // Ensure payload directory exists
   if (!LittleFS.exists(PAYLOAD_DIR)) {
@@ -24,7 +115,14 @@ bool storageInit() {
     LittleFS.mkdir("/config");
   }
 
-  Serial.println("[Storage] LittleFS mounted OK");
+  // Ensure staging directory exists
+  if (!LittleFS.exists(STAGING_DIR)) {
+    LittleFS.mkdir(STAGING_DIR);
+  }
+
+  payloadCacheInit();
+  bootTraceMark("storage dirs ready");
+  logPrintf("[Storage] LittleFS mounted OK");
   return true;
 }
 
@@ -48,33 +146,332 @@ std::vector<String> listPayloads() {
 
 // ----------------------------------------------------------------
 String readPayload(const String &name) {
-  String path = String(PAYLOAD_DIR) + "/" + name;
-  File f = LittleFS.open(path, "r");
-  if (!f)
+  String content;
+  if (payloadCacheGet(name, content))
+    return content;
+
+  uint32_t generation = payloadCacheGeneration();
+  uint32_t hashGeneration = cacheGeneration();
+  PayloadReader r;
+  if (!r.open(name))
     return "";
-  String content = f.readString();
-  f.close();
+  content.reserve(r.size());
+  uint8_t buf[256];
+  uint32_t h = contentHash(nullptr, 0);
+  size_t n;
+  while ((n = r.read(buf, sizeof(buf))) > 0) {
+    content.concat((const char *)buf, n);
+    h = contentHash(buf, n, h);
+  }
+  if (content.length() == r.size()) {
+    cacheHash(name, h, content.length(), hashGeneration);
+    payloadCachePut(name, h, (const uint8_t *)content.c_str(),
+                    content.length(), generation);
+  }
   return content;
 }
 
 // ----------------------------------------------------------------
-bool savePayload(const String &name, const String &content) {
+bool savePayload(const String &name, const String &content, bool compress) {
   if (content.length() > MAX_PAYLOAD_SIZE)
     return false;
 
-  String path = String(PAYLOAD_DIR) + "/" + name;
-  File f = LittleFS.open(path, "w");
-  if (!f)
+  PayloadWriter w;
+  if (!w.begin(name, compress && content.length() >= PAYLOAD_COMPRESS_MIN))
     return false;
-  f.print(content);
-  f.close();
+  w.write((const uint8_t *)content.c_str(), content.length());
+  if (!w.commit())
+    return false;
+  // Write-through: the next read of it is a hit
+  payloadCachePut(name, w.hash(), (const uint8_t *)content.c_str(),
+                  content.length(), payloadCacheGeneration());
   return true;
 }
 
 // ----------------------------------------------------------------
 bool deletePayload(const String &name) {
-  String path = String(PAYLOAD_DIR) + "/" + name;
-  return LittleFS.remove(path);
+  sDeletes++;
+  bool ok = LittleFS.remove(payloadPath(name));
+  invalidateCaches(name);
+  notifyChange(name);
+  return ok;
+}
+
+// ----------------------------------------------------------------
+// Apply `edits` in order to the `stored` bytes of `name` and save the
+// result once
+static bool rewritePayload(const String &name,
+                           const std::vector<PayloadEdit> &edits,
+                           size_t stored, bool compressed) {
+  String content = readPayload(name);
+  if (content.length() != stored)
+    return false; // read failed: don't patch a truncated base
+  for (auto &e : edits) {
+    size_t size = content.length();
+    if (e.offset > size || e.remove > size - e.offset ||
+        size - e.remove + e.text.length() > MAX_PAYLOAD_SIZE) {
+      return false;
+    }
+    content = content.substring(0, e.offset) + e.text +
+              content.substring(e.offset + e.remove);
+  }
+  return edits.empty() || savePayload(name, content, compressed);
+}
+
+bool patchPayload(const String &name, size_t offset, size_t removeLen,
+                  const String &data) {
+  PayloadReader r;
+  if (!r.open(name))
+    return false;
+
+  size_t size = r.size();
+  bool compressed = r.compressed();
+  r.close();
+  if (offset > size || removeLen > size - offset ||
+      size - removeLen + data.length() > MAX_PAYLOAD_SIZE) {
+    return false;
+  }
+
+  // Same-length replacement in a plain file: overwrite the range
+  if (removeLen == data.length() && !compressed) {
+    File f = LittleFS.open(payloadPath(name), "r+");
+    bool ok = f && f.seek(offset) &&
+              f.write((const uint8_t *)data.c_str(), data.length()) ==
+                  data.length();
+    f.close();
+    if (ok) {
+      sWrites++;
+      sBytesWritten += data.length();
+    } else {
+      sFailures++;
+    }
+    invalidateCaches(name);
+    notifyChange(name);
+    return ok;
+  }
+
+  return rewritePayload(name, {PayloadEdit{offset, removeLen, data}}, size,
+                        compressed);
+}
+
+bool patchPayload(const String &name, const std::vector<PayloadEdit> &edits) {
+  if (edits.size() == 1)
+    return patchPayload(name, edits[0].offset, edits[0].remove, edits[0].text);
+
+  PayloadReader r;
+  if (!r.open(name))
+    return false;
+  size_t stored = r.size();
+  bool compressed = r.compressed();
+  r.close();
+  return rewritePayload(name, edits, stored, compressed);
+}
+
+// ----------------------------------------------------------------
+int payloadSize(const String &name) {
+  PayloadReader r;
+  if (!r.open(name))
+    return -1;
+  return r.size();
+}
+
+// ----------------------------------------------------------------
+// Hash and size of one version of `name`, from the cache or one read
+static bool contentId(const String &name, ContentId &id) {
+  lockCaches();
+  auto it = sHashCache.find(name);
+  bool cached = it != sHashCache.end();
+  if (cached)
+    id = it->second;
+  uint32_t generation = sGeneration;
+  unlockCaches();
+  if (cached)
+    return true;
+
+  PayloadReader r;
+  if (!r.open(name))
+    return false;
+  uint8_t buf[256];
+  id = {contentHash(nullptr, 0), 0};
+  size_t n;
+  while ((n = r.read(buf, sizeof(buf))) > 0) {
+    id.hash = contentHash(buf, n, id.hash);
+    id.size += n;
+  }
+  if (id.size != r.size())
+    return false; // read failed part-way
+  cacheHash(name, id.hash, id.size, generation);
+  return true;
+}
+
+uint32_t payloadHash(const String &name) {
+  ContentId id;
+  return contentId(name, id) ? id.hash : 0;
+}
+
+bool payloadUnchanged(const String &name, uint32_t hash, size_t size) {
+  ContentId id;
+  return contentId(name, id) && id.hash == hash && id.size == size;
+}
+
+// ----------------------------------------------------------------
+void storageOnChange(PayloadChangeFn fn) { sOnChange = fn; }
+
+// ----------------------------------------------------------------
+uint32_t contentHash(const uint8_t *data, size_t len, uint32_t seed) {
+  uint32_t h = seed;
+  for (size_t i = 0; i < len; i++) {
+    h ^= data[i];
+    h *= 0x01000193;
+  }
+  return h;
+}
+
+// ----------------------------------------------------------------
+bool isValidPayloadName(const String &name) {
+  return name.length() > 0 && name.length() <= MAX_PAYLOAD_NAME &&
+         name.indexOf('/') < 0 && name != "." && name != "..";
+}
+
+// ----------------------------------------------------------------
+bool PayloadWriter::begin(const String &name, bool compress) {
+  abort();
+  if (!isValidPayloadName(name))
+    return false;
+  _file = LittleFS.open(stagingPath(name), "w");
+  if (!_file)
+    return false;
+
+  // Header's size field is filled in by commit()
+  _compress = compress;
+  if (_compress) {
+    uint8_t header[LZ_FILE_HEADER] = {0};
+    memcpy(header, LZ_FILE_MAGIC, sizeof(LZ_FILE_MAGIC));
+    if (_file.write(header, sizeof(header)) != sizeof(header) ||
+        !_enc.begin(_file)) {
+      _file.close();
+      LittleFS.remove(stagingPath(name));
+      return false;
+    }
+  }
+  _name = name;
+  _hash = contentHash(nullptr, 0);
+  _size = 0;
+  _ok = true;
+  return true;
+}
+
+size_t PayloadWriter::write(const uint8_t *data, size_t len) {
+  if (!_ok)
+    return 0;
+  if (_size + len > MAX_PAYLOAD_SIZE) {
+    _ok = false;
+    return 0;
+  }
+  size_t n = _compress ? _enc.write(data, len) : _file.write(data, len);
+  if (n != len) {
+    _ok = false;
+    return 0;
+  }
+  _hash = contentHash(data, len, _hash);
+  _size += len;
+  return len;
+}
+
+bool PayloadWriter::commit() {
+  if (!_file)
+    return false;
+  if (_compress && _ok) {
+    uint8_t size[4];
+    for (int i = 0; i < 4; i++)
+      size[i] = (uint8_t)(_size >> (8 * i));
+    _ok = _enc.finish() && _file.seek(sizeof(LZ_FILE_MAGIC)) &&
+          _file.write(size, sizeof(size)) == sizeof(size);
+  }
+  size_t stored = _file.size();
+  _file.close();
+  String staged = stagingPath(_name);
+  if (!_ok) {
+    LittleFS.remove(staged);
+    sFailures++;
+    return false;
+  }
+
+  // rename() replaces an existing payload atomically (lfs_rename), so
+  // a failure or power cut here leaves the old version in place
+  String path = payloadPath(_name);
+  invalidateCaches(_name);
+  if (!LittleFS.rename(staged, path)) {
+    LittleFS.remove(staged);
+    _ok = false;
+    sFailures++;
+    return false;
+  }
+  sWrites++;
+  sBytesWritten += stored;
+  cacheHash(_name, _hash, _size, cacheGeneration());
+  _ok = false;
+  notifyChange(_name);
+  return true;
+}
+
+void PayloadWriter::abort() {
+  if (!_file)
+    return;
+  _enc.end();
+  _file.close();
+  LittleFS.remove(stagingPath(_name));
+  _ok = false;
+}
+
+// ----------------------------------------------------------------
+bool PayloadReader::open(const String &name) {
+  return isValidPayloadName(name) && openFile(payloadPath(name));
+}
+
+bool PayloadReader::openFile(const String &path) {
+  close();
+  _file = LittleFS.open(path, "r");
+  if (!_file) {
+    sFailures++;
+    return false;
+  }
+  sReads++;
+
+  _stored = _file.size();
+  uint8_t header[LZ_FILE_HEADER];
+  _compressed =
+      _stored >= LZ_FILE_HEADER &&
+      _file.read(header, sizeof(header)) == sizeof(header) &&
+      memcmp(header, LZ_FILE_MAGIC, sizeof(LZ_FILE_MAGIC)) == 0;
+
+  if (!_compressed) {
+    _size = _stored;
+    _file.seek(0);
+    return true;
+  }
+  _size = 0;
+  for (int i = 0; i < 4; i++)
+    _size |= (size_t)header[4 + i] << (8 * i);
+  if (!_dec.begin(_file, _size)) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+size_t PayloadReader::read(uint8_t *buf, size_t len) {
+  if (!_file)
+    return 0;
+  size_t n = _compressed ? _dec.read(buf, len) : _file.read(buf, len);
+  sBytesRead += n;
+  return n;
+}
+
+void PayloadReader::close() {
+  _dec.end();
+  if (_file)
+    _file.close();
 }
 
 // ----------------------------------------------------------------
@@ -108,3 +505,43 @@ void getStorageInfo(size_t &totalBytes, size_t &usedBytes) {
   totalBytes = LittleFS.totalBytes();
   usedBytes = LittleFS.usedBytes();
 }
+
+// ----------------------------------------------------------------
+void getCompressionStats(size_t &rawBytes, size_t &storedBytes) {
+  lockCaches();
+  bool valid = sStatsValid;
+  rawBytes = sRawBytes;
+  storedBytes = sStoredBytes;
+  uint32_t generation = sGeneration;
+  unlockCaches();
+  if (valid)
+    return;
+
+  rawBytes = storedBytes = 0;
+  PayloadReader r;
+  for (auto &name : listPayloads()) {
+    if (r.open(name)) {
+      rawBytes += r.size();
+      storedBytes += r.storedSize();
+    }
+  }
+  lockCaches();
+  if (generation == sGeneration) {
+    sRawBytes = rawBytes;
+    sStoredBytes = storedBytes;
+    sStatsValid = true;
+  }
+  unlockCaches();
+}
+
+// ----------------------------------------------------------------
+StorageStats storageGetStats() {
+  StorageStats st;
+  st.reads = sReads;
+  st.writes = sWrites;
+  st.deletes = sDeletes;
+  st.failures = sFailures;
+  st.bytesRead = sBytesRead;
+  st.bytesWritten = sBytesWritten;
+  return st;
+}
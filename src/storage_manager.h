@@ -4,7 +4,9 @@
 //  Storage Manager — LittleFS Payload CRUD
 // ============================================================
 
+#include "lz_codec.h"
 #include <Arduino.h>
+#include <FS.h>
 #include <vector>
 
 /// Initialize LittleFS and create required directories.
@@ -13,15 +15,124 @@ bool storageInit();
 /// List all payload filenames in PAYLOAD_DIR.
 std::vector<String> listPayloads();
 
-/// Read a payload's content by name.
+/// Read a payload's content by name (decompressed).
 String readPayload(const String &name);
 
-/// Save (create/overwrite) a payload.
-bool savePayload(const String &name, const String &content);
+/// Save (create/overwrite) a payload. With `compress`, payloads of at
+/// least PAYLOAD_COMPRESS_MIN bytes are stored LZ-compressed.
+bool savePayload(const String &name, const String &content,
+                 bool compress = true);
 
 /// Delete a payload by name.
 bool deletePayload(const String &name);
 
+/// Replace `removeLen` bytes at `offset` with `data` (byte-range edit).
+/// Same-length edits to plain files are written in place; anything
+/// else rewrites the file (keeping its compression).
+bool patchPayload(const String &name, size_t offset, size_t removeLen,
+                  const String &data);
+
+/// One byte-range edit: replace `remove` bytes at `offset` with `text`.
+struct PayloadEdit {
+  size_t offset;
+  size_t remove;
+  String text;
+};
+
+/// Apply `edits` in order (each offset refers to the previous result)
+/// as one write: every range is checked before anything is written,
+/// and the result is committed once, so on false the payload is
+/// unchanged.
+bool patchPayload(const String &name, const std::vector<PayloadEdit> &edits);
+
+/// Size of a payload's content in bytes (-1 if missing).
+int payloadSize(const String &name);
+
+/// Content hash of a payload (0 if missing). Cached until the next write.
+uint32_t payloadHash(const String &name);
+
+/// True if payload `name` holds `size` bytes with content hash `hash`.
+/// Both come from one version of the file, even while another task
+/// writes it.
+bool payloadUnchanged(const String &name, uint32_t hash, size_t size);
+
+/// Called with a payload's name after it was written, patched or
+/// deleted, on the task that changed it.
+typedef void (*PayloadChangeFn)(const String &name);
+
+/// Set the change listener (one; the INCLUDE module cache uses it).
+void storageOnChange(PayloadChangeFn fn);
+
+/// 32-bit FNV-1a hash, chainable across buffers via `seed`.
+uint32_t contentHash(const uint8_t *data, size_t len,
+                     uint32_t seed = 0x811C9DC5);
+
+/// True if `name` is usable as a payload filename (no path separators).
+bool isValidPayloadName(const String &name);
+
+/// Streams a payload to flash in chunks. Data goes to a staging file;
+/// the previous version stays intact until commit() moves it into place.
+class PayloadWriter {
+public:
+  ~PayloadWriter() { abort(); }
+
+  /// Start writing `name`, LZ-compressed if `compress`.
+  /// Returns false if the staging file can't open.
+  bool begin(const String &name, bool compress = false);
+
+  /// Append a chunk. Returns bytes written (0 once the writer has failed).
+  size_t write(const uint8_t *data, size_t len);
+
+  /// Finish the file and replace the payload. False if any write failed.
+  bool commit();
+
+  /// Discard the staging file.
+  void abort();
+
+  /// Content hash / byte count of everything written so far.
+  uint32_t hash() const { return _hash; }
+  size_t size() const { return _size; }
+
+private:
+  String _name;
+  File _file;
+  LzEncoder _enc;
+  bool _compress = false;
+  uint32_t _hash = 0;
+  size_t _size = 0;
+  bool _ok = false;
+};
+
+/// Reads a payload's content, decompressing on the fly when it was
+/// stored compressed (only an LZ_WINDOW-byte history is held in RAM).
+class PayloadReader {
+public:
+  ~PayloadReader() { close(); }
+
+  /// Open a payload by name.
+  bool open(const String &name);
+
+  /// Open a payload by full LittleFS path.
+  bool openFile(const String &path);
+
+  /// Read up to `len` content bytes. Returns 0 at the end.
+  size_t read(uint8_t *buf, size_t len);
+
+  void close();
+
+  /// Content size, and bytes actually occupied on flash.
+  size_t size() const { return _size; }
+  size_t storedSize() const { return _stored; }
+  bool compressed() const { return _compressed; }
+
+private:
+  File _file;
+  LzDecoder _dec;
+  bool _compressed = false;
+  size_t _size = 0;
+  size_t _stored = 0;
+};
+
 /// Get the autorun payload filename (empty string if none).
 String getAutoRunPayload();
 
@@ -30,3 +141,19 @@ bool setAutoRunPayload(const String &name);
 
 /// Get total and used bytes on LittleFS.
 void getStorageInfo(size_t &totalBytes, size_t &usedBytes);
+
+/// Sum payload content sizes vs. bytes they occupy on flash.
+void getCompressionStats(size_t &rawBytes, size_t &storedBytes);
+
+/// LittleFS payload I/O counters since boot.
+struct StorageStats {
+  uint32_t reads;        // payloads opened for reading
+  uint32_t writes;       // payloads committed
+  uint32_t deletes;
+  uint32_t failures;     // failed opens/commits
+  uint64_t bytesRead;    // content bytes returned by PayloadReader
+  uint64_t bytesWritten; // bytes committed to flash
+};
+
+/// Snapshot of the I/O counters.
+StorageStats storageGetStats();
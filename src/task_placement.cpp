@@ -0,0 +1,171 @@
+// ============================================================
+//  Task Placement — Runtime Core Affinity & Priority
+// ============================================================
+
+#include "task_placement.h"
+#include "config.h"
+
+#include <LittleFS.h>
+
+struct RoleState {
+  const char *name;
+  TaskPlacement p;
+  int8_t runningCore;    // core the current task was created on
+  TaskHandle_t *handle;  // owner's handle variable (placementSpawn)
+  TaskHandle_t adopted;  // or a task created elsewhere
+  TaskFunction_t fn;     // placementSpawn() arguments, for respawns
+  const char *taskName;
+  uint32_t stack;
+};
+
+static RoleState sRoles[TASK_ROLE_COUNT] = {
+    {"parser", {PARSER_TASK_CORE, PARSER_TASK_PRIO}, -1},
+    {"live", {LIVE_TASK_CORE, LIVE_TASK_PRIO}, -1},
+    {"web", {WEB_TASK_CORE, WEB_TASK_PRIO}, -1},
+    {"logger", {LOG_TASK_CORE, LOG_TASK_PRIO}, -1},
+};
+static portMUX_TYPE sMux = portMUX_INITIALIZER_UNLOCKED;
+
+static BaseType_t coreArg(int8_t core) {
+  return core < 0 ? tskNO_AFFINITY : core;
+}
+
+// One "role core prio" line per role
+static void save() {
+  File f = LittleFS.open(TASK_PLACEMENT_FILE, "w");
+  if (!f)
+    return;
+  for (const RoleState &r : sRoles)
+    f.printf("%s %d %u\n", r.name, r.p.core, r.p.prio);
+  f.close();
+}
+
+static const char *validate(TaskRole role, TaskPlacement p) {
+  if (p.core < -1 || p.core > 1)
+    return "core must be 0, 1 or -1 (either)";
+  if (p.prio < 1 || p.prio > TASK_PRIO_MAX)
+    return "priority out of range";
+  if (role == TASK_ROLE_WEB && p.core != sRoles[role].p.core)
+    return "the web task's core is fixed at build time";
+  return nullptr;
+}
+
+// ================================================================
+//  Public API
+// ================================================================
+
+void placementInit() {
+  File f = LittleFS.open(TASK_PLACEMENT_FILE, "r");
+  if (!f)
+    return;
+  String text = f.readString();
+  f.close();
+
+  int start = 0;
+  while (start < (int)text.length()) {
+    int end = text.indexOf('\n', start);
+    if (end < 0)
+      end = text.length();
+    char name[16];
+    int core, prio;
+    TaskRole role;
+    String line = text.substring(start, end);
+    start = end + 1;
+    if (sscanf(line.c_str(), "%15s %d %d", name, &core, &prio) != 3 ||
+        !placementRoleFromName(name, role))
+      continue;
+    // Clamp to values validate() still rejects, not wrap into range
+    TaskPlacement p = {(int8_t)constrain(core, -2, 2),
+                       (uint8_t)constrain(prio, 0, 255)};
+    if (!validate(role, p))
+      sRoles[role].p = p;
+  }
+
+  // The logger starts before this; a new core reaches it through
+  // placementMoveDue(), its priority here
+  for (const RoleState &r : sRoles) {
+    if (r.handle && *r.handle)
+      vTaskPrioritySet(*r.handle, r.p.prio);
+  }
+}
+
+TaskPlacement placementGet(TaskRole role) {
+  portENTER_CRITICAL(&sMux);
+  TaskPlacement p = sRoles[role].p;
+  portEXIT_CRITICAL(&sMux);
+  return p;
+}
+
+const char *placementSet(TaskRole role, TaskPlacement p) {
+  if (const char *err = validate(role, p))
+    return err;
+
+  portENTER_CRITICAL(&sMux);
+  RoleState &r = sRoles[role];
+  r.p = p;
+  TaskHandle_t task = r.handle ? *r.handle : r.adopted;
+  portEXIT_CRITICAL(&sMux);
+
+  if (task)
+    vTaskPrioritySet(task, p.prio);
+  save();
+  return nullptr;
+}
+
+const char *placementRoleName(TaskRole role) {
+  return role < TASK_ROLE_COUNT ? sRoles[role].name : "?";
+}
+
+bool placementRoleFromName(const String &name, TaskRole &role) {
+  for (int i = 0; i < TASK_ROLE_COUNT; i++) {
+    if (name == sRoles[i].name) {
+      role = (TaskRole)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+int8_t placementRunningCore(TaskRole role) {
+  const RoleState &r = sRoles[role];
+  bool running = r.handle ? *r.handle != nullptr : r.adopted != nullptr;
+  return running ? r.runningCore : -1;
+}
+
+BaseType_t placementSpawn(TaskRole role, TaskFunction_t fn, const char *name,
+                          uint32_t stack, TaskHandle_t *handle) {
+  portENTER_CRITICAL(&sMux);
+  RoleState &r = sRoles[role];
+  r.fn = fn;
+  r.taskName = name;
+  r.stack = stack;
+  r.handle = handle;
+  r.runningCore = r.p.core;
+  TaskPlacement p = r.p;
+  portEXIT_CRITICAL(&sMux);
+
+  return xTaskCreatePinnedToCore(fn, name, stack, nullptr, p.prio, handle,
+                                 coreArg(p.core));
+}
+
+void placementAdopt(TaskRole role, TaskHandle_t task, int8_t core) {
+  portENTER_CRITICAL(&sMux);
+  RoleState &r = sRoles[role];
+  r.adopted = task;
+  r.runningCore = core;
+  TaskPlacement p = r.p;
+  portEXIT_CRITICAL(&sMux);
+
+  if (task)
+    vTaskPrioritySet(task, p.prio);
+}
+
+bool placementMoveDue(TaskRole role) {
+  const RoleState &r = sRoles[role];
+  return r.p.core != r.runningCore;
+}
+
+void placementRespawn(TaskRole role) {
+  const RoleState &r = sRoles[role];
+  placementSpawn(role, r.fn, r.taskName, r.stack, r.handle);
+}
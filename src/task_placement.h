@@ -0,0 +1,77 @@
+#pragma once
+
+// ============================================================
+//  Task Placement — Runtime Core Affinity & Priority
+// ============================================================
+//
+//  On ESP32-S3 Arduino the Wi-Fi driver and lwIP run on core 0,
+//  loop() on core 1 and AsyncTCP wherever CONFIG_ASYNC_TCP_RUNNING_CORE
+//  puts it. Where the parser and HID output should run depends on
+//  that mix, so each role's core and priority can be changed at run
+//  time (GET/POST /api/tasks) and measured with the contention test
+//  (contention.h). Changes are saved to TASK_PLACEMENT_FILE.
+//
+//  FreeRTOS can't move a running task to another core, so:
+//    - priorities apply at once (vTaskPrioritySet);
+//    - the parser picks its core up with the next script;
+//    - long-lived tasks (live HID, logger) poll placementMoveDue()
+//      between units of work and re-create themselves on the new
+//      core with placementRespawn();
+//    - the AsyncTCP core is fixed at build time; only its priority
+//      can change.
+//
+// ============================================================
+
+#include <Arduino.h>
+
+enum TaskRole : uint8_t {
+  TASK_ROLE_PARSER,   // DuckyParser — script execution
+  TASK_ROLE_LIVE_HID, // LiveHID — WebSocket keyboard/mouse output
+  TASK_ROLE_WEB,      // async_tcp — HTTP / WebSocket handlers
+  TASK_ROLE_LOGGER,   // Logger — log drain
+  TASK_ROLE_COUNT
+};
+
+/// Where a role's task runs. core: 0, 1, or -1 for either core.
+struct TaskPlacement {
+  int8_t core;
+  uint8_t prio;
+};
+
+/// Load saved placements (call after storageInit(), before the
+/// tasks start). Missing or bad entries keep the config.h defaults.
+void placementInit();
+
+/// Current placement of `role`.
+TaskPlacement placementGet(TaskRole role);
+
+/// Change a role's placement and save it. Returns nullptr, or why
+/// the placement was refused.
+const char *placementSet(TaskRole role, TaskPlacement p);
+
+/// "parser", "live", "web", "logger".
+const char *placementRoleName(TaskRole role);
+
+/// Role for a name from placementRoleName(); false if unknown.
+bool placementRoleFromName(const String &name, TaskRole &role);
+
+/// Core the role's task was actually created on (-1 = either, or
+/// the task isn't running).
+int8_t placementRunningCore(TaskRole role);
+
+/// Create the role's task with its current placement. The task
+/// handle is kept in `*handle` (and used for priority changes).
+BaseType_t placementSpawn(TaskRole role, TaskFunction_t fn, const char *name,
+                          uint32_t stack, TaskHandle_t *handle);
+
+/// Register a task created elsewhere (e.g. by a library) so priority
+/// changes reach it. Its core is reported as `core`.
+void placementAdopt(TaskRole role, TaskHandle_t task, int8_t core);
+
+/// True if the role's core changed since its task was created. The
+/// task should then call placementRespawn() and end itself.
+bool placementMoveDue(TaskRole role);
+
+/// Re-create the role's task on its new core with the arguments of
+/// the last placementSpawn(). The calling task must end right after.
+void placementRespawn(TaskRole role);
@@ -3,16 +3,383 @@
 // ============================================================
 
 #include "usb_hid.h"
+#include "boot_trace.h"
 #include "config.h"
-#include "keyboard_layout.h"
+#include "hid_trace.h"
 
 #include <USB.h>
+#include <USBHID.h>
 #include <USBHIDKeyboard.h>
 #include <USBHIDMouse.h>
+#include <atomic>
+
+// After the Arduino HID headers: KEY_* below are HID usages, not the
+// library's press() codes
+#include "keyboard_layout.h"
+
+// --- Absolute pointer: a third HID device next to keyboard and mouse ---
+#define HID_REPORT_ID_ABS_MOUSE 7 // after the core's own IDs (1..6)
+
+static const uint8_t ABS_MOUSE_DESCRIPTOR[] = {
+    0x05, 0x01,                    // Usage Page (Generic Desktop)
+    0x09, 0x02,                    // Usage (Mouse)
+    0xA1, 0x01,                    // Collection (Application)
+    0x85, HID_REPORT_ID_ABS_MOUSE, //   Report ID
+    0x09, 0x01,                    //   Usage (Pointer)
+    0xA1, 0x00,                    //   Collection (Physical)
+    0x05, 0x09,                    //     Usage Page (Button)
+    0x19, 0x01,                    //     Usage Minimum (1)
+    0x29, 0x03,                    //     Usage Maximum (3)
+    0x15, 0x00,                    //     Logical Minimum (0)
+    0x25, 0x01,                    //     Logical Maximum (1)
+    0x95, 0x03,                    //     Report Count (3)
+    0x75, 0x01,                    //     Report Size (1)
+    0x81, 0x02,                    //     Input (Data, Var, Abs)
+    0x95, 0x01,                    //     Report Count (1)
+    0x75, 0x05,                    //     Report Size (5)
+    0x81, 0x03,                    //     Input (Const) — padding
+    0x05, 0x01,                    //     Usage Page (Generic Desktop)
+    0x09, 0x30,                    //     Usage (X)
+    0x09, 0x31,                    //     Usage (Y)
+    0x16, 0x00, 0x00,              //     Logical Minimum (0)
+    0x26, 0xFF, 0x7F,              //     Logical Maximum (32767)
+    0x75, 0x10,                    //     Report Size (16)
+    0x95, 0x02,                    //     Report Count (2)
+    0x81, 0x02,                    //     Input (Data, Var, Abs)
+    0xC0,                          //   End Collection
+    0xC0,                          // End Collection
+};
+
+class AbsMouse : public USBHIDDevice {
+public:
+  AbsMouse() { _hid.addDevice(this, sizeof(ABS_MOUSE_DESCRIPTOR)); }
+  void begin() { _hid.begin(); }
+  uint16_t _onGetDescriptor(uint8_t *buffer) override {
+    memcpy(buffer, ABS_MOUSE_DESCRIPTOR, sizeof(ABS_MOUSE_DESCRIPTOR));
+    return sizeof(ABS_MOUSE_DESCRIPTOR);
+  }
+  // buttons, x (LE), y (LE)
+  void move(const uint8_t report[5]) {
+    _hid.SendReport(HID_REPORT_ID_ABS_MOUSE, report, 5);
+  }
+
+private:
+  USBHID _hid;
+};
+
+// --- NKRO keyboard: modifiers + one bit per key usage 0..127 ---
+#define HID_REPORT_ID_NKRO 8
+#define NKRO_KEY_BYTES 16
+
+struct NkroReport {
+  uint8_t modifiers;
+  uint8_t keys[NKRO_KEY_BYTES]; // bit k set = usage k down
+};
+
+static const uint8_t NKRO_DESCRIPTOR[] = {
+    0x05, 0x01,               // Usage Page (Generic Desktop)
+    0x09, 0x06,               // Usage (Keyboard)
+    0xA1, 0x01,               // Collection (Application)
+    0x85, HID_REPORT_ID_NKRO, //   Report ID
+    0x05, 0x07,               //   Usage Page (Keyboard/Keypad)
+    0x19, 0xE0,               //   Usage Minimum (Left Control)
+    0x29, 0xE7,               //   Usage Maximum (Right GUI)
+    0x15, 0x00,               //   Logical Minimum (0)
+    0x25, 0x01,               //   Logical Maximum (1)
+    0x75, 0x01,               //   Report Size (1)
+    0x95, 0x08,               //   Report Count (8)
+    0x81, 0x02,               //   Input (Data, Var, Abs) — modifiers
+    0x19, 0x00,               //   Usage Minimum (0)
+    0x29, 0x7F,               //   Usage Maximum (127)
+    0x95, 0x80,               //   Report Count (128)
+    0x81, 0x02,               //   Input (Data, Var, Abs) — key bitmap
+    0xC0,                     // End Collection
+};
+
+// SET_PROTOCOL(boot) from the host (BIOS, boot loaders): only the
+// boot keyboard report is understood, so NKRO stays off until the
+// host selects report protocol again
+static std::atomic<bool> sBootProtocol{false};
+
+class NkroKeyboard : public USBHIDDevice {
+public:
+  NkroKeyboard() { _hid.addDevice(this, sizeof(NKRO_DESCRIPTOR)); }
+  void begin() {
+    _hid.begin();
+    _hid.onEvent(ARDUINO_USB_HID_SET_PROTOCOL_EVENT, onProtocol);
+  }
+  uint16_t _onGetDescriptor(uint8_t *buffer) override {
+    memcpy(buffer, NKRO_DESCRIPTOR, sizeof(NKRO_DESCRIPTOR));
+    return sizeof(NKRO_DESCRIPTOR);
+  }
+  void send(const NkroReport &r) {
+    _hid.SendReport(HID_REPORT_ID_NKRO, &r, sizeof(r));
+  }
+
+private:
+  static void onProtocol(void *arg, esp_event_base_t base, int32_t id,
+                         void *data) {
+    auto *ev = (arduino_usb_hid_event_data_t *)data;
+    sBootProtocol.store(ev->set_protocol.protocol == 0,
+                        std::memory_order_relaxed);
+  }
+
+  USBHID _hid;
+};
 
 // --- Singleton HID instances ---
 static USBHIDKeyboard Kbd;
 static USBHIDMouse Mse;
+static AbsMouse AbsMse;
+static NkroKeyboard NkroKbd;
+
+// Keyboard state is kept here and sent with sendReport(), so every
+// report that leaves the device passes through sendKeyboard()
+static KeyReport sReport = {};
+
+// hidAcquire(): created on first use, in either boot mode
+static SemaphoreHandle_t hidMutex() {
+  static SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+  return mutex;
+}
+
+static std::atomic<uint32_t> sReports{0};
+
+// Lock LEDs, from the boot keyboard's output report
+static std::atomic<uint8_t> sLeds{0};
+static std::atomic<uint32_t> sLedReports{0};
+static std::atomic<HidLedCallback> sLedCallback{nullptr};
+
+static void onLeds(void *arg, esp_event_base_t base, int32_t id,
+                   void *data) {
+  auto *ev = (arduino_usb_hid_keyboard_event_data_t *)data;
+  sLeds.store(ev->leds, std::memory_order_relaxed);
+  sLedReports.fetch_add(1, std::memory_order_relaxed);
+  HidLedCallback cb = sLedCallback.load(std::memory_order_acquire);
+  if (cb)
+    cb(ev->leds);
+}
+static std::atomic<uint32_t> sChars{0};
+static std::atomic<uint64_t> sTypingUs{0};
+
+// Inter-report jitter: |gap(n) - gap(n-1)| within a burst of reports
+static uint32_t sLastReportUs = 0;
+static uint32_t sLastGapUs = 0;
+static std::atomic<uint32_t> sJitterMaxUs{0};
+static std::atomic<uint64_t> sJitterSumUs{0};
+static std::atomic<uint32_t> sJitterCount{0};
+
+static void countReport() {
+  sReports.fetch_add(1, std::memory_order_relaxed);
+
+  uint32_t now = micros();
+  uint32_t gap = now - sLastReportUs;
+  sLastReportUs = now;
+  if (gap > HID_BURST_GAP_US) {
+    sLastGapUs = 0; // idle: the next gap starts a new burst
+    return;
+  }
+  if (sLastGapUs) {
+    uint32_t j = gap > sLastGapUs ? gap - sLastGapUs : sLastGapUs - gap;
+    if (j > sJitterMaxUs.load(std::memory_order_relaxed))
+      sJitterMaxUs.store(j, std::memory_order_relaxed);
+    sJitterSumUs.fetch_add(j, std::memory_order_relaxed);
+    sJitterCount.fetch_add(1, std::memory_order_relaxed);
+  }
+  sLastGapUs = gap ? gap : 1;
+}
+
+static void sendKeyboard() {
+  Kbd.sendReport(&sReport);
+  countReport();
+  hidTraceRecord(HID_TRACE_KEYBOARD, (const uint8_t *)&sReport,
+                 sizeof(sReport));
+}
+
+// Mouse reports are built by the library; mirror them for the counters
+static void traceMouse(uint8_t buttons, int8_t x, int8_t y, int8_t wheel) {
+  uint8_t r[4] = {buttons, (uint8_t)x, (uint8_t)y, (uint8_t)wheel};
+  countReport();
+  hidTraceRecord(HID_TRACE_MOUSE, r, sizeof(r));
+}
+
+// ================================================================
+//  Actions — written once against an output backend: the USB one
+//  below, or HidDryRun (nothing sent, virtual time). A backend has
+//  `report`, sendKeyboard(), nkro(), sendNkro(), sendMouse(),
+//  sendMouseAbs(), clickMouse() and wait().
+// ================================================================
+
+template <class Out> static void keyDown(Out &o, uint8_t keycode) {
+  for (int i = 0; i < 6; i++) {
+    if (o.report.keys[i] == keycode)
+      return;
+  }
+  for (int i = 0; i < 6; i++) {
+    if (o.report.keys[i] == 0) {
+      o.report.keys[i] = keycode;
+      return;
+    }
+  }
+}
+
+template <class Out> static void releaseKeyboard(Out &o) {
+  memset(&o.report, 0, sizeof(o.report));
+  o.sendKeyboard();
+}
+
+// Type text[i..] with one NKRO press/release pair, as many characters
+// as it can carry: same modifiers, distinct keys in ascending usage
+// order (hosts handle the keys of a bitmap report in usage order, so
+// that is the order they appear). Returns where the next batch starts.
+template <class Out>
+static size_t typeNkroBatch(Out &o, const char *text, size_t i, size_t len) {
+  NkroReport r = {};
+  int n = 0;
+  uint8_t last = 0;
+  for (; i < len && n < HID_NKRO_BATCH_MAX; i++) {
+    char c = text[i];
+    if (c == '\n' || c == '\t')
+      break;
+    KeyMapping km = getKeyMapping(c);
+    if (km.keycode == KEY_NONE || km.keycode >= NKRO_KEY_BYTES * 8)
+      continue;
+    if (n && (km.modifier != r.modifiers || km.keycode <= last))
+      break;
+    r.modifiers = km.modifier;
+    r.keys[km.keycode >> 3] |= 1 << (km.keycode & 7);
+    last = km.keycode;
+    n++;
+  }
+  if (n) {
+    o.sendNkro(r);
+    memset(&r, 0, sizeof(r));
+    o.sendNkro(r);
+    o.wait(5);
+  }
+  return i;
+}
+
+template <class Out>
+static void doTypeString(Out &o, const char *text, size_t len) {
+  for (size_t i = 0; i < len;) {
+    char c = text[i];
+
+    if (c == '\n' || c == '\t') {
+      keyDown(o, c == '\n' ? KEY_ENTER : KEY_TAB);
+      o.sendKeyboard();
+      releaseKeyboard(o);
+      o.wait(10);
+      i++;
+      continue;
+    }
+
+    if (o.nkro()) {
+      i = typeNkroBatch(o, text, i, len);
+      continue;
+    }
+
+    // Boot report: key + shift go down in one report, up in the next
+    i++;
+    KeyMapping km = getKeyMapping(c);
+    if (km.keycode == KEY_NONE)
+      continue;
+    o.report.modifiers = km.modifier;
+    keyDown(o, km.keycode);
+    o.sendKeyboard();
+    releaseKeyboard(o);
+    o.wait(5); // small inter-key delay for reliability
+  }
+}
+
+template <class Out>
+static void doPressKey(Out &o, uint8_t keycode, uint8_t modifier) {
+  // One report per modifier (CTRL, SHIFT, ALT, GUI, then right-hand),
+  // then the key, as a person would press them
+  static const uint8_t order[] = {MOD_LEFT_CTRL,  MOD_LEFT_SHIFT,
+                                  MOD_LEFT_ALT,   MOD_LEFT_GUI,
+                                  MOD_RIGHT_CTRL, MOD_RIGHT_SHIFT,
+                                  MOD_RIGHT_ALT,  MOD_RIGHT_GUI};
+  for (uint8_t m : order) {
+    if (modifier & m) {
+      o.report.modifiers |= m;
+      o.sendKeyboard();
+    }
+  }
+
+  if (keycode != KEY_NONE) {
+    keyDown(o, keycode);
+    o.sendKeyboard();
+  }
+
+  o.wait(20);
+  releaseKeyboard(o);
+  o.wait(10);
+}
+
+template <class Out> static void doMouseMove(Out &o, int8_t dx, int8_t dy) {
+  o.sendMouse(dx, dy, 0);
+  o.wait(10);
+}
+
+template <class Out>
+static void doMousePath(Out &o, const int8_t *steps, size_t n,
+                        uint8_t intervalMs) {
+  for (size_t i = 0; i < n; i++) {
+    if (i)
+      o.wait(intervalMs); // one report per poll
+    o.sendMouse(steps[2 * i], steps[2 * i + 1], 0);
+  }
+  o.wait(10);
+}
+
+template <class Out> static void doMouseMoveTo(Out &o, uint16_t x, uint16_t y) {
+  o.sendMouseAbs(x, y);
+  o.wait(10);
+}
+
+template <class Out> static void doMouseClick(Out &o, uint8_t button) {
+  o.clickMouse(button == 1   ? MOUSE_RIGHT
+               : button == 2 ? MOUSE_MIDDLE
+                             : MOUSE_LEFT);
+  o.wait(20);
+}
+
+template <class Out> static void doMouseScroll(Out &o, int8_t amount) {
+  o.sendMouse(0, 0, amount);
+  o.wait(10);
+}
+
+// --- USB backend ---
+struct UsbOut {
+  KeyReport &report;
+  void sendKeyboard() { ::sendKeyboard(); }
+  bool nkro() const { return hidNkroActive(); }
+  void sendNkro(const NkroReport &r) {
+    NkroKbd.send(r);
+    countReport();
+    hidTraceRecord(HID_TRACE_NKRO, (const uint8_t *)&r, sizeof(r));
+  }
+  void sendMouse(int8_t x, int8_t y, int8_t wheel) {
+    Mse.move(x, y, wheel);
+    traceMouse(0, x, y, wheel);
+  }
+  void sendMouseAbs(uint16_t x, uint16_t y) {
+    uint8_t r[5] = {0, (uint8_t)x, (uint8_t)(x >> 8), (uint8_t)y,
+                    (uint8_t)(y >> 8)};
+    AbsMse.move(r);
+    countReport();
+    hidTraceRecord(HID_TRACE_MOUSE_ABS, r, sizeof(r));
+  }
+  void clickMouse(uint8_t b) {
+    Mse.click(b); // press report, then release report
+    traceMouse(b, 0, 0, 0);
+    traceMouse(0, 0, 0, 0);
+  }
+  void wait(uint32_t ms) { delay(ms); }
+};
+
+static UsbOut sUsb = {sReport};
 
 // ----------------------------------------------------------------
 void initUSB() {
@@ -22,74 +389,41 @@ void initUSB() {
   USB.productName(USB_PRODUCT);
 
   Kbd.begin();
+  Kbd.onEvent(ARDUINO_USB_HID_KEYBOARD_LED_EVENT, onLeds);
   Mse.begin();
+  AbsMse.begin();
+  NkroKbd.begin();
   USB.begin();
+  bootTraceMark("usb begin");
 
   // Small delay for host OS to enumerate the device
   delay(500);
+  bootTraceMark("usb settled");
 }
 
 // ----------------------------------------------------------------
 void fixLayout() {
   // ALT + SHIFT toggles keyboard layout on Windows (and many Linux DEs)
-  Kbd.press(KEY_LEFT_ALT);
-  Kbd.press(KEY_LEFT_SHIFT);
+  sReport.modifiers |= MOD_LEFT_ALT;
+  sendKeyboard();
+  sReport.modifiers |= MOD_LEFT_SHIFT;
+  sendKeyboard();
   delay(FIX_LAYOUT_DELAY);
-  Kbd.releaseAll();
+  releaseKeyboard(sUsb);
   delay(50);
 }
 
 // ----------------------------------------------------------------
 void typeString(const String &text) {
-  for (size_t i = 0; i < text.length(); i++) {
-    char c = text.charAt(i);
-
-    if (c == '\n') {
-      Kbd.press(KEY_RETURN);
-      Kbd.releaseAll();
-      delay(10);
-      continue;
-    }
-    if (c == '\t') {
-      Kbd.press(KEY_TAB);
-      Kbd.releaseAll();
-      delay(10);
-      continue;
-    }
-
-    // Use the Arduino HID library's built-in write for simplicity
-    // It handles US layout ASCII natively
-    Kbd.write((uint8_t)c);
-    delay(5); // small inter-key delay for reliability
-  }
+  uint32_t t0 = micros();
+  sChars.fetch_add(text.length(), std::memory_order_relaxed);
+  doTypeString(sUsb, text.c_str(), text.length());
+  sTypingUs.fetch_add(micros() - t0, std::memory_order_relaxed);
 }
 
 // ----------------------------------------------------------------
 void pressKey(uint8_t keycode, uint8_t modifier) {
-  if (modifier & MOD_LEFT_CTRL)
-    Kbd.press(KEY_LEFT_CTRL);
-  if (modifier & MOD_LEFT_SHIFT)
-    Kbd.press(KEY_LEFT_SHIFT);
-  if (modifier & MOD_LEFT_ALT)
-    Kbd.press(KEY_LEFT_ALT);
-  if (modifier & MOD_LEFT_GUI)
-    Kbd.press(KEY_LEFT_GUI);
-  if (modifier & MOD_RIGHT_CTRL)
-    Kbd.press(KEY_RIGHT_CTRL);
-  if (modifier & MOD_RIGHT_SHIFT)
-    Kbd.press(KEY_RIGHT_SHIFT);
-  if (modifier & MOD_RIGHT_ALT)
-    Kbd.press(KEY_RIGHT_ALT);
-  if (modifier & MOD_RIGHT_GUI)
-    Kbd.press(KEY_RIGHT_GUI);
-
-  if (keycode != KEY_NONE) {
-    Kbd.press(keycode);
-  }
-
-  delay(20);
-  Kbd.releaseAll();
-  delay(10);
+  doPressKey(sUsb, keycode, modifier);
 }
 
 // ----------------------------------------------------------------
@@ -99,32 +433,81 @@ void pressCombo(uint8_t keycode, uint8_t mod1, uint8_t mod2, uint8_t mod3) {
 }
 
 // ----------------------------------------------------------------
-void releaseAllKeys() { Kbd.releaseAll(); }
+void releaseAllKeys() { releaseKeyboard(sUsb); }
+
+// ----------------------------------------------------------------
+void mouseMove(int8_t dx, int8_t dy) { doMouseMove(sUsb, dx, dy); }
 
 // ----------------------------------------------------------------
-void mouseMove(int8_t dx, int8_t dy) {
-  Mse.move(dx, dy, 0);
-  delay(10);
+void mousePath(const int8_t *steps, size_t n, uint8_t intervalMs) {
+  doMousePath(sUsb, steps, n, intervalMs);
 }
 
 // ----------------------------------------------------------------
-void mouseClick(uint8_t button) {
-  switch (button) {
-  case 1:
-    Mse.click(MOUSE_RIGHT);
-    break;
-  case 2:
-    Mse.click(MOUSE_MIDDLE);
-    break;
-  default:
-    Mse.click(MOUSE_LEFT);
-    break;
-  }
-  delay(20);
+void mouseMoveTo(uint16_t x, uint16_t y) { doMouseMoveTo(sUsb, x, y); }
+
+// ----------------------------------------------------------------
+void mouseClick(uint8_t button) { doMouseClick(sUsb, button); }
+
+// ----------------------------------------------------------------
+void mouseScroll(int8_t amount) { doMouseScroll(sUsb, amount); }
+
+// ----------------------------------------------------------------
+bool hidAcquire(uint32_t waitMs) {
+  TickType_t ticks =
+      waitMs == HID_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(waitMs);
+  return xSemaphoreTake(hidMutex(), ticks) == pdTRUE;
+}
+
+void hidRelease() { xSemaphoreGive(hidMutex()); }
+
+// ----------------------------------------------------------------
+bool hidNkroActive() {
+  return HID_NKRO && !sBootProtocol.load(std::memory_order_relaxed);
 }
 
+uint8_t hidLeds() { return sLeds.load(std::memory_order_relaxed); }
+
+void hidOnLeds(HidLedCallback cb) {
+  sLedCallback.store(cb, std::memory_order_release);
+}
+
+// ----------------------------------------------------------------
+void HidDryRun::typeString(const char *text, size_t len) {
+  doTypeString(*this, text, len);
+}
+
+void HidDryRun::pressKey(uint8_t keycode, uint8_t modifier) {
+  doPressKey(*this, keycode, modifier);
+}
+
+void HidDryRun::mouseMove(int8_t dx, int8_t dy) { doMouseMove(*this, dx, dy); }
+
+void HidDryRun::mousePath(const int8_t *steps, size_t n, uint8_t intervalMs) {
+  doMousePath(*this, steps, n, intervalMs);
+}
+
+void HidDryRun::mouseMoveTo(uint16_t x, uint16_t y) {
+  doMouseMoveTo(*this, x, y);
+}
+
+void HidDryRun::mouseClick(uint8_t button) { doMouseClick(*this, button); }
+
+void HidDryRun::mouseScroll(int8_t amount) { doMouseScroll(*this, amount); }
+
+void HidDryRun::releaseAllKeys() { releaseKeyboard(*this); }
+
 // ----------------------------------------------------------------
-void mouseScroll(int8_t amount) {
-  Mse.move(0, 0, amount);
-  delay(10);
+HidStats hidGetStats() {
+  HidStats st;
+  st.reports = sReports.load(std::memory_order_relaxed);
+  st.chars = sChars.load(std::memory_order_relaxed);
+  st.typingUs = sTypingUs.load(std::memory_order_relaxed);
+  st.jitterMaxUs = sJitterMaxUs.load(std::memory_order_relaxed);
+  uint32_t n = sJitterCount.load(std::memory_order_relaxed);
+  st.jitterAvgUs = n ? sJitterSumUs.load(std::memory_order_relaxed) / n : 0;
+  st.nkro = hidNkroActive();
+  st.leds = hidLeds();
+  st.ledReports = sLedReports.load(std::memory_order_relaxed);
+  return st;
 }
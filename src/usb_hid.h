@@ -12,7 +12,9 @@ void initUSB();
 /// Send ALT+SHIFT to switch host keyboard layout to English.
 void fixLayout();
 
-/// Type a string as keyboard input (character by character).
+/// Type a string as keyboard input. With NKRO active, runs of
+/// distinct ascending keys share one report; otherwise one boot
+/// report per character.
 void typeString(const String &text);
 
 /// Press a single HID key with optional modifiers, then release.
@@ -30,8 +32,94 @@ void releaseAllKeys();
 /// Move the mouse cursor by (dx, dy) pixels.
 void mouseMove(int8_t dx, int8_t dy);
 
+/// Move a precomputed relative path: `n` reports of (dx, dy) pairs
+/// in `steps`, `intervalMs` apart (the HID poll interval or a
+/// multiple of it), then the same settle time as mouseMove().
+void mousePath(const int8_t *steps, size_t n, uint8_t intervalMs);
+
+/// Put the pointer at an absolute position through the absolute
+/// pointer interface. x, y: 0..MOUSE_ABS_MAX across the screen.
+void mouseMoveTo(uint16_t x, uint16_t y);
+
 /// Click a mouse button.  0 = left, 1 = right, 2 = middle.
 void mouseClick(uint8_t button = 0);
 
 /// Scroll the mouse wheel. Positive = up, negative = down.
 void mouseScroll(int8_t amount);
+
+/// Exclusive use of the HID output. Only the holder sends reports, so
+/// two tasks never interleave them or share the keyboard state: a
+/// script holds it for its whole run, live events and contention
+/// reports one at a time. False if it isn't free within `waitMs`
+/// (HID_WAIT_FOREVER: block). Release it from the task that took it.
+#define HID_WAIT_FOREVER UINT32_MAX
+bool hidAcquire(uint32_t waitMs);
+void hidRelease();
+
+/// Lock LEDs in the host's keyboard output report (HID LED usage
+/// order), the way a cooperating host signals WAIT_FOR_* commands.
+#define HID_LED_NUM_LOCK 0x01
+#define HID_LED_CAPS_LOCK 0x02
+#define HID_LED_SCROLL_LOCK 0x04
+
+/// HID_LED_* bits of the last LED report from the host (0 before
+/// the first).
+uint8_t hidLeds();
+
+/// Called on the USB stack's task after every LED report from the
+/// host (one callback; set during setup).
+typedef void (*HidLedCallback)(uint8_t leds);
+void hidOnLeds(HidLedCallback cb);
+
+/// True while text goes out through the NKRO interface: HID_NKRO on
+/// and the host hasn't selected boot protocol.
+bool hidNkroActive();
+
+/// Null HID backend for dry runs: the actions above with the same
+/// reports and pacing, but nothing is sent, no counter or trace sees
+/// them and time is virtual (`us` advances instead of sleeping).
+class HidDryRun {
+public:
+  void typeString(const char *text, size_t len);
+  void pressKey(uint8_t keycode, uint8_t modifier = 0);
+  void mouseMove(int8_t dx, int8_t dy);
+  void mousePath(const int8_t *steps, size_t n, uint8_t intervalMs);
+  void mouseMoveTo(uint16_t x, uint16_t y);
+  void mouseClick(uint8_t button = 0);
+  void mouseScroll(int8_t amount);
+  void releaseAllKeys();
+  void wait(uint32_t ms) { us += ms * 1000ULL; }
+  // The host is taken to be ready at once: the estimate is the
+  // fastest run, and timeouts are the most a WAIT_FOR can add
+  bool waitFor(uint8_t, uint8_t, uint32_t) { return true; }
+
+  uint32_t reports = 0; // reports that would have been sent
+  uint64_t us = 0;      // virtual time elapsed
+  bool nkroMode = hidNkroActive(); // type as the device would now
+
+  // Backend interface for the shared action code (usb_hid.cpp)
+  struct {
+    uint8_t modifiers, reserved, keys[6];
+  } report = {};
+  void sendKeyboard() { reports++; }
+  bool nkro() const { return nkroMode; }
+  template <class R> void sendNkro(const R &) { reports++; }
+  void sendMouse(int8_t, int8_t, int8_t) { reports++; }
+  void sendMouseAbs(uint16_t, uint16_t) { reports++; }
+  void clickMouse(uint8_t) { reports += 2; }
+};
+
+/// Counters since boot.
+struct HidStats {
+  uint32_t reports;     // keyboard + mouse reports sent
+  uint32_t chars;       // characters passed to typeString()
+  uint64_t typingUs;    // time spent inside typeString()
+  uint32_t jitterMaxUs; // max change between consecutive report gaps
+  uint32_t jitterAvgUs; //   (gaps over HID_BURST_GAP_US are ignored)
+  bool nkro;            // hidNkroActive()
+  uint8_t leds;         // hidLeds()
+  uint32_t ledReports;  // LED output reports from the host
+};
+
+/// Snapshot of the HID counters.
+HidStats hidGetStats();
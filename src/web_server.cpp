@@ -3,23 +3,93 @@
 // ============================================================
 
 #include "web_server.h"
+#include "arena.h"
+#include "boot_trace.h"
 #include "config.h"
+#include "contention.h"
+#include "ducky_compiler.h"
 #include "ducky_parser.h"
+#include "heap_monitor.h"
+#include "hid_trace.h"
+#include "live_channel.h"
+#include "logger.h"
+#include "metrics.h"
+#include "payload_archive.h"
+#include "payload_cache.h"
+#include "profiler.h"
+#include "status_events.h"
 #include "storage_manager.h"
+#include "task_placement.h"
 #include "wifi_manager.h"
 
 
 #include <ArduinoJson.h>
 #include <ESPAsyncWebServer.h>
 #include <LittleFS.h>
+#include <memory>
 
 
 static AsyncWebServer server(WEB_SERVER_PORT);
 
+// Latest script status event, for GET /api/status
+static StatusEvent sLastStatus = {};
+static portMUX_TYPE sStatusMux = portMUX_INITIALIZER_UNLOCKED;
+
 // ================================================================
 //  Helpers
 // ================================================================
 
+// Route wrappers feeding the per-route latency histograms (metrics.h).
+// Each handler call runs in the request arena (arena.h).
+static ArRequestHandlerFunction timed(const char *route,
+                                      ArRequestHandlerFunction fn) {
+  return [route, fn](AsyncWebServerRequest *req) {
+    uint32_t t0 = micros();
+    {
+      ArenaScope scratch(ARENA_HTTP);
+      fn(req);
+    }
+    metricsObserveHttp(route, micros() - t0);
+  };
+}
+
+// Body handlers: time summed over all chunks, recorded with the last
+static ArBodyHandlerFunction timedBody(const char *route,
+                                       ArBodyHandlerFunction fn) {
+  auto spent = std::make_shared<uint32_t>(0);
+  return [route, fn, spent](AsyncWebServerRequest *req, uint8_t *data,
+                            size_t len, size_t index, size_t total) {
+    if (index == 0)
+      *spent = 0;
+    uint32_t t0 = micros();
+    {
+      ArenaScope scratch(ARENA_HTTP);
+      fn(req, data, len, index, total);
+    }
+    *spent += micros() - t0;
+    if (index + len >= total)
+      metricsObserveHttp(route, *spent);
+  };
+}
+
+// JsonDocument memory from the request arena; every document lives
+// within one handler call
+struct ArenaJsonAllocator : ArduinoJson::Allocator {
+  void *allocate(size_t size) override { return arenaAlloc(size); }
+  void deallocate(void *ptr) override { arenaFree(ptr); }
+  void *reallocate(void *ptr, size_t size) override {
+    return arenaRealloc(ptr, size);
+  }
+};
+static ArenaJsonAllocator sJsonAlloc;
+
+// Status subscriber (runs on the status task)
+static void recordStatus(const StatusEvent &ev) {
+  portENTER_CRITICAL(&sStatusMux);
+  sLastStatus = ev;
+  portEXIT_CRITICAL(&sStatusMux);
+}
+
 static void sendJson(AsyncWebServerRequest *req, int code,
                      const JsonDocument &doc) {
   String body;
@@ -27,6 +97,33 @@ static void sendJson(AsyncWebServerRequest *req, int code,
   req->send(code, "application/json", body);
 }
 
+static String etagFor(uint32_t hash) {
+  char buf[12];
+  snprintf(buf, sizeof(buf), "\"%08x\"", (unsigned)hash);
+  return String(buf);
+}
+
+// ESPAsyncWebServer drops request headers no handler asked for while
+// the head is parsed. Registered before every route, this handler
+// claims no request; it only keeps the conditional headers.
+class ConditionalHeaders : public AsyncWebHandler {
+public:
+  bool canHandle(AsyncWebServerRequest *req) override {
+    req->addInterestingHeader("If-None-Match");
+    req->addInterestingHeader("If-Match");
+    return false;
+  }
+};
+
+// True if the request's `header` (If-None-Match / If-Match) names `etag`.
+static bool etagMatches(AsyncWebServerRequest *req, const char *header,
+                        const String &etag) {
+  if (!req->hasHeader(header))
+    return false;
+  String value = req->getHeader(header)->value();
+  return value == "*" || value.indexOf(etag) >= 0;
+}
+
 // ================================================================
 //  Route Handlers
 // ================================================================
@@ -34,7 +131,7 @@ static void sendJson(AsyncWebServerRequest *req, int code,
 // GET /api/payloads — list all payloads
 static void handleListPayloads(AsyncWebServerRequest *req) {
   auto payloads = listPayloads();
-  JsonDocument doc;
+  JsonDocument doc(&sJsonAlloc);
   JsonArray arr = doc["payloads"].to<JsonArray>();
   for (auto &name : payloads) {
     arr.add(name);
@@ -42,19 +139,40 @@ static void handleListPayloads(AsyncWebServerRequest *req) {
   sendJson(req, 200, doc);
 }
 
-// GET /api/payloads/<name> — get payload content
+// GET /api/payloads/<name> — get payload content (ETag / If-None-Match)
 static void handleGetPayload(AsyncWebServerRequest *req) {
   String name = req->pathArg(0);
-  String content = readPayload(name);
-  if (content.isEmpty() && !LittleFS.exists(String(PAYLOAD_DIR) + "/" + name)) {
+  if (!LittleFS.exists(String(PAYLOAD_DIR) + "/" + name)) {
     req->send(404, "application/json", "{\"error\":\"Not found\"}");
     return;
   }
-  JsonDocument doc;
+
+  String etag = etagFor(payloadHash(name));
+  if (etagMatches(req, "If-None-Match", etag)) {
+    AsyncWebServerResponse *res = req->beginResponse(304);
+    res->addHeader("ETag", etag);
+    req->send(res);
+    return;
+  }
+
+  String content = readPayload(name);
+  JsonDocument doc(&sJsonAlloc);
   doc["name"] = name;
-  doc["content"] = content;
+  // Bytecode images (POST .../compiled) aren't text: report, don't send
+  if (duckyIsBytecode((const uint8_t *)content.c_str(), content.length()))
+    doc["compiled"] = true;
+  else
+    doc["content"] = content;
   doc["size"] = content.length();
-  sendJson(req, 200, doc);
+  doc["etag"] = etag;
+
+  String body;
+  serializeJson(doc, body);
+  AsyncWebServerResponse *res =
+      req->beginResponse(200, "application/json", body);
+  res->addHeader("ETag", etag);
+  res->addHeader("Cache-Control", "no-cache");
+  req->send(res);
 }
 
 // POST /api/payloads — save payload  { "name": "...", "content": "..." }
@@ -67,23 +185,125 @@ static void handleSavePayload(AsyncWebServerRequest *req, uint8_t *data,
   body += String((char *)data).substring(0, len);
 
   if (index + len >= total) {
-    JsonDocument doc;
+    JsonDocument doc(&sJsonAlloc);
     deserializeJson(doc, body);
     String name = doc["name"] | "";
     String content = doc["content"] | "";
+    bool compress = doc["compress"] | true;
 
     if (name.isEmpty()) {
       req->send(400, "application/json", "{\"error\":\"Name required\"}");
       return;
     }
-    if (savePayload(name, content)) {
-      req->send(200, "application/json", "{\"status\":\"saved\"}");
+    if (savePayload(name, content, compress)) {
+      JsonDocument res(&sJsonAlloc);
+      res["status"] = "saved";
+      res["etag"] = etagFor(payloadHash(name));
+      sendJson(req, 200, res);
     } else {
       req->send(500, "application/json", "{\"error\":\"Save failed\"}");
     }
   }
 }
 
+// POST /api/payloads/<name>/compiled — store a bytecode image from
+// ducky_compile as-is (raw body). It is verified here and again before
+// it runs; the device never parses the source.
+static void handleSaveCompiled(AsyncWebServerRequest *req, uint8_t *data,
+                               size_t len, size_t index, size_t total) {
+  static String body;
+  if (index == 0) {
+    body = "";
+    if (total <= MAX_PAYLOAD_SIZE)
+      body.reserve(total);
+  }
+  if (total > MAX_PAYLOAD_SIZE) {
+    if (index + len >= total)
+      req->send(413, "application/json", "{\"error\":\"Too large\"}");
+    return;
+  }
+  body.concat((const char *)data, len); // binary: may contain NULs
+
+  if (index + len >= total) {
+    String name = req->pathArg(0);
+    DuckyCompileResult check;
+    if (!duckyVerify((const uint8_t *)body.c_str(), body.length(), check)) {
+      JsonDocument err(&sJsonAlloc);
+      err["error"] = check.error;
+      err["line"] = check.errorLine;
+      sendJson(req, 400, err);
+      body = "";
+      return;
+    }
+    bool saved = savePayload(name, body, true);
+    body = "";
+    if (!saved) {
+      req->send(500, "application/json", "{\"error\":\"Save failed\"}");
+      return;
+    }
+    JsonDocument res(&sJsonAlloc);
+    res["status"] = "saved";
+    res["lines"] = check.lines;
+    res["commands"] = check.commands;
+    res["etag"] = etagFor(payloadHash(name));
+    sendJson(req, 200, res);
+  }
+}
+
+// PATCH /api/payloads/<name> — byte-range edits
+//   { "edits": [ { "offset": N, "remove": M, "text": "..." }, ... ] }
+// Edits apply in order; each offset refers to the result of the previous.
+// All of them are written at once or none (422 if any is out of range).
+// An If-Match header guards against patching a stale base.
+static void handlePatchPayload(AsyncWebServerRequest *req, uint8_t *data,
+                               size_t len, size_t index, size_t total) {
+  static String body;
+  if (index == 0)
+    body = "";
+  body += String((char *)data).substring(0, len);
+
+  if (index + len >= total) {
+    String name = req->pathArg(0);
+    if (!LittleFS.exists(String(PAYLOAD_DIR) + "/" + name)) {
+      req->send(404, "application/json", "{\"error\":\"Not found\"}");
+      return;
+    }
+    if (req->hasHeader("If-Match") &&
+        !etagMatches(req, "If-Match", etagFor(payloadHash(name)))) {
+      req->send(412, "application/json", "{\"error\":\"ETag mismatch\"}");
+      return;
+    }
+
+    JsonDocument doc(&sJsonAlloc);
+    deserializeJson(doc, body);
+    JsonArray edits = doc["edits"];
+    if (edits.isNull()) {
+      req->send(400, "application/json", "{\"error\":\"Edits required\"}");
+      return;
+    }
+    std::vector<PayloadEdit> list;
+    list.reserve(edits.size());
+    for (JsonVariant edit : edits) {
+      list.push_back({edit["offset"] | (size_t)0, edit["remove"] | (size_t)0,
+                      edit["text"] | ""});
+    }
+    if (!patchPayload(name, list)) {
+      req->send(422, "application/json", "{\"error\":\"Edit out of range\"}");
+      return;
+    }
+
+    String etag = etagFor(payloadHash(name));
+    JsonDocument res(&sJsonAlloc);
+    res["status"] = "patched";
+    res["etag"] = etag;
+    String out;
+    serializeJson(res, out);
+    AsyncWebServerResponse *r = req->beginResponse(200, "application/json", out);
+    r->addHeader("ETag", etag);
+    req->send(r);
+  }
+}
+
 // DELETE /api/payloads/<name>
 static void handleDeletePayload(AsyncWebServerRequest *req) {
   String name = req->pathArg(0);
@@ -94,6 +314,42 @@ static void handleDeletePayload(AsyncWebServerRequest *req) {
   }
 }
 
+// GET /api/archive — stream the whole payload library (payload_archive.h)
+static void handleExportArchive(AsyncWebServerRequest *req) {
+  auto writer = std::make_shared<ArchiveWriter>();
+  AsyncWebServerResponse *res = req->beginChunkedResponse(
+      "application/octet-stream",
+      [writer](uint8_t *buf, size_t maxLen, size_t index) -> size_t {
+        return writer->read(buf, maxLen);
+      });
+  res->addHeader("Content-Disposition",
+                 "attachment; filename=\"payloads.dka\"");
+  req->send(res);
+}
+
+// POST /api/archive — import an archive, skipping unchanged entries
+static void handleImportArchive(AsyncWebServerRequest *req, uint8_t *data,
+                                size_t len, size_t index, size_t total) {
+  static ArchiveReader reader;
+  if (index == 0)
+    reader.reset();
+  bool ok = reader.feed(data, len);
+
+  if (index + len >= total) {
+    if (!ok || !reader.done()) {
+      reader.reset();
+      req->send(400, "application/json", "{\"error\":\"Bad archive\"}");
+      return;
+    }
+    JsonDocument doc(&sJsonAlloc);
+    doc["status"] = "imported";
+    doc["written"] = reader.written;
+    doc["skipped"] = reader.skipped;
+    doc["failed"] = reader.failed;
+    sendJson(req, 200, doc);
+  }
+}
+
 // POST /api/execute/<name> — execute a stored payload
 static void handleExecutePayload(AsyncWebServerRequest *req) {
   String name = req->pathArg(0);
@@ -123,7 +379,7 @@ static void handleLiveExecute(AsyncWebServerRequest *req, uint8_t *data,
   body += String((char *)data).substring(0, len);
 
   if (index + len >= total) {
-    JsonDocument doc;
+    JsonDocument doc(&sJsonAlloc);
     deserializeJson(doc, body);
     String script = doc["script"] | "";
 
@@ -143,6 +399,70 @@ static void handleLiveExecute(AsyncWebServerRequest *req, uint8_t *data,
   }
 }
 
+// POST /api/analyze — dry run: { "script": "..." } or { "name": "..." }
+// Estimated duration, HID reports and a per-command breakdown, from a
+// null HID backend in virtual time; nothing reaches USB.
+static void handleAnalyze(AsyncWebServerRequest *req, uint8_t *data,
+                          size_t len, size_t index, size_t total) {
+  static String body;
+  if (index == 0)
+    body = "";
+  body += String((char *)data).substring(0, len);
+
+  if (index + len >= total) {
+    JsonDocument doc(&sJsonAlloc);
+    deserializeJson(doc, body);
+    body = "";
+    String name = doc["name"] | "";
+    String script;
+    if (!name.isEmpty()) {
+      if (payloadSize(name) < 0) {
+        req->send(404, "application/json", "{\"error\":\"Not found\"}");
+        return;
+      }
+      script = readPayload(name);
+    } else {
+      script = doc["script"] | "";
+    }
+    if (script.isEmpty()) {
+      req->send(400, "application/json", "{\"error\":\"Script required\"}");
+      return;
+    }
+
+    DuckyAnalysis a;
+    bool ok = duckyAnalyze(script, a);
+    JsonDocument res(&sJsonAlloc);
+    res["ok"] = ok;
+    res["lines"] = a.compile.lines;
+    if (!ok) {
+      // Parse errors are a result, not a failed request
+      res["error"] = a.compile.error;
+      res["line"] = a.compile.errorLine;
+      sendJson(req, 200, res);
+      return;
+    }
+    res["commands"] = a.compile.commands;
+    res["durationMs"] = a.totalUs / 1000.0;
+    if (a.waitMaxUs)
+      res["hostWaitMaxMs"] = a.waitMaxUs / 1000.0;
+    res["reports"] = a.reports;
+    res["unknown"] = a.compile.unknown;
+    res["unknownLine"] = a.compile.unknownLine;
+    JsonArray by = res["byCommand"].to<JsonArray>();
+    for (int op = 0; op < DOP_COUNT; op++) {
+      const DuckyOpCost &c = a.byOp[op];
+      if (!c.count)
+        continue;
+      JsonObject o = by.add<JsonObject>();
+      o["command"] = duckyOpName(op);
+      o["count"] = c.count;
+      o["ms"] = c.us / 1000.0;
+      o["reports"] = c.reports;
+    }
+    sendJson(req, 200, res);
+  }
+}
+
 // POST /api/stop — abort running script
 static void handleStop(AsyncWebServerRequest *req) {
   if (!duckyIsRunning()) {
@@ -155,8 +475,20 @@ static void handleStop(AsyncWebServerRequest *req) {
 
 // GET /api/status — device info
 static void handleStatus(AsyncWebServerRequest *req) {
-  JsonDocument doc;
+  JsonDocument doc(&sJsonAlloc);
   doc["running"] = duckyIsRunning();
+  doc["status"] = duckyStatusName(duckyGetStatus());
+  if (duckyLastError()[0])
+    doc["lastError"] = duckyLastError();
+  portENTER_CRITICAL(&sStatusMux);
+  StatusEvent last = sLastStatus;
+  portEXIT_CRITICAL(&sStatusMux);
+  if (last.run) {
+    // Coalesced: at most STATUS_COALESCE_MS behind the parser
+    doc["progress"]["run"] = last.run;
+    doc["progress"]["line"] = last.line;
+    doc["progress"]["total"] = last.total;
+  }
   doc["ssid"] = wifiGetSSID();
   doc["ip"] = wifiGetIP();
 
@@ -166,11 +498,310 @@ static void handleStatus(AsyncWebServerRequest *req) {
   doc["storage"]["used"] = used;
   doc["storage"]["free"] = total - used;
 
+  size_t raw, stored;
+  getCompressionStats(raw, stored);
+  doc["storage"]["payloadBytes"] = raw;
+  doc["storage"]["payloadStored"] = stored;
+  doc["storage"]["ratio"] = stored ? (float)raw / stored : 1.0f;
+
+  PayloadCacheStats pc = payloadCacheGetStats();
+  doc["storage"]["cache"]["hits"] = pc.hits;
+  doc["storage"]["cache"]["misses"] = pc.misses;
+  doc["storage"]["cache"]["compiledHits"] = pc.imageHits;
+  doc["storage"]["cache"]["bytes"] = pc.bytes;
+  doc["storage"]["cache"]["capacity"] = pc.capacity;
+
   doc["autorun"] = getAutoRunPayload();
 
   sendJson(req, 200, doc);
 }
 
+// GET /api/live — live channel latency (WebSocket receipt → HID report)
+static void handleLiveStats(AsyncWebServerRequest *req) {
+  LiveStats st = liveGetStats();
+  JsonDocument doc(&sJsonAlloc);
+  doc["clients"] = st.clients;
+  doc["events"] = st.events;
+  doc["rejected"] = st.rejected;
+  doc["latencyUs"]["avg"] = st.avgUs;
+  doc["latencyUs"]["max"] = st.maxUs;
+  doc["latencyUs"]["last"] = st.lastUs;
+  sendJson(req, 200, doc);
+}
+
+// GET /api/trace — captured HID trace (binary, see hid_trace.h)
+static void handleGetTrace(AsyncWebServerRequest *req) {
+  if (hidTraceSize() == 0) {
+    req->send(404, "application/json", "{\"error\":\"No trace captured\"}");
+    return;
+  }
+  AsyncWebServerResponse *res = req->beginResponse(
+      200, "application/octet-stream", hidTraceData(), hidTraceSize());
+  res->addHeader("Content-Disposition", "attachment; filename=\"trace.dht\"");
+  res->addHeader("X-Trace-Truncated", hidTraceTruncated() ? "1" : "0");
+  req->send(res);
+}
+
+// POST /api/trace — {"capture": true} starts a fresh capture, false stops
+static void handleTraceControl(AsyncWebServerRequest *req, uint8_t *data,
+                               size_t len, size_t index, size_t total) {
+  static String body;
+  if (index == 0)
+    body = "";
+  body += String((char *)data).substring(0, len);
+
+  if (index + len >= total) {
+    JsonDocument doc(&sJsonAlloc);
+    if (deserializeJson(doc, body) || !doc["capture"].is<bool>()) {
+      req->send(400, "application/json",
+                "{\"error\":\"Expected a boolean 'capture'\"}");
+      return;
+    }
+    if (doc["capture"].as<bool>()) {
+      if (!hidTraceStart()) {
+        req->send(500, "application/json",
+                  "{\"error\":\"Cannot allocate trace buffer\"}");
+        return;
+      }
+    } else {
+      hidTraceStop();
+    }
+    JsonDocument res(&sJsonAlloc);
+    res["capturing"] = hidTraceActive();
+    res["bytes"] = hidTraceSize();
+    res["truncated"] = hidTraceTruncated();
+    sendJson(req, 200, res);
+  }
+}
+
+// GET /api/profile — profiler state
+static void handleProfileStatus(AsyncWebServerRequest *req) {
+  JsonDocument doc(&sJsonAlloc);
+  doc["enabled"] = profilerEnabled();
+  doc["run"] = profilerLastRun();
+  doc["events"] = profilerEventCount();
+  doc["truncated"] = profilerTruncated();
+  sendJson(req, 200, doc);
+}
+
+// POST /api/profile — {"enabled": bool}; applies from the next run
+static void handleProfileControl(AsyncWebServerRequest *req, uint8_t *data,
+                                 size_t len, size_t index, size_t total) {
+  static String body;
+  if (index == 0)
+    body = "";
+  body += String((char *)data).substring(0, len);
+
+  if (index + len >= total) {
+    JsonDocument doc(&sJsonAlloc);
+    if (deserializeJson(doc, body) || !doc["enabled"].is<bool>()) {
+      req->send(400, "application/json",
+                "{\"error\":\"Expected a boolean 'enabled'\"}");
+      return;
+    }
+    if (!profilerEnable(doc["enabled"].as<bool>())) {
+      req->send(500, "application/json",
+                "{\"error\":\"Cannot allocate profile buffer\"}");
+      return;
+    }
+    handleProfileStatus(req);
+  }
+}
+
+// GET /api/profile/<run|latest> — Chrome trace_event JSON of a run
+static void handleGetProfile(AsyncWebServerRequest *req) {
+  String run = req->pathArg(0);
+  uint32_t last = profilerLastRun();
+  if (last == 0 || (run != "latest" && (uint32_t)run.toInt() != last)) {
+    req->send(404, "application/json",
+              "{\"error\":\"Run not available (only the latest is kept)\"}");
+    return;
+  }
+  auto writer = std::make_shared<ProfileJsonWriter>();
+  AsyncWebServerResponse *res = req->beginChunkedResponse(
+      "application/json",
+      [writer](uint8_t *buf, size_t maxLen, size_t index) -> size_t {
+        return writer->read(buf, maxLen);
+      });
+  res->addHeader("Content-Disposition", "attachment; filename=\"run-" +
+                                            String(last) + ".json\"");
+  req->send(res);
+}
+
+// GET /api/boot-trace — boot timeline recorded by bootTraceMark()
+static void handleBootTrace(AsyncWebServerRequest *req) {
+  JsonDocument doc(&sJsonAlloc);
+  JsonArray events = doc["events"].to<JsonArray>();
+  BootEvent ev;
+  uint32_t prev = 0;
+  for (size_t i = 0; bootTraceGet(i, ev); i++) {
+    JsonObject o = events.add<JsonObject>();
+    o["label"] = ev.label;
+    o["us"] = ev.us;
+    o["deltaUs"] = ev.us - prev;
+    o["freeHeap"] = ev.freeHeap;
+    prev = ev.us;
+  }
+  doc["dropped"] = bootTraceDropped();
+  sendJson(req, 200, doc);
+}
+
+// GET /api/heap — heap fragmentation history and arena use
+static void handleHeap(AsyncWebServerRequest *req) {
+  JsonDocument doc(&sJsonAlloc);
+  HeapSample now = heapSampleNow();
+  doc["free"] = now.freeBytes;
+  doc["largest"] = now.largest;
+  doc["fragmentation"] = heapFragmentation(now);
+  doc["minLargest"] = heapMinLargest();
+  doc["sampleMs"] = HEAP_SAMPLE_MS;
+  // [uptime s, free, largest] per sample, oldest first
+  JsonArray history = doc["history"].to<JsonArray>();
+  HeapSample s;
+  for (size_t i = 0; heapHistoryGet(i, s); i++) {
+    JsonArray row = history.add<JsonArray>();
+    row.add(s.uptimeS);
+    row.add(s.freeBytes);
+    row.add(s.largest);
+  }
+  for (int i = 0; i < ARENA_COUNT; i++) {
+    ArenaStats a = arenaGetStats((ArenaId)i);
+    JsonObject o = doc["arenas"][arenaName((ArenaId)i)].to<JsonObject>();
+    o["capacity"] = a.capacity;
+    o["peak"] = a.peak;
+    o["lastUsed"] = a.lastUsed;
+    o["jobs"] = a.jobs;
+    o["overflows"] = a.overflows;
+  }
+  sendJson(req, 200, doc);
+}
+
+// GET /api/log — current log file; ?rotated=1 for the previous one
+static void handleGetLog(AsyncWebServerRequest *req) {
+  const char *path = req->hasParam("rotated") ? LOG_FILE_OLD : LOG_FILE;
+  if (!LittleFS.exists(path)) {
+    req->send(404, "application/json", "{\"error\":\"No log file\"}");
+    return;
+  }
+  req->send(LittleFS, path, "text/plain");
+}
+
+// GET /api/metrics — Prometheus text format
+static void handleMetrics(AsyncWebServerRequest *req) {
+  req->send(200, "text/plain; version=0.0.4", metricsRender());
+}
+
+// GET /api/tasks — core and priority of each task role
+static void handleGetTasks(AsyncWebServerRequest *req) {
+  JsonDocument doc(&sJsonAlloc);
+  for (int i = 0; i < TASK_ROLE_COUNT; i++) {
+    TaskRole role = (TaskRole)i;
+    TaskPlacement p = placementGet(role);
+    JsonObject o = doc[placementRoleName(role)].to<JsonObject>();
+    o["core"] = p.core;
+    o["prio"] = p.prio;
+    o["runningCore"] = placementRunningCore(role);
+  }
+  doc["wifiCore"] = 0; // Wi-Fi driver and lwIP (Arduino-ESP32 build)
+  doc["loopCore"] = ARDUINO_RUNNING_CORE;
+  sendJson(req, 200, doc);
+}
+
+// POST /api/tasks — {"parser":{"core":1,"prio":2}, ...}; omitted
+// roles and fields keep their placement
+static void handleSetTasks(AsyncWebServerRequest *req, uint8_t *data,
+                           size_t len, size_t index, size_t total) {
+  static String body;
+  if (index == 0)
+    body = "";
+  body += String((char *)data).substring(0, len);
+
+  if (index + len >= total) {
+    JsonDocument doc(&sJsonAlloc);
+    DeserializationError err = deserializeJson(doc, body);
+    body = "";
+    if (err || !doc.is<JsonObject>()) {
+      req->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+      return;
+    }
+    for (JsonPair kv : doc.as<JsonObject>()) {
+      TaskRole role;
+      if (!placementRoleFromName(kv.key().c_str(), role)) {
+        req->send(400, "application/json",
+                  "{\"error\":\"Unknown task role\"}");
+        return;
+      }
+      TaskPlacement p = placementGet(role);
+      int core = kv.value()["core"] | (int)p.core;
+      int prio = kv.value()["prio"] | (int)p.prio;
+      // Clamp to values placementSet() still rejects, not wrap into range
+      p.core = constrain(core, -2, 2);
+      p.prio = constrain(prio, 0, 255);
+      if (const char *why = placementSet(role, p)) {
+        JsonDocument res(&sJsonAlloc);
+        res["error"] = why;
+        res["role"] = placementRoleName(role);
+        sendJson(req, 400, res);
+        return;
+      }
+    }
+    handleGetTasks(req);
+  }
+}
+
+// GET /api/contention — last contention test result
+static void handleGetContention(AsyncWebServerRequest *req) {
+  ContentionResult r = contentionGetResult();
+  JsonDocument doc(&sJsonAlloc);
+  doc["running"] = r.running;
+  doc["runs"] = r.runs;
+  if (r.runs || r.running) {
+    doc["interrupted"] = r.interrupted;
+    doc["reports"] = r.reports;
+    doc["intervalUs"] = r.intervalUs;
+    doc["durationMs"] = r.durationMs;
+    doc["jitterUs"]["avg"] = r.jitterAvgUs;
+    doc["jitterUs"]["p50"] = r.jitterP50Us;
+    doc["jitterUs"]["p99"] = r.jitterP99Us;
+    doc["jitterUs"]["max"] = r.jitterMaxUs;
+    doc["httpRequests"] = r.httpRequests;
+    doc["core"] = r.core;
+    doc["prio"] = r.prio;
+  }
+  sendJson(req, 200, doc);
+}
+
+// POST /api/contention — {"reports":2000,"intervalMs":5}; starts a
+// run and returns at once (poll GET for the result)
+static void handleStartContention(AsyncWebServerRequest *req, uint8_t *data,
+                                  size_t len, size_t index, size_t total) {
+  static String body;
+  if (index == 0)
+    body = "";
+  body += String((char *)data).substring(0, len);
+
+  if (index + len >= total) {
+    JsonDocument doc(&sJsonAlloc);
+    deserializeJson(doc, body);
+    body = "";
+    uint32_t reports = doc["reports"] | 1000;
+    uint32_t intervalMs = doc["intervalMs"] | CONTENTION_INTERVAL_MS;
+    if (reports < 2 || reports > CONTENTION_MAX_REPORTS || intervalMs < 1 ||
+        intervalMs > 1000) {
+      req->send(400, "application/json",
+                "{\"error\":\"reports or intervalMs out of range\"}");
+      return;
+    }
+    if (const char *why = contentionStart(reports, intervalMs)) {
+      JsonDocument res(&sJsonAlloc);
+      res["error"] = why;
+      sendJson(req, 409, res);
+      return;
+    }
+    req->send(202, "application/json", "{\"status\":\"started\"}");
+  }
+}
+
 // POST /api/settings — update settings
 static void handleSettings(AsyncWebServerRequest *req, uint8_t *data,
                            size_t len, size_t index, size_t total) {
@@ -180,7 +811,7 @@ static void handleSettings(AsyncWebServerRequest *req, uint8_t *data,
   body += String((char *)data).substring(0, len);
 
   if (index + len >= total) {
-    JsonDocument doc;
+    JsonDocument doc(&sJsonAlloc);
     deserializeJson(doc, body);
 
     if (doc.containsKey("autorun")) {
@@ -196,44 +827,128 @@ static void handleSettings(AsyncWebServerRequest *req, uint8_t *data,
 // ================================================================
 
 void webServerInit() {
+  arenaInit();
+  statusSubscribe(recordStatus);
+
   // --- REST API routes ---
-  server.on("/api/payloads", HTTP_GET, handleListPayloads);
+  server.addHandler(new ConditionalHeaders());
+
+  server.on("/api/payloads", HTTP_GET,
+            timed("GET /api/payloads", handleListPayloads));
 
-  server.on("^\\/api\\/payloads\\/(.+)$", HTTP_GET, handleGetPayload);
+  server.on("^\\/api\\/payloads\\/(.+)$", HTTP_GET,
+            timed("GET /api/payloads/:name", handleGetPayload));
 
   server.on(
       "/api/payloads", HTTP_POST, [](AsyncWebServerRequest *req) {}, nullptr,
-      handleSavePayload);
+      timedBody("POST /api/payloads", handleSavePayload));
 
-  server.on("^\\/api\\/payloads\\/(.+)$", HTTP_DELETE, handleDeletePayload);
+  server.on(
+      "^\\/api\\/payloads\\/(.+)\\/compiled$", HTTP_POST,
+      [](AsyncWebServerRequest *req) {}, nullptr,
+      timedBody("POST /api/payloads/:name/compiled", handleSaveCompiled));
+
+  server.on(
+      "^\\/api\\/payloads\\/(.+)$", HTTP_PATCH,
+      [](AsyncWebServerRequest *req) {}, nullptr,
+      timedBody("PATCH /api/payloads/:name", handlePatchPayload));
+
+  server.on("^\\/api\\/payloads\\/(.+)$", HTTP_DELETE,
+            timed("DELETE /api/payloads/:name", handleDeletePayload));
+
+  server.on("/api/archive", HTTP_GET,
+            timed("GET /api/archive", handleExportArchive));
+
+  server.on(
+      "/api/archive", HTTP_POST, [](AsyncWebServerRequest *req) {}, nullptr,
+      timedBody("POST /api/archive", handleImportArchive));
 
   server.on(
       "^\\/api\\/execute\\/live$", HTTP_POST, [](AsyncWebServerRequest *req) {},
-      nullptr, handleLiveExecute);
+      nullptr, timedBody("POST /api/execute/live", handleLiveExecute));
+
+  server.on("^\\/api\\/execute\\/(.+)$", HTTP_POST,
+            timed("POST /api/execute/:name", handleExecutePayload));
+
+  server.on(
+      "/api/analyze", HTTP_POST, [](AsyncWebServerRequest *req) {}, nullptr,
+      timedBody("POST /api/analyze", handleAnalyze));
+
+  server.on("/api/stop", HTTP_POST, timed("POST /api/stop", handleStop));
+
+  server.on("/api/status", HTTP_GET, timed("GET /api/status", handleStatus));
+
+  server.on("/api/live", HTTP_GET, timed("GET /api/live", handleLiveStats));
+
+  server.on("/api/boot-trace", HTTP_GET,
+            timed("GET /api/boot-trace", handleBootTrace));
+
+  server.on("/api/heap", HTTP_GET, timed("GET /api/heap", handleHeap));
 
-  server.on("^\\/api\\/execute\\/(.+)$", HTTP_POST, handleExecutePayload);
+  server.on("/api/log", HTTP_GET, timed("GET /api/log", handleGetLog));
 
-  server.on("/api/stop", HTTP_POST, handleStop);
+  server.on("/api/metrics", HTTP_GET,
+            timed("GET /api/metrics", handleMetrics));
+
+  server.on("/api/profile", HTTP_GET,
+            timed("GET /api/profile", handleProfileStatus));
+
+  server.on(
+      "/api/profile", HTTP_POST, [](AsyncWebServerRequest *req) {}, nullptr,
+      timedBody("POST /api/profile", handleProfileControl));
+
+  server.on("^\\/api\\/profile\\/(.+)$", HTTP_GET,
+            timed("GET /api/profile/:run", handleGetProfile));
+
+  server.on("/api/trace", HTTP_GET, timed("GET /api/trace", handleGetTrace));
+
+  server.on(
+      "/api/trace", HTTP_POST, [](AsyncWebServerRequest *req) {}, nullptr,
+      timedBody("POST /api/trace", handleTraceControl));
+
+  server.on("/api/tasks", HTTP_GET, timed("GET /api/tasks", handleGetTasks));
+
+  server.on(
+      "/api/tasks", HTTP_POST, [](AsyncWebServerRequest *req) {}, nullptr,
+      timedBody("POST /api/tasks", handleSetTasks));
+
+  server.on("/api/contention", HTTP_GET,
+            timed("GET /api/contention", handleGetContention));
+
+  server.on(
+      "/api/contention", HTTP_POST, [](AsyncWebServerRequest *req) {},
+      nullptr, timedBody("POST /api/contention", handleStartContention));
 
-  server.on("/api/status", HTTP_GET, handleStatus);
+  // --- Live keyboard WebSocket (live_channel.h) ---
+  liveChannelInit(server);
 
   server.on(
       "/api/settings", HTTP_POST, [](AsyncWebServerRequest *req) {}, nullptr,
-      handleSettings);
+      timedBody("POST /api/settings", handleSettings));
 
   // --- CORS headers ---
   DefaultHeaders::Instance().addHeader("Access-Control-Allow-Origin", "*");
   DefaultHeaders::Instance().addHeader("Access-Control-Allow-Methods",
-                                       "GET, POST, DELETE, OPTIONS");
+                                       "GET, POST, PATCH, DELETE, OPTIONS");
   DefaultHeaders::Instance().addHeader("Access-Control-Allow-Headers",
-                                       "Content-Type");
+                                       "Content-Type, If-None-Match, If-Match");
+  DefaultHeaders::Instance().addHeader("Access-Control-Expose-Headers", "ETag");
 
   // --- Static files from LittleFS ---
-  server.serveStatic("/", LittleFS, "/www/").setDefaultFile("index.html");
+  // scripts/build_web.py stores them gzip-only (served with
+  // Content-Encoding: gzip); assets/ names carry a content hash.
+  server.serveStatic("/assets/", LittleFS, "/www/assets/")
+      .setCacheControl("public, max-age=31536000, immutable");
+  server.serveStatic("/", LittleFS, "/www/")
+      .setDefaultFile("index.html")
+      .setCacheControl("no-cache");
 
   // --- Captive portal: redirect unknown requests to root ---
   server.onNotFound([](AsyncWebServerRequest *req) { req->redirect("/"); });
 
   server.begin();
-  Serial.printf("[Web] Server started on port %d\n", WEB_SERVER_PORT);
+  // AsyncTCP creates its task in begin(); register it for /api/tasks
+  placementAdopt(TASK_ROLE_WEB, xTaskGetHandle("async_tcp"), WEB_TASK_CORE);
+  bootTraceMark("web server started");
+  logPrintf("[Web] Server started on port %d", WEB_SERVER_PORT);
 }
@@ -3,13 +3,13 @@
 // ============================================================
 
 #include "wifi_manager.h"
+#include "boot_trace.h"
 #include "config.h"
+#include "dns_responder.h"
+#include "logger.h"
 
-#include <DNSServer.h>
 #include <WiFi.h>
 
-
-static DNSServer sDns;
 static String sSSID;
 
 void wifiInit() {
@@ -22,12 +22,17 @@ void wifiInit() {
 
   WiFi.mode(WIFI_AP);
   WiFi.softAP(sSSID.c_str(), WIFI_PASSWORD, WIFI_CHANNEL, 0, WIFI_MAX_CLIENTS);
+  bootTraceMark("wifi ap up");
 
-  // Start DNS server for captive portal — redirect all domains to us
-  sDns.start(53, "*", WiFi.softAPIP());
+  // Captive portal DNS — every name resolves to us (own task)
+  IPAddress ip = WiFi.softAPIP();
+  const uint8_t addr[4] = {ip[0], ip[1], ip[2], ip[3]};
+  if (!dnsStart(addr))
+    logPrintf("[WiFi] DNS responder failed to start");
+  bootTraceMark("dns started");
 
-  Serial.printf("[WiFi] AP started — SSID: %s  IP: %s\n", sSSID.c_str(),
-                WiFi.softAPIP().toString().c_str());
+  logPrintf("[WiFi] AP started — SSID: %s  IP: %s", sSSID.c_str(),
+            WiFi.softAPIP().toString().c_str());
 }
 
 String wifiGetSSID() { return sSSID; }
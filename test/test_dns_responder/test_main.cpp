@@ -0,0 +1,145 @@
+// ============================================================
+//  DNS Responder — Loopback UDP Test
+// ============================================================
+//
+//  pio test -e native
+//
+//  Starts the responder on a loopback port and queries it over real
+//  UDP: A queries are answered with the AP address, AAAA and other
+//  types get an empty NOERROR reply, and truncated or oversized
+//  packets get no reply at all.
+//
+// ============================================================
+
+#include "config.h"
+#include "dns_responder.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unity.h>
+#include <vector>
+
+#define TEST_DNS_PORT 15353
+#define TEST_REPLY_MS 300 // no reply within this = dropped
+
+#define TYPE_A 1
+#define TYPE_AAAA 28
+#define TYPE_HTTPS 65
+
+static const uint8_t kIp[4] = {192, 168, 4, 1};
+static int sClient = -1;
+
+// Standard query, ID 0x1234 and RD set, for captive.test
+static std::vector<uint8_t> query(uint16_t qtype) {
+  std::vector<uint8_t> q = {0x12, 0x34, 0x01, 0x00, 0, 1, 0, 0, 0, 0, 0, 0};
+  for (const char *label : {"captive", "test"}) {
+    q.push_back(strlen(label));
+    q.insert(q.end(), label, label + strlen(label));
+  }
+  q.push_back(0);
+  q.push_back(qtype >> 8);
+  q.push_back(qtype & 0xFF);
+  q.push_back(0);
+  q.push_back(1); // IN
+  return q;
+}
+
+// Send `q` to the responder. The reply length, or 0 if none came.
+static size_t exchange(const std::vector<uint8_t> &q, uint8_t *reply) {
+  sockaddr_in to = {};
+  to.sin_family = AF_INET;
+  to.sin_port = htons(TEST_DNS_PORT);
+  to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (sendto(sClient, q.data(), q.size(), 0, (sockaddr *)&to, sizeof(to)) !=
+      (ssize_t)q.size())
+    return 0;
+  ssize_t n = recv(sClient, reply, DNS_PACKET_MAX + 1, 0);
+  return n > 0 ? n : 0;
+}
+
+// Reply header and question match query `q`, with `answers` records
+static void checkReply(const std::vector<uint8_t> &q, const uint8_t *reply,
+                       uint8_t answers) {
+  TEST_ASSERT_EQUAL_HEX8(0x12, reply[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x34, reply[1]);
+  TEST_ASSERT_EQUAL_HEX8(0x85, reply[2]); // QR, AA, RD
+  TEST_ASSERT_EQUAL_HEX8(0x00, reply[3]); // NOERROR
+  TEST_ASSERT_EQUAL_UINT8(1, reply[5]);   // QDCOUNT
+  TEST_ASSERT_EQUAL_UINT8(answers, reply[7]);
+  TEST_ASSERT_EQUAL_MEMORY(q.data() + 12, reply + 12, q.size() - 12);
+}
+
+// ================================================================
+//  Tests
+// ================================================================
+
+void setUp() {}
+void tearDown() {}
+
+static void test_start() { TEST_ASSERT_TRUE(dnsStart(kIp, TEST_DNS_PORT)); }
+
+static void test_a_answered() {
+  uint8_t reply[DNS_PACKET_MAX + 1];
+  std::vector<uint8_t> q = query(TYPE_A);
+  TEST_ASSERT_EQUAL(q.size() + 16, exchange(q, reply));
+  checkReply(q, reply, 1);
+  const uint8_t *an = reply + q.size();
+  TEST_ASSERT_EQUAL_HEX8(0xC0, an[0]); // name: pointer to offset 12
+  TEST_ASSERT_EQUAL_HEX8(0x0C, an[1]);
+  TEST_ASSERT_EQUAL_UINT8(TYPE_A, an[3]);
+  TEST_ASSERT_EQUAL_UINT8(4, an[11]); // RDLENGTH
+  TEST_ASSERT_EQUAL_MEMORY(kIp, an + 12, 4);
+}
+
+static void test_other_types_empty() {
+  uint8_t reply[DNS_PACKET_MAX + 1];
+  for (uint16_t type : {TYPE_AAAA, TYPE_HTTPS}) {
+    std::vector<uint8_t> q = query(type);
+    TEST_ASSERT_EQUAL(q.size(), exchange(q, reply));
+    checkReply(q, reply, 0);
+  }
+}
+
+static void test_truncated_dropped() {
+  uint8_t reply[DNS_PACKET_MAX + 1];
+  DnsStats before = dnsGetStats();
+  std::vector<uint8_t> header = query(TYPE_A);
+  header.resize(8);
+  TEST_ASSERT_EQUAL(0, exchange(header, reply));
+  std::vector<uint8_t> question = query(TYPE_A);
+  question.resize(question.size() - 3); // QTYPE/QCLASS cut short
+  TEST_ASSERT_EQUAL(0, exchange(question, reply));
+  TEST_ASSERT_EQUAL_UINT32(before.dropped + 2, dnsGetStats().dropped);
+}
+
+static void test_oversized_dropped() {
+  uint8_t reply[DNS_PACKET_MAX + 1];
+  std::vector<uint8_t> q = query(TYPE_A);
+  size_t qlen = q.size();
+  // Trailing bytes are ignored up to the limit...
+  q.resize(DNS_PACKET_MAX);
+  TEST_ASSERT_EQUAL(qlen + 16, exchange(q, reply));
+  // ...and one byte over it drops the packet
+  DnsStats before = dnsGetStats();
+  q.resize(DNS_PACKET_MAX + 1);
+  TEST_ASSERT_EQUAL(0, exchange(q, reply));
+  TEST_ASSERT_EQUAL_UINT32(before.dropped + 1, dnsGetStats().dropped);
+}
+
+int main() {
+  sClient = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  timeval tv = {0, TEST_REPLY_MS * 1000};
+  setsockopt(sClient, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+  UNITY_BEGIN();
+  RUN_TEST(test_start);
+  RUN_TEST(test_a_answered);
+  RUN_TEST(test_other_types_empty);
+  RUN_TEST(test_truncated_dropped);
+  RUN_TEST(test_oversized_dropped);
+  dnsStop();
+  close(sClient);
+  return UNITY_END();
+}